@@ -0,0 +1,89 @@
+#ifndef AIRTIME_H
+#define AIRTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== LoRa / E32 Airtime Model =====
+// Время пакета SX1276 в эфире (Semtech AN1200.13):
+//   T_sym      = 2^SF / BW
+//   T_preamble = (n_preamble + 4.25) * T_sym
+//   n_payload  = 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / 4(SF - 2DE)) * (CR + 4), 0)
+// DE (low data rate optimize) включается при T_sym > 16 мс.
+// E32 режет кадр из UART на подпакеты по 58 байт, каждый - отдельный пакет LoRa.
+// SF/BW для air data rate E32 производитель не публикует: таблица подобрана
+// по номинальной скорости SF * BW / 2^SF * 4/5 (2.4k -> SF11/BW500).
+// Все функции constexpr - и для static_assert, и во время работы; без Arduino.
+
+struct LoraModulation {
+  uint8_t  sf;              // Spreading factor 7..12
+  uint32_t bw_hz;           // Полоса
+  uint8_t  cr;              // Coding rate 4/(4 + cr), cr = 1..4
+  uint8_t  preamble;        // Символов преамбулы
+  bool     crc;
+  bool     implicitHeader;
+};
+
+constexpr size_t E32_SUBPACKET_SIZE = 58;
+
+// Настройки E32: CR 4/5, преамбула 8 символов, CRC, явный заголовок
+constexpr LoraModulation e32Lora(uint8_t sf, uint32_t bw_hz) {
+  return LoraModulation{sf, bw_hz, 1, 8, true, false};
+}
+
+// Air data rate E32 (bps) -> модуляция; между ступенями - ближайшая сверху
+constexpr LoraModulation e32Modulation(uint32_t airRate_bps) {
+  return airRate_bps <= 300  ? e32Lora(12, 125000) :
+         airRate_bps <= 1200 ? e32Lora(11, 250000) :
+         airRate_bps <= 2400 ? e32Lora(11, 500000) :
+         airRate_bps <= 4800 ? e32Lora(10, 500000) :
+         airRate_bps <= 9600 ? e32Lora(9, 500000) :
+                               e32Lora(8, 500000);
+}
+
+constexpr uint32_t loraSymbol_us(const LoraModulation& m) {
+  return (uint32_t)((1000000ULL << m.sf) / m.bw_hz);
+}
+
+constexpr bool loraLowDataRate(const LoraModulation& m) {
+  return loraSymbol_us(m) > 16000;
+}
+
+constexpr int32_t loraPayloadBits(const LoraModulation& m, size_t len) {
+  return 8 * (int32_t)len - 4 * m.sf + 28 + (m.crc ? 16 : 0) - (m.implicitHeader ? 20 : 0);
+}
+
+constexpr int32_t loraBitsPerBlock(const LoraModulation& m) {
+  return 4 * (m.sf - (loraLowDataRate(m) ? 2 : 0));
+}
+
+constexpr uint32_t loraPayloadSymbols(const LoraModulation& m, size_t len) {
+  return 8 + (loraPayloadBits(m, len) > 0
+              ? (uint32_t)((loraPayloadBits(m, len) + loraBitsPerBlock(m) - 1) / loraBitsPerBlock(m)) * (m.cr + 4)
+              : 0);
+}
+
+// Преамбула + sync word: (n + 4.25) символа
+constexpr uint32_t loraPreamble_us(const LoraModulation& m) {
+  return (uint32_t)((4ULL * m.preamble + 17) * loraSymbol_us(m) / 4);
+}
+
+// Один пакет LoRa из len байт (микросекунды)
+constexpr uint32_t loraAirtime_us(const LoraModulation& m, size_t len) {
+  return loraPreamble_us(m) + loraPayloadSymbols(m, len) * loraSymbol_us(m);
+}
+
+// Кадр E32 из len байт: подпакеты по E32_SUBPACKET_SIZE подряд
+constexpr uint32_t e32Airtime_us(const LoraModulation& m, size_t len) {
+  return len > E32_SUBPACKET_SIZE
+         ? loraAirtime_us(m, E32_SUBPACKET_SIZE) + e32Airtime_us(m, len - E32_SUBPACKET_SIZE)
+         : loraAirtime_us(m, len);
+}
+
+// Опорные точки модели (SF11/BW500: символ 4.096 мс, преамбула 50.176 мс)
+static_assert(loraSymbol_us(e32Modulation(2400)) == 4096, "SF11/BW500 symbol");
+static_assert(loraPreamble_us(e32Modulation(2400)) == 50176, "8 + 4.25 symbol preamble");
+static_assert(loraLowDataRate(e32Modulation(300)) && !loraLowDataRate(e32Modulation(2400)),
+              "low data rate optimize above 16 ms symbols");
+
+#endif // AIRTIME_H
@@ -0,0 +1,54 @@
+#ifndef ANCHOR_UPLINK_H
+#define ANCHOR_UPLINK_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+#include "uplink.h"
+
+// ===== Anchor Measurement Uplink (USB Serial) =====
+// Метка каждого кадра тега в шкале опорного anchor уходит записью uplink.h
+// в USB Serial - коллектор на хосте объединяет записи всех anchor по кадру.
+// Запись пишется одним write(): на ESP32 не перемешивается со строками лога
+// из другой задачи. TX буфер не вмещает запись - она отбрасывается и
+// считается, прием кадров не ждет USB.
+
+class AnchorUplink {
+public:
+  AnchorUplink();
+  
+  // Узел и первая запись anchor; включение по умолчанию - Uplink::ENABLED
+  void begin(uint8_t anchorId, float anchorX, float anchorY);
+  
+  void setEnabled(bool on);
+  bool isEnabled() const { return enabled; }
+  
+  // Кадр тега: refArrival_us - начало в эфире в шкале опорного anchor,
+  // stats и timing - локальные (возраст записи и источник метки)
+  void publish(const PacketData& packet, uint32_t refArrival_us,
+               const RxStats& stats, const RxFrameTiming& timing);
+  
+  // Периодическая запись с координатами anchor
+  void poll();
+  
+  // "uplink": состояние и счетчики
+  void printReport(Print& out) const;
+  
+  uint32_t getSent() const { return sent; }
+  uint32_t getDropped() const { return dropped; }
+  
+private:
+  UplinkAnchor node;
+  bool enabled;
+  uint32_t lastAnchorInfo_ms;
+  uint32_t sent;
+  uint32_t dropped;
+  
+  void sendAnchorInfo();
+  void write(const uint8_t* frame, size_t length);
+};
+
+// Глобальный экземпляр (определен в anchor_uplink.cpp)
+extern AnchorUplink anchorUplink;
+
+#endif // ANCHOR_UPLINK_H
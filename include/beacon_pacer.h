@@ -0,0 +1,89 @@
+#ifndef BEACON_PACER_H
+#define BEACON_PACER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+
+// ===== Duty-cycle / Collision-aware Beacon Pacing =====
+// Интервал beacon I - наименьший, при котором эфир кадра T укладывается в оба бюджета:
+//   duty cycle: T / I <= d                                 -> I >= T / d
+//   коллизии (чистый ALOHA, N передатчиков с интервалом I):
+//     P = 1 - exp(-2 N T / I) <= p                         -> I >= 2 N T / -ln(1 - p)
+// T - сначала оценка по формату кадра, затем скользящее среднее фактических
+// передач с beacon. Каждый интервал получает случайный разброс +-JITTER_PERCENT,
+// чтобы теги с одинаковым периодом не сталкивались раз за разом (джиттер
+// периода beacon в отчете TxQueue включает этот разброс).
+// Загрузка канала - эфир всех передач TX между вызовами sampleAirtime().
+
+// -ln(1 - p) рядом Тейлора, 0 <= p <= 0.5: 24 члена - ошибка < 1e-8
+constexpr float negLog1mSeries(float p, float pk, uint8_t k) {
+  return k > 24 ? 0.0f : pk / k + negLog1mSeries(p, pk * p, k + 1);
+}
+
+constexpr float negLog1m(float p) {
+  return negLog1mSeries(p, p, 1);
+}
+
+constexpr uint32_t dutyInterval_ms(uint32_t airtime_us, uint16_t dutyPermille) {
+  return (airtime_us + dutyPermille - 1) / dutyPermille;
+}
+
+constexpr uint32_t collisionInterval_ms(uint32_t airtime_us, uint16_t collisionPermille, uint8_t senders) {
+  return (uint32_t)(2.0f * senders * airtime_us / 1000.0f / negLog1m(collisionPermille / 1000.0f)) + 1;
+}
+
+// Интервал по обоим бюджетам без ограничений MIN/MAX (ms)
+constexpr uint32_t requiredInterval_ms(uint32_t airtime_us) {
+  return dutyInterval_ms(airtime_us, Config::Pacing::DUTY_CYCLE_PERMILLE) >
+         collisionInterval_ms(airtime_us, Config::Pacing::COLLISION_PERMILLE, Config::Pacing::CHANNEL_SENDERS)
+         ? dutyInterval_ms(airtime_us, Config::Pacing::DUTY_CYCLE_PERMILLE)
+         : collisionInterval_ms(airtime_us, Config::Pacing::COLLISION_PERMILLE, Config::Pacing::CHANNEL_SENDERS);
+}
+
+constexpr uint32_t pacedInterval_ms(uint32_t airtime_us) {
+  return requiredInterval_ms(airtime_us) < Config::Pacing::MIN_INTERVAL_MS ? Config::Pacing::MIN_INTERVAL_MS :
+         requiredInterval_ms(airtime_us) > Config::Pacing::MAX_INTERVAL_MS ? Config::Pacing::MAX_INTERVAL_MS :
+         requiredInterval_ms(airtime_us);
+}
+
+class BeaconPacer {
+public:
+  BeaconPacer();
+
+  // Оценка эфира передачи с beacon до первой передачи (байт кадра формата)
+  void begin(size_t beaconFrameBytes);
+
+  // Передача с beacon завершилась: эфир всей передачи (с попутными кадрами)
+  void onBeaconSent(uint32_t airtime_us);
+
+  // Интервал до следующего beacon со случайным разбросом (ms)
+  uint32_t nextInterval_ms();
+
+  // Интервал без разброса (ms)
+  uint32_t getInterval_ms() const { return interval_ms; }
+
+  // Накопленный эфир TX (TxQueue::getAirtime_us) - окно загрузки канала
+  void sampleAirtime(uint64_t totalAirtime_us);
+
+  // Загрузка канала за последнее окно, промилле
+  uint16_t getUtilizationPermille() const { return utilizationPermille; }
+
+  // Интервал, эфир beacon, загрузка и оценка вероятности коллизии
+  void printReport(Print& out) const;
+
+private:
+  uint32_t beaconAirtime_us;  // Скользящее среднее, 1/8 на передачу
+  uint32_t interval_ms;
+  uint32_t rngState;
+
+  uint64_t windowAirtime_us;  // Эфир на начало окна
+  uint32_t windowStart_ms;
+  uint32_t windowLength_ms;
+  uint16_t utilizationPermille;
+  bool windowStarted;
+};
+
+extern BeaconPacer beaconPacer;
+
+#endif // BEACON_PACER_H
@@ -0,0 +1,118 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "crc16.h"
+#include "cobs_framing.h"
+
+// ===== RX Capture Format =====
+// Сырой прием anchor для воспроизведения на хосте (src/native/replay.cpp):
+// каждый байт UART E32 с меткой чтения и каждый спад AUX с меткой ISR -
+// ровно то, что видит LoRaModule::read(). Записи идут в USB Serial в кадре
+// синхрослова (cobs_framing.h) вместе с логом и uplink.h; чужие записи
+// декодер пропускает. Поля little-endian, CRC-16 по всей записи до него.
+//
+// Заголовок, 22 байта - при включении записи:
+//   [0]      CAPTURE_HEADER_MAGIC
+//   [1]      ID anchor
+//   [2]      CAPTURE_VERSION
+//   [3]      флаги прошивки CAPTURE_FLAG_* (формат кадров на приеме)
+//   [4..7]   X, [8..11] Y anchor (float, м)
+//   [12..15] скорость UART E32 (бод)
+//   [16..19] начало записи (micros)
+//   [20..21] CRC-16
+//
+// Блок событий, до Capture::CHUNK_SIZE байт:
+//   [0]      CAPTURE_CHUNK_MAGIC
+//   [1]      ID anchor
+//   [2..3]   номер блока; пропуск - блок потерян (USB TX буфер полон)
+//   [4..7]   время первого события (micros)
+//   [8..]    события: varint(dt << 1 | aux), затем байт UART, если не aux;
+//            dt - от предыдущего события блока (у первого 0)
+//   [..]     CRC-16
+
+constexpr uint8_t CAPTURE_HEADER_MAGIC = 0xC3;
+constexpr uint8_t CAPTURE_CHUNK_MAGIC  = 0xC4;
+constexpr uint8_t CAPTURE_VERSION      = 1;
+
+constexpr size_t CAPTURE_HEADER_SIZE  = 22;
+constexpr size_t CAPTURE_CHUNK_PREFIX = 8;
+constexpr size_t CAPTURE_CRC_SIZE     = 2;
+constexpr size_t CAPTURE_MAX_EVENT    = 6;   // varint 33 бит + байт
+constexpr size_t CAPTURE_MAX_RECORD   = FRAME_MAX_PAYLOAD;
+
+constexpr uint8_t CAPTURE_FLAG_COBS   = 0x01;  // Protocol::COBS_FRAMING
+constexpr uint8_t CAPTURE_FLAG_CRC    = 0x02;  // Protocol::REQUIRE_CRC
+constexpr uint8_t CAPTURE_FLAG_BINARY = 0x04;  // Бинарный TX (текстовый TX убран - всегда)
+constexpr uint8_t CAPTURE_FLAG_DELTA  = 0x08;  // Protocol::DELTA_WIRE_FORMAT
+
+// Флаги этой сборки
+uint8_t captureBuildFlags();
+
+struct CaptureHeader {
+  uint8_t anchorId;
+  uint8_t version;
+  uint8_t flags;
+  float x;
+  float y;
+  uint32_t loraBaud;
+  uint32_t start_us;
+  
+  CaptureHeader() : anchorId(0), version(CAPTURE_VERSION), flags(0),
+                    x(0), y(0), loraBaud(0), start_us(0) {}
+};
+
+struct CaptureEvent {
+  uint32_t time_us;
+  uint8_t data;    // Байт UART (для aux - 0)
+  bool aux;        // Спад AUX
+};
+
+// Заголовок в кадре синхрослова, возвращает длину (0 - не влезло)
+size_t encodeCaptureHeader(uint8_t* out, size_t outSize, const CaptureHeader& header);
+
+// Блок собирается на месте в record: префикс, события, затем кадр
+size_t beginCaptureChunk(uint8_t* record, uint8_t anchorId, uint16_t sequence, uint32_t base_us);
+size_t putCaptureEvent(uint8_t* dst, uint32_t dt_us, bool aux, uint8_t data);
+size_t encodeCaptureChunk(uint8_t* out, size_t outSize, uint8_t* record, size_t length);
+
+// Потоковый разбор записей из байт порта; лог и записи uplink.h пропускаются
+class CaptureDecoder {
+public:
+  enum Result : uint8_t {
+    CAPTURE_NONE,     // Нужны еще байты (или чужая запись)
+    CAPTURE_HEADER,   // Заголовок в header()
+    CAPTURE_CHUNK,    // Блок: chunkAnchor()/chunkSequence(), события - nextEvent()
+    CAPTURE_ERROR     // Кадр с неверной длиной или CRC
+  };
+  
+  CaptureDecoder() : length(0), eventPos(0), eventTime_us(0), records(0), errors(0) {}
+  
+  Result feed(uint8_t b);
+  
+  const CaptureHeader& header() const { return headerInfo; }
+  
+  uint8_t chunkAnchor() const { return buffer[1]; }
+  uint16_t chunkSequence() const;
+  
+  // Следующее событие последнего блока; false - события кончились
+  bool nextEvent(CaptureEvent& event);
+  
+  uint32_t getRecords() const { return records; }
+  uint32_t getErrors() const { return errors; }
+  
+private:
+  CobsDecoder cobs;
+  uint8_t buffer[CAPTURE_MAX_RECORD];
+  uint8_t length;
+  CaptureHeader headerInfo;
+  uint8_t eventPos;
+  uint32_t eventTime_us;
+  uint32_t records;
+  uint32_t errors;
+  
+  Result complete();
+};
+
+#endif // CAPTURE_H
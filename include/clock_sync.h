@@ -0,0 +1,94 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+
+// ===== Anchor Clock Synchronization =====
+// Опорный anchor (Config::Sync::REFERENCE_ANCHOR_ID) периодически передает
+// кадр SYNC со своей меткой micros(). Остальные anchor по каждому такому
+// кадру получают точку (локальное время, смещение до опорных часов) и
+// ведут скользящую линейную регрессию смещения: offset(t) = a + b*t.
+// b - относительный уход частоты (skew), RMS остатков - джиттер.
+// Метка в кадре SYNC - начало его эфира, а не момент кодирования: задержку
+// UART TX и буфера E32 опорный anchor учитывает сам (referenceStamp), иначе
+// она целиком уходила бы в смещение остальных anchor - его собственные
+// метки приема к эфиру уже привязаны.
+
+constexpr const char* SYNC_MESSAGE = "SYNC";
+// Пробный кадр SYNC, пока задержка TX не измерена: метка по модели, в
+// регрессию не идет. Той же длины - измеренная по нему задержка годится для SYNC
+constexpr const char* SYNC_PROBE_MESSAGE = "sync";
+
+// Является ли пакет опорным кадром синхронизации (в том числе пробным)
+bool isSyncPacket(const PacketData& packet);
+
+// Пробный кадр: метка TIME по модели задержки TX
+bool isSyncProbe(const PacketData& packet);
+
+class ClockSync {
+public:
+  ClockSync();
+  
+  // Настройка по координатам: задержка распространения от опорного anchor
+  void configure(bool isReference, float anchorX, float anchorY, float refX, float refY);
+  
+  // Опорный кадр: refTx_us - метка в кадре (часы опорного anchor),
+  // localArrival_us - начало кадра в эфире по локальным часам
+  void processReference(uint32_t refTx_us, uint32_t localArrival_us);
+  
+  // Опорный anchor: метка кадра SYNC, записываемого в UART в write_us, -
+  // ожидаемое начало эфира. До первого измерения задержка - model_us
+  uint32_t referenceStamp(uint32_t write_us, uint32_t model_us) const;
+  
+  // Опорный anchor: кадр, записанный в write_us, ушел в эфир в airStart_us
+  // (по подъему AUX) - задержка для следующих меток
+  void onReferenceSent(uint32_t write_us, uint32_t airStart_us);
+  
+  // Опорный anchor: задержка TX измерена - кадр SYNC, а не пробный
+  bool isTxDelayMeasured() const { return txDelay_us != 0; }
+  
+  // Перевод локальной метки в шкалу опорного anchor
+  uint32_t toReference(uint32_t local_us) const;
+  
+  // Есть достаточно свежих точек для пересчета
+  bool isLocked() const;
+  
+  bool isReference() const { return reference; }
+  float getSkewPpm() const { return slope * 1e6f; }
+  float getJitterUs() const { return jitter_us; }
+  uint8_t getSampleCount() const { return count; }
+  uint32_t getRejected() const { return rejected; }
+  
+private:
+  struct Sample {
+    uint32_t local_us;   // Локальное время прихода
+    int32_t offset_us;   // Опорное время - локальное
+  };
+  
+  Sample samples[Config::Sync::WINDOW];
+  uint8_t head;
+  uint8_t count;
+  uint8_t consecutiveRejects;
+  bool reference;
+  uint32_t propagation_us;
+  uint32_t rejected;
+  uint32_t lastSample_ms;
+  uint32_t txDelay_us;   // Опорный: запись в UART -> начало эфира (0 - не измерена)
+  
+  // Модель относительно последней точки: offset = baseOffset + intercept + slope*(t - baseLocal)
+  uint32_t baseLocal_us;
+  int32_t baseOffset_us;
+  float intercept;
+  float slope;
+  float jitter_us;
+  
+  int32_t predictOffset(uint32_t local_us) const;
+  void refit();
+};
+
+// Глобальный экземпляр (определен в clock_sync.cpp)
+extern ClockSync clockSync;
+
+#endif // CLOCK_SYNC_H
@@ -0,0 +1,63 @@
+#ifndef COBS_FRAMING_H
+#define COBS_FRAMING_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Sync-word + Length Framing (COBS) =====
+// Передача E32 целиком (кадр или пакет 0xBF) оборачивается так:
+//   [0]    0x00            синхрослово: внутри кадра нуля нет
+//   [1..]  COBS(len, data) len - длина data (1..253), data - кадр как есть
+// COBS (Consistent Overhead Byte Stuffing) убирает нули из данных: каждый
+// кодовый байт n - за ним n-1 байт данных, затем неявный 0 (кроме n = 0xFF).
+// Для кадра до 253 байт - ровно один кодовый байт, итого +3 байта.
+// Потерянный или искаженный байт портит только свой кадр: следующее 0x00
+// начинает новый, сколько бы байт ни ждал поврежденный. Длина известна
+// после второго байта - граница кадра до прихода payload.
+// Без синхрослова (старая прошивка) RX разбирает кадры как раньше.
+
+constexpr uint8_t FRAME_SYNC          = 0x00;
+constexpr size_t  FRAME_MAX_PAYLOAD   = 253;   // Один кодовый байт COBS
+constexpr size_t  FRAME_SYNC_OVERHEAD = 3;     // sync + код COBS + длина
+
+// Добавка к каждой передаче TX при включенном Protocol::COBS_FRAMING
+constexpr size_t FRAMING_OVERHEAD = Config::Protocol::COBS_FRAMING ? FRAME_SYNC_OVERHEAD : 0;
+
+// Обернуть данные в кадр, возвращает длину (0 - не влезло или данные длиннее 253)
+size_t encodeSyncFrame(uint8_t* out, size_t outSize, const uint8_t* data, size_t length);
+
+// Потоковый декодер: байты после синхрослова, O(1) на байт
+class CobsDecoder {
+public:
+  enum Result : uint8_t {
+    COBS_NONE,   // Служебный байт (код, длина)
+    COBS_DATA,   // Байт данных кадра в out
+    COBS_ERROR   // Нулевая длина - кадр отброшен
+  };
+  
+  CobsDecoder() { stop(); }
+  
+  // Принято синхрослово
+  void start();
+  
+  // Кадр прерван; после последнего байта данных - сам
+  void stop();
+  
+  bool isActive() const { return active; }
+  
+  // Длина уже принята: дальше getRemaining() байт данных
+  bool hasLength() const { return haveLength; }
+  uint8_t getRemaining() const { return remaining; }
+  
+  // Байт с провода, не синхрослово
+  Result decode(uint8_t b, uint8_t& out);
+  
+private:
+  uint8_t run;        // Байт данных до следующего кода
+  uint8_t remaining;
+  bool zeroPending;   // Группа закончилась неявным 0
+  bool haveLength;
+  bool active;
+};
+
+#endif // COBS_FRAMING_H
@@ -11,6 +11,9 @@
 #elif defined(__AVR_ATmega2560__)
   #define PLATFORM_MEGA2560 1
   #define PLATFORM_NAME "Arduino Mega 2560"
+#elif defined(NATIVE_SIM)
+  #define PLATFORM_NATIVE 1
+  #define PLATFORM_NAME "Native (simulated E32)"
 #else
   #error "Unsupported platform"
 #endif
@@ -26,45 +29,245 @@ namespace Config {
       constexpr uint8_t LED      = 21;  // External LED (220 Ohm resistor)
       constexpr uint8_t OLED_SDA = 23;  // SSD1306 I2C Data
       constexpr uint8_t OLED_SCL = 18;  // SSD1306 I2C Clock
-      
+    
     #elif defined(PLATFORM_MEGA2560)
       // ===== Arduino Mega 2560 Pins =====
       constexpr uint8_t UART_RX  = 18;  // UART1 RX (connected to E32 TX)
       constexpr uint8_t UART_TX  = 19;  // UART1 TX (connected to E32 RX)
       constexpr uint8_t E32_AUX  = 20;  // E32 AUX status pin
       constexpr uint8_t LED      = 13;  // Built-in LED
+    
+    #elif defined(PLATFORM_NATIVE)
+      // ===== Native: номера пинов для симулятора (как ESP32) =====
+      constexpr uint8_t UART_RX  = 16;
+      constexpr uint8_t UART_TX  = 17;
+      constexpr uint8_t E32_AUX  = 19;
+      constexpr uint8_t LED      = 21;
     #endif
     
     // M0 и M1 зафиксированы на GND (NORMAL MODE) - не управляются программно
   }
-
+  
   namespace Timing {
     constexpr uint32_t MODULE_INIT_TIMEOUT   = 10000; // Timeout for module ready (ms)
     constexpr uint32_t MODULE_READY_POLL     = 50;    // Poll interval for AUX (ms)
     constexpr uint32_t SERIAL_INIT_DELAY     = 1000;  // Delay after Serial.begin() (ms)
     constexpr uint32_t UART_INIT_DELAY       = 500;   // Delay after UART begin (ms)
     constexpr uint32_t MODULE_STARTUP_DELAY  = 2000;  // Delay after e32.begin() (ms)
-    constexpr uint32_t PING_INTERVAL         = 1000;  // Interval between PING messages (ms)
+    constexpr uint32_t PING_INTERVAL         = 1000;  // Interval between PING messages (ms), без Pacing::ENABLED
+    constexpr uint32_t AUX_FRAME_WINDOW_US   = 100000; // Max AUX fall -> first byte gap (us)
+    constexpr uint32_t AUX_SETTLE_US         = 2000;  // Конец кадра на UART -> AUX LOW (us)
   }
-
+  
   namespace Protocol {
     #ifdef PLATFORM_ESP32
       constexpr size_t RX_BUFFER_SIZE      = 2048;  // UART RX buffer size (ESP32)
     #elif defined(PLATFORM_MEGA2560)
       constexpr size_t RX_BUFFER_SIZE      = 256;   // UART RX buffer size (Mega - меньше памяти)
+    #elif defined(PLATFORM_NATIVE)
+      constexpr size_t RX_BUFFER_SIZE      = 2048;  // UART RX buffer size (как ESP32)
+    #endif
+    
+    #ifdef PLATFORM_ESP32
+      constexpr size_t MAX_PAYLOAD_LENGTH  = 200;   // Max MSG field length in PacketData (ESP32)
+    #elif defined(PLATFORM_MEGA2560)
+      constexpr size_t MAX_PAYLOAD_LENGTH  = 64;    // Max MSG field length in PacketData (Mega)
+    #elif defined(PLATFORM_NATIVE)
+      constexpr size_t MAX_PAYLOAD_LENGTH  = 200;   // Max MSG field length in PacketData (как ESP32)
     #endif
     
     constexpr size_t MAX_MESSAGE_LENGTH     = 256;   // Max message length
     constexpr size_t MAX_SERIAL_INPUT       = 200;   // Max Serial input buffer
     constexpr uint32_t SERIAL_BAUD_RATE     = 115200; // USB Serial baud
     constexpr uint32_t LORA_BAUD_RATE       = 9600;  // LoRa module UART baud
+    constexpr uint32_t AIR_DATA_RATE        = 2400;  // E32 air data rate (bps, заводская настройка; SF/BW - airtime.h)
+    constexpr size_t   SUBPACKET_SIZE       = 58;    // E32: байт в одной передаче LoRa
+    constexpr uint8_t  IDLE_GAP_BYTES       = 3;     // E32: пауза UART (байт), после которой уходит неполный подпакет
+    
+    // Формат кадра на передачу выбирается в platformio.ini для каждого env TX:
+    // -D WIRE_FORMAT_BINARY (и по умолчанию) - бинарный v1 (v3 с ID тега),
+    // -D WIRE_FORMAT_DELTA - v2 с дельта-сжатием. Текстовый с CRC и синхрословом
+    // длиннее Tx::MAX_FRAME и на передачу не выбирается. RX принимает все форматы.
+    #if defined(WIRE_FORMAT_BINARY) && defined(WIRE_FORMAT_DELTA)
+      #error "WIRE_FORMAT_BINARY and WIRE_FORMAT_DELTA are mutually exclusive"
+    #endif
+    #ifdef WIRE_FORMAT_DELTA
+      constexpr bool DELTA_WIRE_FORMAT      = true;
+    #else
+      constexpr bool DELTA_WIRE_FORMAT      = false;
+    #endif
+    constexpr uint8_t DELTA_KEYFRAME_INTERVAL = 8;   // Каждый N-й кадр v2 - ключевой (ресинхронизация RX)
+    
+    // CRC-16/CCITT в конце каждого кадра (packet.h): +2 байта бинарному, +9 текстовому.
+    // Кадр с CRC проверяется всегда. REQUIRE_CRC - RX отбрасывает и кадры без CRC
+    // (старая прошивка TX); включать, когда все теги обновлены
+    constexpr bool FRAME_CRC              = true;
+    constexpr bool REQUIRE_CRC            = false;
+    
+    // Синхрослово 0x00 + длина, COBS (cobs_framing.h): +3 байта на передачу,
+    // RX ресинхронизируется на следующем кадре после любой ошибки
+    constexpr bool COBS_FRAMING           = true;
   }
-
+  
+  namespace Tdoa {
+    // Хеш-таблица измерений (открытая адресация), размер - степень двойки
+    #ifdef PLATFORM_ESP32
+      constexpr uint16_t MEASUREMENT_SLOTS = 512;  // Одновременных EUID (ESP32)
+    #elif defined(PLATFORM_MEGA2560)
+      constexpr uint16_t MEASUREMENT_SLOTS = 16;   // Одновременных EUID (Mega - меньше памяти)
+    #elif defined(PLATFORM_NATIVE)
+      constexpr uint16_t MEASUREMENT_SLOTS = 512;  // Одновременных EUID (как ESP32)
+    #endif
+    
+    constexpr uint8_t  MEASUREMENT_MAX_PROBE = 16;    // Макс. длина цепочки пробирования
+    constexpr uint32_t MEASUREMENT_TTL_MS    = 2000;  // Запись старше считается свободной
+    
+    // Трекинг тегов (TdoaTracker): шаг по последнему кадру каждого тега
+    constexpr uint32_t TRACK_INTERVAL_MS     = 100;   // Период locateAll() в loop
+    constexpr uint32_t TRACK_SETTLE_MS       = 300;   // Ожидание меток остальных anchor
+  }
+  
+  namespace Sync {
+    // Синхронизация часов anchor по опорным кадрам
+    constexpr uint8_t  REFERENCE_ANCHOR_ID = 0;       // Anchor, передающий опорные кадры
+    constexpr float    REFERENCE_X         = 0.0f;    // Координаты опорного anchor (метры)
+    constexpr float    REFERENCE_Y         = 0.0f;
+    constexpr uint32_t BEACON_INTERVAL_MS  = 2000;    // Период опорных кадров (ms)
+    constexpr uint8_t  WINDOW              = 8;       // Точек в линейной регрессии
+    constexpr uint8_t  MIN_SAMPLES         = 3;       // Точек до захвата синхронизации
+    constexpr uint32_t MAX_OUTLIER_US      = 1000;    // Отбраковка выброса относительно модели (us)
+    constexpr uint32_t HOLDOVER_MS         = 30000;   // Без опорных кадров дольше - синхронизация потеряна
+  }
+  
+  namespace Uplink {
+    // Записи меток кадров в USB Serial для коллектора на хосте (anchor_uplink.h)
+    constexpr bool     ENABLED        = true;    // При старте; команда "uplink on|off"
+    constexpr uint32_t ANCHOR_INFO_MS = 5000;    // Период записи с координатами anchor
+  }
+  
+  namespace Capture {
+    // Запись сырого приема в USB Serial для воспроизведения на хосте (rx_capture.h)
+    #ifdef PLATFORM_MEGA2560
+      constexpr size_t CHUNK_SIZE = 48;           // Байт записи блока: с кадром < 64 байт TX буфера
+    #else
+      constexpr size_t CHUNK_SIZE = 160;          // Байт записи блока (до 253)
+    #endif
+    constexpr uint32_t FLUSH_MS = 50;             // Неполный блок уходит не позже (от первого события)
+  }
+  
+  namespace Log {
+    // Асинхронный лог: записей в кольцевом буфере (степень двойки, по 20 байт)
+    #ifdef PLATFORM_ESP32
+      constexpr uint16_t BUFFER_RECORDS  = 256;
+    #elif defined(PLATFORM_MEGA2560)
+      constexpr uint16_t BUFFER_RECORDS  = 16;    // Mega - меньше памяти
+    #elif defined(PLATFORM_NATIVE)
+      constexpr uint16_t BUFFER_RECORDS  = 256;
+    #endif
+    
+    constexpr uint32_t DRAIN_PERIOD_MS     = 20;    // Период задачи вывода (ESP32)
+    constexpr uint8_t  DRAIN_BATCH         = 16;    // Записей за один проход задачи
+    constexpr uint8_t  DRAIN_TASK_PRIORITY = 1;     // Ниже loop() (priority 1 на core 1)
+    constexpr uint8_t  DRAIN_TASK_CORE     = 0;     // loop() работает на core 1
+    constexpr uint16_t DRAIN_TASK_STACK    = 3072;
+    constexpr uint8_t  POLL_MIN_TX_SPACE   = 48;    // AVR: печатать, только если влезет в TX буфер
+  }
+  
+  namespace Pipeline {
+    // Двухъядерный RX (ESP32, -D RX_PIPELINE); Arduino loop() работает на core 1
+    constexpr uint16_t QUEUE_DEPTH      = 8;     // Кадров reader -> process (степень двойки)
+    constexpr uint8_t  READER_CORE      = 0;
+    constexpr uint8_t  READER_PRIORITY  = 10;    // Выше всех задач приложения
+    constexpr uint8_t  PROCESS_CORE     = 1;
+    constexpr uint8_t  PROCESS_PRIORITY = 3;
+    constexpr uint8_t  RENDER_CORE      = 1;
+    constexpr uint8_t  RENDER_PRIORITY  = 1;     // Как loop(), ниже process
+    constexpr uint16_t TASK_STACK       = 4096;
+    constexpr uint32_t RENDER_PERIOD_MS = 200;   // Частота OLED независимо от потока кадров
+    constexpr uint32_t REPORT_PERIOD_MS = 5000;  // Отчет об очереди и задержках стадий
+  }
+  
+  namespace Stats {
+    // Гистограммы задержки/джиттера RX: 2^SUB_BITS корзин на октаву
+    #ifdef PLATFORM_MEGA2560
+      constexpr uint8_t HIST_SUB_BITS = 3;     // Ошибка <= 12.5%, 2 x 352 байта
+    #else
+      constexpr uint8_t HIST_SUB_BITS = 4;     // Ошибка <= 6.25%, 2 x 672 байта
+    #endif
+    constexpr uint8_t  HIST_MAX_BITS = 24;      // Верхняя корзина от 16.7 s
+    constexpr uint32_t WINDOW_MS     = 60000;   // Окно перцентилей
+  }
+  
+  namespace Node {
+    // Значения по умолчанию, пока в NVS/EEPROM нет записи ConfigStore
+    // (команды "anchor" на RX и "/tag" на TX) - одна прошивка на все узлы
+    constexpr uint8_t  ANCHOR_ID   = 0;      // Уникальный ID этого RX (0, 1, 2...)
+    constexpr float    ANCHOR_X    = 0.0f;   // Координата X (метры)
+    constexpr float    ANCHOR_Y    = 0.0f;   // Координата Y (метры)
+    constexpr uint16_t EEPROM_ADDR = 0;      // AVR: адрес записи в EEPROM
+  }
+  
+  namespace Tag {
+    // Идентификатор передатчика в кадре (-D TAG_ID=n, переопределяется из ConfigStore).
+    // 0 - без ID: кадры текст/v1 как раньше, на байты короче (один тег в сети)
+    #ifdef TAG_ID
+      constexpr uint16_t ID = TAG_ID;
+    #else
+      constexpr uint16_t ID = 0;
+    #endif
+    constexpr uint16_t MAX_ID = 0x7FFF;
+    
+    // Таблицы по тегам на RX: SEQ, опорные кадры v2, последняя позиция
+    #ifdef PLATFORM_MEGA2560
+      constexpr uint8_t MAX_TAGS = 4;
+    #else
+      constexpr uint8_t MAX_TAGS = 64;
+    #endif
+  }
+  
+  namespace Seq {
+    // Учет SEQ по отправителям (битовая карта 64 номера на поток)
+    constexpr uint8_t  MAX_SENDERS = Tag::MAX_TAGS + 1;  // Теги + опорный anchor (SYNC)
+    constexpr uint32_t MAX_JUMP    = 64;     // Скачок SEQ вперед больше - нужен подтверждающий кадр
+  }
+  
+  namespace Scheduler {
+    constexpr uint8_t MAX_TASKS = 8;             // Задач в таблице кооперативного планировщика
+  }
+  
+  namespace Tx {
+    // Неблокирующий TX: очередь кадров ждет, пока AUX занят
+    constexpr uint8_t  QUEUE_DEPTH       = 4;     // Ожидающих кадров (beacon + консоль)
+    constexpr uint8_t  MAX_FRAME         = 60;    // Предел LoRa_E32::sendMessage: подпакет 58 + 2
+    constexpr bool     BATCHING          = true;  // Несколько кадров в одной передаче (пакет 0xBF)
+    constexpr uint8_t  BATCH_MAX_BYTES   = 58;    // Пакет целиком в одном подпакете E32
+    constexpr uint32_t BATCH_FLUSH_MS    = 20;    // Ожидание попутных кадров после первого
+    constexpr uint32_t SEND_POLL_MS      = 1;     // Опрос AUX во время передачи
+    constexpr uint32_t SEND_TIMEOUT_MS   = 1000;  // AUX не поднялся - передача неудачна (как в библиотеке)
+    constexpr uint32_t LED_PULSE_MS      = 50;    // Вспышка LED после передачи
+    constexpr uint32_t CONSOLE_PERIOD_MS = 10;    // Опрос USB Serial
+    constexpr uint32_t STATUS_PERIOD_MS  = 5000;  // Отчет о джиттере и задачах
+  }
+  
+  namespace Pacing {
+    // Интервал beacon по эфиру кадра (BeaconPacer): наименьший в обоих бюджетах
+    constexpr bool     ENABLED             = true;   // false - Timing::PING_INTERVAL
+    constexpr uint16_t DUTY_CYCLE_PERMILLE = 100;    // Доля эфира этого тега (10%)
+    constexpr uint16_t COLLISION_PERMILLE  = 200;    // Вероятность коллизии кадра (ALOHA), <= 500
+    constexpr uint8_t  CHANNEL_SENDERS     = 1;      // Тегов с тем же интервалом в канале
+    constexpr uint32_t MIN_INTERVAL_MS     = 200;
+    constexpr uint32_t MAX_INTERVAL_MS     = 60000;
+    constexpr uint8_t  JITTER_PERCENT      = 10;     // Случайный разброс интервала +-
+  }
+  
   namespace Display {
-    constexpr uint8_t OLED_ADDRESS = 0x3C;  // SSD1306 I2C address (0x3C or 0x3D)
-    constexpr uint8_t OLED_WIDTH   = 128;   // OLED width in pixels
-    constexpr uint8_t OLED_HEIGHT  = 64;    // OLED height in pixels
-    constexpr bool    OLED_ENABLED = true;  // Enable/disable OLED display
+    constexpr uint8_t  OLED_ADDRESS   = 0x3C;    // SSD1306 I2C address (0x3C or 0x3D)
+    constexpr uint8_t  OLED_WIDTH     = 128;     // OLED width in pixels
+    constexpr uint8_t  OLED_HEIGHT    = 64;      // OLED height in pixels
+    constexpr bool     OLED_ENABLED   = true;    // Enable/disable OLED display
+    constexpr uint32_t I2C_CLOCK_HZ   = 400000;  // SSD1306 поддерживает Fast-mode I2C
+    constexpr uint8_t  I2C_CHUNK      = 32;      // Байт данных за транзакцию (буфер Wire)
+    constexpr uint8_t  MAX_REFRESH_HZ = 5;       // Чаще - обновления склеиваются до tick()
   }
 }
 
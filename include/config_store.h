@@ -0,0 +1,64 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Persistent Node Configuration =====
+// Настройки узла без перепрошивки: ID и координаты anchor, ID тега.
+// Читаются один раз при старте, меняются командой из Serial.
+// Запись: magic, версия, длина данных, данные (little-endian), CRC-16/CCITT.
+// Хранилище: ESP32 - NVS (Preferences "node"/"cfg"), AVR - EEPROM с
+// Config::Node::EEPROM_ADDR, хост - RAM. Нет записи, чужая версия или
+// CRC не сошелся - значения по умолчанию из config.h.
+
+struct NodeConfig {
+  uint8_t anchorId;
+  float anchorX;   // Метры
+  float anchorY;
+  uint16_t tagId;  // 0 - кадры без ID
+  
+  NodeConfig();
+};
+
+class ConfigStore {
+public:
+  enum LoadResult : uint8_t {
+    LOAD_OK,
+    LOAD_EMPTY,        // Записи нет (новая плата)
+    LOAD_BAD_VERSION,  // Другая версия записи
+    LOAD_BAD_CRC       // Запись повреждена
+  };
+  
+  static const uint8_t RECORD_MAGIC   = 0xC5;
+  static const uint8_t RECORD_VERSION = 1;
+  static const uint8_t PAYLOAD_SIZE   = 11;  // anchorId, x, y, tagId
+  static const uint8_t RECORD_SIZE    = 3 + PAYLOAD_SIZE + 2;
+  
+  // Чтение при старте; не OK - в config() значения по умолчанию
+  LoadResult load();
+  
+  // Запись config() целиком; false - хранилище недоступно
+  bool save();
+  
+  NodeConfig& config() { return current; }
+  const NodeConfig& config() const { return current; }
+  
+  // Разбор "<id> <x> <y>" команды anchor; false - формат или диапазон
+  static bool parseAnchor(const char* args, uint8_t& id, float& x, float& y);
+  
+  static const char* resultName(LoadResult result);
+  
+private:
+  NodeConfig current;
+  
+  void encode(uint8_t* record) const;
+  LoadResult decode(const uint8_t* record);
+  
+  bool readRecord(uint8_t* record);
+  bool writeRecord(const uint8_t* record);
+};
+
+extern ConfigStore configStore;
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,46 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <Arduino.h>
+
+// ===== CRC-16/CCITT-FALSE =====
+// poly 0x1021, init 0xFFFF, без отражения и финального XOR ("123456789" -> 0x29B1).
+// Таблица 256 x uint16 строится компилятором из constexpr-функций и лежит во
+// flash (PROGMEM, 512 байт на AVR). Шаг - один поиск в таблице на байт, поэтому
+// CRC кадра считается по мере приема байт из UART, без отдельного прохода.
+
+constexpr uint16_t CRC16_INIT = 0xFFFF;
+constexpr uint16_t CRC16_POLY = 0x1021;
+
+// Побитный сдвиг через полином - только для вычислений при компиляции
+constexpr uint16_t crc16Shift(uint16_t crc, uint8_t bits) {
+  return bits == 0 ? crc
+                   : crc16Shift((crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1),
+                                bits - 1);
+}
+
+// Элемент таблицы: CRC старшего байта
+constexpr uint16_t crc16TableEntry(uint8_t index) {
+  return crc16Shift((uint16_t)index << 8, 8);
+}
+
+constexpr uint16_t crc16UpdateConst(uint16_t crc, uint8_t b) {
+  return (uint16_t)(crc << 8) ^ crc16TableEntry((uint8_t)((crc >> 8) ^ b));
+}
+
+// CRC строки при компиляции (постоянные префиксы кадров)
+constexpr uint16_t crc16Const(const char* s, uint16_t crc = CRC16_INIT) {
+  return *s ? crc16Const(s + 1, crc16UpdateConst(crc, (uint8_t)*s)) : crc;
+}
+
+extern const uint16_t CRC16_TABLE[256] PROGMEM;
+
+// Добавить байт к CRC
+inline uint16_t crc16Update(uint16_t crc, uint8_t b) {
+  return (uint16_t)(crc << 8) ^ pgm_read_word(&CRC16_TABLE[(uint8_t)((crc >> 8) ^ b)]);
+}
+
+// CRC буфера (продолжение с crc - для данных частями)
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = CRC16_INIT);
+
+#endif // CRC16_H
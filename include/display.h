@@ -17,6 +17,9 @@ struct RxStats;
 
 class DisplayManager {
 public:
+  // Экран RX: последний кадр или перцентили задержки (rxLatencyStats)
+  enum Page { PAGE_RX, PAGE_LATENCY };
+  
   DisplayManager();
   
   // Инициализация дисплея
@@ -25,9 +28,13 @@ public:
   // TX режим: показать статус передачи
   void showTxStatus(uint32_t sequence, const String& message, bool success);
   
-  // RX режим: показать принятый пакет
+  // RX режим: показать принятый пакет (или страницу задержек, если выбрана)
   void showRxStatus(const PacketData& packet, const RxStats& stats);
   
+  // Выбор экрана RX; применяется со следующим showRxStatus()
+  void setPage(Page page);
+  Page getPage() const;
+  
   // Показать экран инициализации
   void showInitScreen(const String& mode);
   
@@ -37,16 +44,43 @@ public:
   // Очистить дисплей
   void clear();
   
+  // Отложенный вывод: отправить измененные строки, если позволяет MAX_REFRESH_HZ.
+  // Вызывать из loop()/задачи отрисовки; show*() только обновляют содержимое строк.
+  void tick();
+  
+  // Замеры I2C: последний/максимальный вывод и полный кадр (1 КБ) при старте
+  uint32_t getFlushCount() const;
+  uint32_t getLastFlushUs() const;
+  uint32_t getMaxFlushUs() const;
+  uint32_t getFullFrameUs() const;
+  
 private:
 #ifdef PLATFORM_ESP32
+  // Retained mode: текст 8 строк x 21 символ (шрифт 6x8), строка = страница SSD1306
+  static const uint8_t ROWS = Config::Display::OLED_HEIGHT / 8;
+  static const uint8_t COLS = Config::Display::OLED_WIDTH / 6;
+  
   Adafruit_SSD1306* display;
   bool isEnabled;
+  Page page;
+  
+  char rows[ROWS][COLS + 1];  // Желаемое содержимое
+  uint8_t dirtyRows;          // Строки, отличающиеся от экрана (бит на строку)
+  uint32_t lastFlushMs;
+  
+  uint32_t flushCount;
+  uint32_t lastFlushUs;
+  uint32_t maxFlushUs;
+  uint32_t fullFrameUs;
   
-  // Форматирование времени
-  String formatTime(uint32_t micros);
+  // Заменить текст строки; помечает строку грязной, только если текст изменился
+  void setRow(uint8_t row, const char* text);
+  void clearRows();
+  void showLatencyPage();
   
-  // Обрезка длинных строк
-  String truncateString(const String& str, uint8_t maxLen);
+  // Перерисовать грязные строки в буфере и отправить только их страницы
+  void flush();
+  void pushPages(uint8_t first, uint8_t last);
 #endif
 };
 
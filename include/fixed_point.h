@@ -0,0 +1,165 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ===== Fixed-point Numbers =====
+// Знаковое число Q(31-FRAC).FRAC в int32_t: Q16.16 (±32768, шаг 1.5e-5) и
+// Q24.8 (±8.4e6, шаг 0.004). Для МК без FPU (ATmega2560): сложение - одна
+// 32-битная операция вместо вызова soft-float.
+// Умножение и деление - через int64 с округлением и насыщением до границ
+// диапазона; сложение и вычитание не насыщаются - диапазон промежуточных
+// значений обеспечивает вызывающий код (решатель TDOA нормирует координаты).
+// NumTraits<T> - общий интерфейс float и Fixed для шаблонного кода.
+
+template <uint8_t FRAC>
+class Fixed {
+public:
+  // enum, а не static-члены: значения в тернарных выражениях без определения вне класса
+  enum : int32_t {
+    ONE     = (int32_t)1 << FRAC,
+    RAW_MAX = 0x7FFFFFFF,
+    RAW_MIN = -0x7FFFFFFF   // Симметрично: -RAW_MIN представимо
+  };
+  
+  int32_t raw;
+  
+  constexpr Fixed() : raw(0) {}
+  
+  static constexpr Fixed fromRaw(int32_t value) { return Fixed(value, RawTag()); }
+  
+  // Константы (скорость света и т.п.) сворачиваются компилятором
+  static constexpr Fixed fromFloat(float value) {
+    return fromRaw(value * ONE >= 2147483520.0f ? RAW_MAX :
+                   value * ONE <= -2147483520.0f ? RAW_MIN :
+                   (int32_t)(value * ONE + (value < 0 ? -0.5f : 0.5f)));
+  }
+  
+  static constexpr Fixed fromInt(int32_t value) {
+    return fromRaw(value > (RAW_MAX >> FRAC) ? RAW_MAX :
+                   value < (RAW_MIN >> FRAC) ? RAW_MIN :
+                   value * ONE);
+  }
+  
+  constexpr float toFloat() const { return (float)raw / ONE; }
+  
+  constexpr Fixed operator+(Fixed o) const { return fromRaw(raw + o.raw); }
+  constexpr Fixed operator-(Fixed o) const { return fromRaw(raw - o.raw); }
+  constexpr Fixed operator-() const { return fromRaw(-raw); }
+  
+  constexpr Fixed operator*(Fixed o) const {
+    return fromRaw(saturate(((int64_t)raw * o.raw + (ONE >> 1)) >> FRAC));
+  }
+  
+  // Деление на 0 - граница диапазона со знаком делимого
+  Fixed operator/(Fixed o) const {
+    if (o.raw == 0) return fromRaw(raw >= 0 ? RAW_MAX : RAW_MIN);
+    return fromRaw(saturate((int64_t)raw * ONE / o.raw));
+  }
+  
+  Fixed& operator+=(Fixed o) { raw += o.raw; return *this; }
+  Fixed& operator-=(Fixed o) { raw -= o.raw; return *this; }
+  Fixed& operator*=(Fixed o) { return *this = *this * o; }
+  
+  constexpr bool operator==(Fixed o) const { return raw == o.raw; }
+  constexpr bool operator!=(Fixed o) const { return raw != o.raw; }
+  constexpr bool operator<(Fixed o) const { return raw < o.raw; }
+  constexpr bool operator>(Fixed o) const { return raw > o.raw; }
+  constexpr bool operator<=(Fixed o) const { return raw <= o.raw; }
+  constexpr bool operator>=(Fixed o) const { return raw >= o.raw; }
+  
+  // sqrt(raw * 2^FRAC) поразрядно, без деления; отрицательное - 0
+  Fixed sqrt() const {
+    if (raw <= 0) return Fixed();
+    uint64_t n = (uint64_t)raw << FRAC;
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << ((63 - __builtin_clzll(n)) & ~1);  // Старшая четная степень <= n
+    while (bit) {
+      if (n >= result + bit) {
+        n -= result + bit;
+        result = (result >> 1) + bit;
+      } else {
+        result >>= 1;
+      }
+      bit >>= 2;
+    }
+    return fromRaw((int32_t)result);
+  }
+  
+  // Насыщение: значение достигло границы (переполнение в цепочке)
+  constexpr bool isSaturated() const { return raw == RAW_MAX || raw <= RAW_MIN; }
+  
+private:
+  struct RawTag {};
+  constexpr Fixed(int32_t value, RawTag) : raw(value) {}
+  
+  static constexpr int32_t saturate(int64_t value) {
+    return value > RAW_MAX ? RAW_MAX : value < RAW_MIN ? RAW_MIN : (int32_t)value;
+  }
+};
+
+typedef Fixed<16> Q16_16;
+typedef Fixed<8>  Q24_8;
+
+// ===== NumTraits =====
+// NORMALIZE    - шаблонный код масштабирует входы степенью двойки до |v| < 2^MAX_INPUT_EXP
+// epsilon()    - наименьший различимый положительный порог
+// exponent(v)  - e: |v| < 2^e
+// scale(v, e)  - v * 2^e (точно для степеней двойки)
+// isValid(v)   - не NaN/Inf и не насыщено
+template <typename T>
+struct NumTraits;
+
+template <>
+struct NumTraits<float> {
+  static constexpr bool NORMALIZE = false;
+  static constexpr int8_t MAX_INPUT_EXP = 0;
+  
+  static constexpr float fromFloat(float v) { return v; }
+  static constexpr float fromInt(int32_t v) { return (float)v; }
+  static constexpr float toFloat(float v) { return v; }
+  static constexpr float epsilon() { return 1e-30f; }
+  static float sqrt(float v) { return sqrtf(v); }
+  static float abs(float v) { return fabsf(v); }
+  static int8_t exponent(float v) { int e; frexpf(v, &e); return (int8_t)e; }
+  static float scale(float v, int8_t e) { return ldexpf(v, e); }
+  static bool isValid(float v) { return isfinite(v); }
+};
+
+template <uint8_t FRAC>
+struct NumTraits<Fixed<FRAC> > {
+  typedef Fixed<FRAC> T;
+  
+  // Произведения сумм квадратов в решателе TDOA: Q16.16 - входы до 1,
+  // Q24.8 - до 4 (меньше дробных бит, больше целых)
+  static constexpr bool NORMALIZE = true;
+  static constexpr int8_t MAX_INPUT_EXP = FRAC >= 16 ? 0 : 2;
+  
+  static constexpr T fromFloat(float v) { return T::fromFloat(v); }
+  static constexpr T fromInt(int32_t v) { return T::fromInt(v); }
+  static constexpr float toFloat(T v) { return v.toFloat(); }
+  static constexpr T epsilon() { return T::fromRaw(1); }
+  static T sqrt(T v) { return v.sqrt(); }
+  static T abs(T v) { return v.raw < 0 ? -v : v; }
+  
+  static int8_t exponent(T v) {
+    uint32_t mag = v.raw < 0 ? (uint32_t)-v.raw : (uint32_t)v.raw;
+    int8_t bits = 0;
+    while (mag) {
+      mag >>= 1;
+      bits++;
+    }
+    return bits - FRAC;
+  }
+  
+  // Сдвиг вправо с округлением; влево - вызывающий код следит за диапазоном
+  static T scale(T v, int8_t e) {
+    if (e >= 0) return T::fromRaw(v.raw * ((int32_t)1 << e));
+    return T::fromRaw((v.raw + ((int32_t)1 << (-e - 1))) >> -e);
+  }
+  
+  static bool isValid(T v) { return !v.isSaturated(); }
+};
+
+#endif // FIXED_POINT_H
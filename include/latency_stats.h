@@ -0,0 +1,111 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+
+// ===== RX Latency / Jitter Histograms =====
+// Log-linear гистограмма (как HDR Histogram): значения меньше 2^SUB_BITS -
+// точные корзины, дальше каждая октава делится на 2^SUB_BITS линейных
+// корзин. Память постоянная, относительная ошибка не больше 2^-SUB_BITS.
+// RxLatencyStats ведет две гистограммы по RxStats каждого кадра:
+//   latency - latency_us (TX->RX, содержит смещение часов тега);
+//   jitter  - |D| по RFC 3550: изменение транзита между соседними кадрами
+//             одного тега, смещение его часов в разности сокращается.
+// Транзит последнего кадра - в таблице по ID тега (вытесняется тот, кто
+// молчит дольше всех, как в SequenceTable).
+// Окно WINDOW_MS: по его окончании гистограммы сбрасываются, а перцентили
+// сохраняются как итог последнего завершенного окна.
+
+class LogLinearHistogram {
+public:
+  static const uint8_t  SUB_BITS = Config::Stats::HIST_SUB_BITS;
+  static const uint8_t  MAX_BITS = Config::Stats::HIST_MAX_BITS;
+  static const uint16_t BUCKETS  = (uint16_t)(MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+  
+  LogLinearHistogram() { reset(); }
+  
+  void reset();
+  
+  // Значения от 2^MAX_BITS попадают в последнюю корзину (max - точный)
+  void record(uint32_t value);
+  
+  // Верхняя граница корзины с рангом pct% (не больше max); 0 - пусто
+  uint32_t percentile(uint8_t pct) const;
+  
+  uint32_t getCount() const { return count; }
+  uint32_t getMax() const { return maxValue; }
+  
+private:
+  uint16_t counts[BUCKETS];  // Насыщаются на 65535 - окно столько кадров не вмещает
+  uint32_t count;
+  uint32_t maxValue;
+  
+  static uint16_t bucketOf(uint32_t value);
+  static uint32_t bucketUpper(uint16_t bucket);
+};
+
+struct LatencySummary {
+  uint32_t count;
+  uint32_t p50_us;
+  uint32_t p90_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+  
+  LatencySummary() : count(0), p50_us(0), p90_us(0), p99_us(0), max_us(0) {}
+};
+
+class RxLatencyStats {
+public:
+  RxLatencyStats();
+  
+  // Кадр тега (не SYNC); окно сдвигается здесь же
+  void record(uint16_t tagId, const RxStats& stats);
+  
+  // Кадр отброшен парсером по CRC (PacketParser::lastErrorCrc)
+  void recordCrcReject() { crcRejects++; }
+  uint32_t getCrcRejects() const { return crcRejects; }
+  
+  // Текущее (неполное) окно
+  LatencySummary currentLatency() const { return summarize(latency); }
+  LatencySummary currentJitter() const { return summarize(jitter); }
+  
+  // Последнее завершенное окно (count == 0 - еще не было)
+  const LatencySummary& lastLatency() const { return lastLatencyWindow; }
+  const LatencySummary& lastJitter() const { return lastJitterWindow; }
+  
+  // Секунд с начала текущего окна
+  uint32_t getWindowAge_s() const { return (millis() - windowStartMs) / 1000; }
+  
+  // Отчет для команды "stats": оба окна, только чтение
+  void printReport(Print& out) const;
+  
+private:
+  LogLinearHistogram latency;
+  LogLinearHistogram jitter;
+  LatencySummary lastLatencyWindow;
+  LatencySummary lastJitterWindow;
+  
+  uint32_t windowStartMs;
+  
+  // Транзит (latency_us - airtime_us) предыдущего кадра тега
+  struct TagTransit {
+    uint16_t tagId;
+    bool used;
+    int32_t lastTransit_us;
+    uint32_t lastSeen_ms;
+  };
+  TagTransit transits[Config::Tag::MAX_TAGS];
+  
+  uint32_t negative;       // latency_us < 0: часы тега впереди, в гистограмму не входит
+  uint32_t crcRejects;     // За все время; пишет только поток чтения UART
+  
+  static LatencySummary summarize(const LogLinearHistogram& hist);
+  void roll();
+  TagTransit* findOrCreateTransit(uint16_t tagId, bool& created);
+};
+
+extern RxLatencyStats rxLatencyStats;
+
+#endif // LATENCY_STATS_H
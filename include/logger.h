@@ -0,0 +1,107 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Asynchronous Logger =====
+// Записи фиксированного размера (время, событие, 3 аргумента) кладутся в
+// кольцевой буфер без блокировок и без форматирования. Текст печатается
+// позже, в фоне: задачей FreeRTOS на ESP32 и из простоя loop() на AVR.
+// Буфер полон - запись отбрасывается и учитывается, вызывающий не ждет.
+
+// Уровни: записи выше LOG_LEVEL удаляются компилятором (-D LOG_LEVEL=4 для DEBUG)
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// События и подписи аргументов - таблица в logger.cpp
+enum LogEvent : uint8_t {
+  LOG_RX_BYTE,          // value
+  LOG_RX_FRAME,         // seq, lat_us, air_us
+  LOG_RX_MALFORMED,     // first_us, bytes
+  LOG_RX_ALIVE,         // ok, err, available
+  LOG_SYNC_SENT,        // seq, ok
+  LOG_SYNC_SAMPLE,      // samples, skew_ppb, jitter_ns
+  LOG_SYNC_STATUS,      // locked, samples, rejected
+  LOG_TDOA_RECORDED,    // key_lo, anchors
+  LOG_TDOA_NOT_SYNCED,  // seq
+  LOG_PIPELINE_QUEUE,   // hwm, dropped, frames
+  LOG_PIPELINE_AVG,     // read_us, queue_us, process_us
+  LOG_PIPELINE_MAX,     // read_us, queue_us, process_us
+  LOG_PIPELINE_RENDER,  // renders, avg_us, max_us
+  LOG_DISPLAY_FLUSH,    // flushes, max_us, full_us
+  LOG_SEQ_DUPLICATE,    // seq, sender
+  LOG_SEQ_SUSPECT,      // seq, sender
+  LOG_SEQ_RESYNC,       // seq, sender
+  LOG_EVENT_COUNT
+};
+
+struct LogRecord {
+  uint32_t time_us;
+  int32_t args[3];
+  uint8_t level;
+  uint8_t event;
+};
+
+class Logger {
+public:
+  Logger();
+  
+  // Запуск фонового вывода (ESP32: задача FreeRTOS)
+  void begin();
+  
+  // Добавить запись; false - буфер полон, запись отброшена. Можно из ISR.
+  bool record(uint8_t level, LogEvent event, int32_t a0 = 0, int32_t a1 = 0, int32_t a2 = 0);
+  
+  // Напечатать до maxRecords записей, вернуть число напечатанных
+  uint8_t drain(Print& out, uint8_t maxRecords);
+  
+  // Вывод из простоя loop() (AVR/native): одна запись, если не заблокирует USB Serial
+  void poll();
+  
+  uint32_t getDropped() const { return dropped; }
+  
+private:
+  #ifdef PLATFORM_MEGA2560
+    typedef uint8_t Index;
+    typedef int8_t IndexDiff;
+  #else
+    typedef uint32_t Index;
+    typedef int32_t IndexDiff;
+  #endif
+  
+  static const Index CAPACITY = Config::Log::BUFFER_RECORDS;
+  static const Index MASK = CAPACITY - 1;
+  
+  // Ячейка очереди Vyukov: seq == позиция - свободна, позиция + 1 - заполнена
+  struct Cell {
+    Index seq;
+    LogRecord record;
+  };
+  
+  Cell cells[CAPACITY];
+  Index enqueuePos;      // Общий для производителей (CAS)
+  Index dequeuePos;      // Только потребитель
+  uint32_t dropped;
+  uint32_t reportedDropped;
+  
+  bool pop(LogRecord& out);
+  void print(Print& out, const LogRecord& rec);
+};
+
+extern Logger logger;
+
+// Макросы уровней: при уровне ниже порога вызов и аргументы не компилируются в код
+#define LOG_ERROR(event, ...) do { if (LOG_LEVEL >= LOG_LEVEL_ERROR) logger.record(LOG_LEVEL_ERROR, event, ##__VA_ARGS__); } while (0)
+#define LOG_WARN(event, ...)  do { if (LOG_LEVEL >= LOG_LEVEL_WARN)  logger.record(LOG_LEVEL_WARN,  event, ##__VA_ARGS__); } while (0)
+#define LOG_INFO(event, ...)  do { if (LOG_LEVEL >= LOG_LEVEL_INFO)  logger.record(LOG_LEVEL_INFO,  event, ##__VA_ARGS__); } while (0)
+#define LOG_DEBUG(event, ...) do { if (LOG_LEVEL >= LOG_LEVEL_DEBUG) logger.record(LOG_LEVEL_DEBUG, event, ##__VA_ARGS__); } while (0)
+
+#endif // LOGGER_H
@@ -5,11 +5,20 @@
 #include <HardwareSerial.h>
 #include "LoRa_E32.h"
 #include "config.h"
+#include "packet.h"
 
 // ===== LoRa Module Management =====
 
 class LoRaModule {
 public:
+  // Состояние неблокирующей передачи
+  enum SendState {
+    SEND_IDLE,     // Передачи нет
+    SEND_BUSY,     // Кадр у модуля, AUX LOW
+    SEND_DONE,     // AUX поднялся - кадр ушел в эфир
+    SEND_TIMEOUT   // AUX не поднялся за SEND_TIMEOUT_MS
+  };
+  
   LoRaModule();
   
   // Инициализация модуля
@@ -18,15 +27,62 @@ public:
   // Проверка готовности модуля (AUX HIGH)
   bool checkReady();
   
-  // Отправка сообщения
-  bool sendMessage(const String& message);
+  // Блокирующая отправка кадра (текст с терминатором или бинарь).
+  // С Protocol::COBS_FRAMING кадр уходит с синхрословом и длиной (cobs_framing.h),
+  // предел - Tx::MAX_FRAME байт на проводе
+  bool sendMessage(const uint8_t* data, size_t length);
+  
+  // Модель задержки от записи кадра length байт в UART до начала эфира:
+  // первый подпакет на UART, для неполного - пауза IDLE_GAP_BYTES
+  uint32_t txAirDelay_us(size_t length) const;
+  
+  // Начало эфира последней sendMessage(): подъем AUX минус время в эфире.
+  // false - подъем не пойман (нет enableRxTimestamps() или передача неудачна)
+  bool getSendAirStart_us(uint32_t& airStart_us) const;
+  
+  // Неблокирующая отправка: кадр пишется в UART, ожидание AUX - в pollSend().
+  // false - модуль занят (AUX LOW), предыдущая передача не завершена или кадр велик
+  bool startSend(const uint8_t* data, size_t length);
+  
+  // Опрос передачи, начатой startSend(); DONE/TIMEOUT возвращается один раз
+  SendState pollSend();
+  
+  // Начало последней передачи startSend() (micros)
+  uint32_t getSendStart_us() const { return sendStart_us; }
+  
+  // ===== Пакетирование TX =====
+  // Логические кадры копятся в буфере и уходят одной передачей E32: одна
+  // преамбула на пакет вместо преамбулы на кадр. RX разбирает пакет обратно.
+  
+  // Добавить кадр в пакет; false - не влезает (сначала flushBatch())
+  bool batchAppend(const uint8_t* data, size_t length);
+  bool batchFits(size_t length) const;
+  uint8_t getBatchFrames() const { return batchFrames; }
+  void batchClear() { batchLen = 0; batchFrames = 0; }
+  
+  // Отправить пакет через startSend(); один кадр уходит без заголовка пакета
+  bool flushBatch();
+  
+  // Байт на эфир в последней передаче sendMessage()/startSend()/flushBatch()
+  size_t getLastSendBytes() const { return lastSendBytes; }
   
   // Проверка доступности данных для чтения
   int available();
   
-  // Чтение байта
+  // Чтение байта (с записью временной метки кадра)
   char read();
   
+  // Включить захват фронтов AUX в прерывании: спад - начало кадра на RX,
+  // подъем - конец эфира своей передачи
+  void enableRxTimestamps();
+  
+  // Забрать метки кадра, разобранного parser, и начать новый
+  // (внутри пакета кадров начало остается общим)
+  RxFrameTiming takeFrameTiming(const PacketParser& parser);
+  
+  // Сбросить метки (байт оказался разделителем между кадрами)
+  void resetFrameTiming() { frameTiming = RxFrameTiming(); }
+  
   // Получить указатель на Serial для расширенных операций
   HardwareSerial* getSerial() { return &loraSerial; }
   
@@ -37,6 +93,29 @@ private:
   HardwareSerial loraSerial;
   LoRa_E32 e32;
   
+  RxFrameTiming frameTiming;
+  uint16_t lastAuxFallCount;
+  uint16_t captureAuxCount;  // Последний спад AUX, попавший в запись приема
+  
+  bool sendActive;
+  bool sendSawBusy;      // AUX опускался во время передачи
+  uint32_t sendStart_us;
+  uint32_t sendUart_us;  // Время кадра на UART: AUX должен упасть раньше
+  
+  uint8_t batchBuffer[BATCH_PREFIX_SIZE + Config::Tx::MAX_FRAME];
+  uint8_t wireBuffer[Config::Tx::MAX_FRAME];  // Кадр с синхрословом
+  size_t batchLen;       // Байт кадров в пакете (без заголовка)
+  uint8_t batchFrames;
+  size_t lastSendBytes;
+  uint32_t sendAirStart_us;  // Начало эфира последней sendMessage() (по подъему AUX)
+  bool sendAirStartValid;
+  
+  // Байты передачи на проводе: кадр как есть или в wireBuffer с синхрословом (0 - не влезло)
+  size_t toWire(const uint8_t* data, size_t length, const uint8_t*& wire);
+  
+  // Запись приема: байт и новый спад AUX (метка ISR)
+  void captureRead(uint8_t b, uint32_t now);
+  
   void printStatus(const char* tag, ResponseStatus& st);
 };
 
@@ -0,0 +1,172 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// ===== Arduino shim для native (host) сборки =====
+// Минимальное подмножество Arduino API, которое использует src/common/:
+// String, Print/Stream, GPIO, прерывания и виртуальные часы.
+// micros()/millis() возвращают виртуальное время симуляции (см. sim_radio.h),
+// оно двигается только через delay()/Sim::advance() - прогоны детерминированы.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define F(s) (s)
+#define IRAM_ATTR
+
+// ===== Время (виртуальные часы симуляции) =====
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ===== GPIO =====
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// ===== Прерывания =====
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// ===== String =====
+class String {
+public:
+  String() {}
+  String(const char* s) : str(s ? s : "") {}
+  String(const std::string& s) : str(s) {}
+  explicit String(char c) : str(1, c) {}
+  explicit String(unsigned char v, unsigned char base = DEC) { fromUnsigned(v, base); }
+  explicit String(int v, unsigned char base = DEC) { fromSigned(v, base); }
+  explicit String(unsigned int v, unsigned char base = DEC) { fromUnsigned(v, base); }
+  explicit String(long v, unsigned char base = DEC) { fromSigned(v, base); }
+  explicit String(unsigned long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+  explicit String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+  explicit String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+  
+  unsigned int length() const { return (unsigned int)str.size(); }
+  const char* c_str() const { return str.c_str(); }
+  void reserve(unsigned int size) { str.reserve(size); }
+  
+  char charAt(unsigned int i) const { return i < str.size() ? str[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  
+  String& operator+=(const String& s) { str += s.str; return *this; }
+  String& operator+=(const char* s) { str += s; return *this; }
+  String& operator+=(char c) { str += c; return *this; }
+  bool concat(const String& s) { str += s.str; return true; }
+  
+  friend String operator+(const String& a, const String& b) { return String(a.str + b.str); }
+  friend String operator+(const String& a, const char* b) { return String(a.str + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.str); }
+  friend String operator+(const String& a, char c) { return String(a.str + c); }
+  
+  bool operator==(const String& s) const { return str == s.str; }
+  bool operator==(const char* s) const { return str == s; }
+  bool operator!=(const String& s) const { return str != s.str; }
+  bool operator!=(const char* s) const { return str != s; }
+  bool equals(const String& s) const { return str == s.str; }
+  
+  int indexOf(char c, unsigned int from = 0) const { return find(str.find(c, from)); }
+  int indexOf(const char* s, unsigned int from = 0) const { return find(str.find(s, from)); }
+  int indexOf(const String& s, unsigned int from = 0) const { return find(str.find(s.str, from)); }
+  bool startsWith(const String& s) const { return str.compare(0, s.str.size(), s.str) == 0; }
+  
+  String substring(unsigned int from) const { return substring(from, length()); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= str.size()) return String();
+    if (to > str.size()) to = (unsigned int)str.size();
+    return String(str.substr(from, to - from));
+  }
+  
+  void trim() {
+    size_t b = str.find_first_not_of(" \t\r\n");
+    size_t e = str.find_last_not_of(" \t\r\n");
+    str = (b == std::string::npos) ? std::string() : str.substr(b, e - b + 1);
+  }
+  
+  long toInt() const { return atol(str.c_str()); }
+  float toFloat() const { return (float)atof(str.c_str()); }
+  
+private:
+  std::string str;
+  
+  static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  void fromUnsigned(unsigned long v, unsigned char base);
+  void fromSigned(long v, unsigned char base);
+  void fromDouble(double v, unsigned char decimals);
+};
+
+// ===== Print / Stream =====
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size);
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return printNumber(v, base); }
+  size_t print(int v, int base = DEC) { return printSigned(v, base); }
+  size_t print(unsigned int v, int base = DEC) { return printNumber(v, base); }
+  size_t print(long v, int base = DEC) { return printSigned(v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printNumber(v, base); }
+  size_t print(long long v, int base = DEC) { return printSigned(v, base); }
+  size_t print(unsigned long long v, int base = DEC) { return printNumber(v, base); }
+  size_t print(double v, int digits = 2);
+  
+  size_t println() { return write((const uint8_t*)"\r\n", 2); }
+  template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+  
+private:
+  size_t printNumber(unsigned long long v, int base);
+  size_t printSigned(long long v, int base);
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+// ===== Character helpers (WCharacter.h) =====
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+inline bool isSpace(int c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+#include "HardwareSerial.h"
+
+#endif // NATIVE_ARDUINO_H
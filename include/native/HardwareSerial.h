@@ -0,0 +1,67 @@
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include "Arduino.h"
+
+#define SERIAL_8N1 0x06
+
+// ===== HardwareSerial stand-in =====
+// Приемный FIFO ограниченного размера: его наполняет симулятор E32 (UART1)
+// или тестовый код (USB Serial). Переполнение считается, как потеря байт
+// в драйвере UART. Передача USB Serial идет в stdout, если включено эхо,
+// передача UART симулятора - в приемник setTxSink().
+
+class HardwareSerial : public Stream {
+public:
+  typedef void (*TxSink)(void* ctx, const uint8_t* data, size_t len);
+  
+  explicit HardwareSerial(int uartNum);
+  
+  void begin(uint32_t baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+  void end() {}
+  uint32_t baudRate() const { return baud; }
+  
+  // Размер приемного буфера драйвера (как на ESP32)
+  void setRxBufferSize(size_t size);
+  
+  int available() override;
+  int read() override;
+  int peek() override;
+  
+  int availableForWrite() { return (int)MAX_RX_BUFFER; }  // Передача не блокирует
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  
+  // Со стороны "провода": байт пришел в UART. false - FIFO переполнен
+  bool inject(uint8_t b);
+  
+  // Эхо передачи в stdout (только USB Serial)
+  void setEcho(bool enabled) { echo = enabled; }
+  
+  // Приемник передачи: один вызов write() - один вызов приемника
+  void setTxSink(TxSink sink, void* ctx) { txSink = sink; txSinkCtx = ctx; }
+  
+  uint32_t getOverflows() const { return overflows; }
+  
+  operator bool() const { return true; }
+  
+private:
+  static const size_t MAX_RX_BUFFER = 4096;
+  
+  int uart;
+  uint32_t baud;
+  bool echo;
+  TxSink txSink;
+  void* txSinkCtx;
+  
+  uint8_t rxBuffer[MAX_RX_BUFFER];
+  size_t rxCapacity;
+  size_t rxHead;
+  size_t rxCount;
+  uint32_t overflows;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
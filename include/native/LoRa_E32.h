@@ -0,0 +1,37 @@
+#ifndef NATIVE_LORA_E32_H
+#define NATIVE_LORA_E32_H
+
+#include "Arduino.h"
+#include "HardwareSerial.h"
+
+// ===== LoRa_E32 stand-in =====
+// Подмножество API библиотеки xreef/LoRa_E32, которое использует LoRaModule.
+// Вызовы уходят в симулятор радио (sim_radio.h); sendMessage блокирует,
+// пока модуль не поднимет AUX, как и оригинальная библиотека.
+
+#define E32_SUCCESS        1
+#define ERR_E32_TIMEOUT    10
+#define ERR_E32_PACKET_TOO_BIG 17
+
+struct ResponseStatus {
+  uint8_t code;
+  
+  ResponseStatus() : code(0) {}
+  String getResponseDescription() const;
+};
+
+class LoRa_E32 {
+public:
+  LoRa_E32(HardwareSerial* serial, uint8_t auxPin);
+  
+  bool begin();
+  
+  ResponseStatus sendMessage(const String& message);
+  ResponseStatus sendMessage(const void* message, uint8_t size);
+  
+private:
+  HardwareSerial* serial;
+  uint8_t auxPin;
+};
+
+#endif // NATIVE_LORA_E32_H
@@ -0,0 +1,112 @@
+#ifndef NATIVE_SIM_RADIO_H
+#define NATIVE_SIM_RADIO_H
+
+#include "Arduino.h"
+#include "HardwareSerial.h"
+#include "airtime.h"
+
+// ===== Виртуальное время и события =====
+// micros()/millis() возвращают Sim::now_us(). Время идет только через
+// advance()/runUntil() (и delay() в коде прошивки), события выполняются
+// строго по порядку: байт UART, фронт AUX с вызовом ISR и т.д.
+
+namespace Sim {
+  typedef void (*EventFn)(void* ctx, uint32_t arg);
+  
+  uint64_t now_us();
+  void advance(uint64_t us);
+  void runUntil(uint64_t time_us);
+  void schedule(uint64_t time_us, EventFn fn, void* ctx, uint32_t arg);
+  
+  // Уровень входного пина "снаружи"; спад/фронт вызывает ISR (arduino_shim.cpp)
+  void setPinLevel(uint8_t pin, int level);
+}
+
+// ===== Симулятор E32 (transparent mode) =====
+// Модель:
+// - UART MCU <-> модуль: 10 бит на байт при скорости loraSerial.begin()
+// - эфир: подпакеты по 58 байт, каждый - пакет LoRa по модели airtime.h
+// - прием: AUX LOW после приема подпакета, через auxLead_us байты идут на UART,
+//   AUX HIGH после последнего байта подпакета
+// - передача: AUX LOW с первого байта на UART до конца эфира последнего подпакета;
+//   подпакет уходит, когда набрано 58 байт или UART молчит idleGapBytes байт
+// - потеря байт: независимая, с вероятностью byteLoss (детерминированный seed)
+
+struct SimRadioConfig {
+  LoraModulation modulation;  // SF/BW подпакета (по умолчанию - как на плате)
+  uint32_t auxLead_us;      // AUX LOW -> первый байт на UART при приеме (us)
+  uint8_t  idleGapBytes;    // Пауза UART, после которой модуль начинает передачу
+  float    byteLoss;        // Вероятность потери байта при приеме
+  float    bitFlip;         // Вероятность искажения байта (инверсия одного бита)
+  uint32_t seed;            // Seed генератора потерь
+  
+  SimRadioConfig();
+};
+
+struct SimRadioStats {
+  uint32_t framesInjected;   // Кадров принято из эфира
+  uint32_t framesSent;       // Кадров передано в эфир
+  uint32_t bytesDelivered;   // Байт выдано на UART
+  uint32_t bytesLost;        // Байт потеряно (byteLoss)
+  uint32_t bytesFlipped;     // Байт искажено (bitFlip)
+  uint32_t bytesOverflow;    // Байт потеряно на переполнении RX FIFO
+  uint64_t rxAirtime_us;     // Суммарный эфир принятых кадров
+  uint64_t txAirtime_us;     // Суммарный эфир переданных кадров
+};
+
+class SimE32 {
+public:
+  static const uint8_t SUBPACKET_SIZE = 58;
+  
+  SimE32();
+  
+  void configure(const SimRadioConfig& cfg);
+  const SimRadioConfig& getConfig() const { return config; }
+  
+  // Вызывается из LoRa_E32: UART модуля и пин AUX (после старта AUX HIGH)
+  void attach(HardwareSerial* serial, uint8_t auxPin);
+  
+  // Кадр удаленного передатчика, эфир начинается сейчас.
+  // Возвращает момент выдачи последнего байта на UART.
+  uint64_t injectAir(const uint8_t* data, size_t len);
+  
+  // Кадр от MCU через UART. Возвращает момент окончания эфира.
+  uint64_t transmit(const uint8_t* data, size_t len);
+  
+  // Начало эфира последней передачи (первый подпакет)
+  uint64_t getTxAirStart_us() const { return txAirStart_us; }
+  
+  // Эфир одного подпакета и время байта на UART
+  uint32_t airtime_us(size_t len) const;
+  uint32_t byteTime_us() const;
+  
+  uint8_t getAuxPin() const { return auxPin; }
+  const SimRadioStats& getStats() const { return stats; }
+  void resetStats();
+  
+private:
+  SimRadioConfig config;
+  SimRadioStats stats;
+  
+  HardwareSerial* serial;
+  uint8_t auxPin;
+  uint8_t auxBusy;       // Счетчик перекрывающихся интервалов AUX LOW
+  uint64_t rxAirEnd_us;  // Конец эфира последнего принятого подпакета
+  uint64_t rxUartEnd_us; // Конец выдачи на UART
+  uint64_t txAirStart_us; // Начало эфира последней передачи
+  uint64_t txAirEnd_us;  // Конец эфира последней передачи
+  uint32_t rngState;
+  
+  uint32_t nextRandom();
+  bool loseByte();
+  uint8_t corruptByte(uint8_t b);
+  
+  static void onAuxDown(void* ctx, uint32_t arg);
+  static void onAuxUp(void* ctx, uint32_t arg);
+  static void onUartByte(void* ctx, uint32_t arg);
+  static void onUartTx(void* ctx, const uint8_t* data, size_t len);
+};
+
+extern SimE32 simRadio;
+
+#endif // NATIVE_SIM_RADIO_H
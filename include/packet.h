@@ -2,42 +2,403 @@
 #define PACKET_H
 
 #include <Arduino.h>
+#include "config.h"
+#include "airtime.h"
+#include "crc16.h"
+#include "cobs_framing.h"
 
 // ===== Packet Structure for TDOA Navigation =====
-// Формат пакета: EUID:<id>,MSG:<message>,TIME:<micros>,SEQ:<seq>
+// Текстовый формат: EUID:<id>,MSG:<message>,TIME:<micros>,SEQ:<seq>,TAG:<tag>,CRC:<crc>\n
+//   ",TAG:" только у передатчика с ID; кадр без него - тег 0
+//   <crc> - 4 hex-цифры (верхний регистр) CRC-16 от "EUID:" до поля перед ",CRC:"
+//
+// Бинарный формат v1 (little-endian, фиксированная раскладка):
+//   [0]      0xB0 | версия   маркер бинарного кадра (в тексте байты < 0x80)
+//   [1]      len            длина тела: 12 + длина payload
+//   [2..5]   euid           счетчик пакетов TX (uint32)
+//   [6..9]   time           время отправки, micros() (uint32)
+//   [10..13] seq            порядковый номер (uint32)
+//   [14..]   payload        сообщение без терминатора
+//
+// Сравнение для beacon "BEACON" при air rate 2.4 kbps (модель SX1276, airtime.h):
+//   текст:  "EUID:12_3456789,MSG:BEACON,TIME:3456790,SEQ:12,CRC:1A2B\n" = 56 байт ~ 308 ms
+//   бинарь: 14 + 6 + 2 (CRC) = 22 байта ~ 165 ms
+//
+// Бинарный формат v3 - v1 с идентификатором тега (вместо v1, если ID задан):
+//   [0]      0xB3
+//   [1]      len            длина тела: 14 + длина payload
+//   [2..3]   tag            ID тега (uint16)
+//   [4..]    euid, time, seq, payload - как в v1 со сдвигом на 2
+//
+// Бинарный формат v2 - дельта-сжатие потока кадров одного передатчика:
+//   [0]      0xB2           маркер (версия 2)
+//   [1]      len            длина тела
+//   [2..]    tag            varint ID тега (1 байт для ID < 128)
+//   [..]     hdr            бит 7 - ключевой кадр, биты 6..4 - эпоха ключевого
+//                           кадра, биты 3..0 - индекс словаря (0 - payload как есть)
+//   ключевой: euid, time, seq (uint32 LE) - новая точка отсчета
+//   дельта:   varint(zigzag(x - x_ключ)) для euid, time, seq
+//   [..]     payload, если индекс словаря 0
+//   Дельты считаются от ключевого кадра, а не от предыдущего: потеря дельта-
+//   кадра не портит следующие. Пропущен ключевой кадр - до следующего кадры
+//   этой эпохи не декодируются. Точка отсчета на RX - своя у каждого тега.
+//   beacon "BEACON": ключевой 16 байт, дельта ~10 байт (против 20 в v1, 22 в v3)
+//
+// CRC бинарных кадров: бит 3 маркера (0xB9/0xBA/0xBB) - за телом 2 байта
+// CRC-16 (little-endian) от маркера до конца тела; len их не включает.
+// E32 в прозрачном режиме пропускает искаженные байты - без CRC кадр с
+// измененной цифрой TIME разбирается как верный.
+//
+// Пакет кадров (несколько логических кадров в одной передаче E32):
+//   [0]      0xBF           маркер пакета
+//   [1]      len            суммарная длина вложенных кадров (текст и/или бинарь)
+//   [2..]    кадры подряд, каждый со своим терминатором/длиной
+//   Все кадры пакета имеют общее начало в эфире и общий airtime.
 
+// Размеры полей PacketData (с завершающим '\0')
+constexpr size_t PACKET_EUID_SIZE    = 24;  // "4294967295_4294967295" + '\0'
+constexpr size_t PACKET_MESSAGE_SIZE = Config::Protocol::MAX_PAYLOAD_LENGTH + 1;
+
+// Текстовый кадр без payload при максимальных значениях полей:
+// "EUID:" 21 ",MSG:" ",TIME:" 10 ",SEQ:" 10 ",TAG:" 5 ",CRC:" 4 "\n"
+constexpr size_t TEXT_FRAME_OVERHEAD = 5 + 21 + 5 + 6 + 10 + 5 + 10 + 5 + 5 + 5 + 4 + 1;
+constexpr size_t TEXT_MAX_FRAME      = TEXT_FRAME_OVERHEAD + Config::Protocol::MAX_PAYLOAD_LENGTH;
+
+// Фиксированный размер, без String: можно держать в static/стеке без кучи
 struct PacketData {
-  String euid;          // Уникальный ID пакета (для корреляции на RX)
-  String message;       // Полезная нагрузка
+  char euid[PACKET_EUID_SIZE];        // Уникальный ID пакета (для корреляции на RX)
+  char message[PACKET_MESSAGE_SIZE];  // Полезная нагрузка
   uint32_t txTime_us;   // Время отправки (микросекунды)
   uint32_t sequence;    // Порядковый номер
+  uint16_t tagId;       // Передатчик (0 - кадр без ID)
   bool valid;           // Флаг успешного парсинга
   
-  PacketData() : txTime_us(0), sequence(0), valid(false) {}
+  PacketData() : txTime_us(0), sequence(0), tagId(0), valid(false) {
+    euid[0] = '\0';
+    message[0] = '\0';
+  }
+};
+
+// Временные метки кадра на RX (заполняет LoRaModule)
+struct RxFrameTiming {
+  uint32_t firstByte_us;  // Чтение первого байта кадра из UART
+  uint32_t lastByte_us;   // Чтение последнего байта (терминатора)
+  uint32_t auxFall_us;    // Спад AUX перед выдачей кадра (захват в ISR)
+  uint16_t byteCount;     // Байт кадра на проводе
+  uint16_t batchBytes;    // Кадр из пакета: длина всего пакета (0 - одиночный кадр)
+  bool auxValid;          // Спад AUX относится к этому кадру
+  
+  RxFrameTiming() : firstByte_us(0), lastByte_us(0), auxFall_us(0),
+                    byteCount(0), batchBytes(0), auxValid(false) {}
+  
+  // Начало кадра: аппаратная метка AUX, если есть, иначе первый байт
+  uint32_t start_us() const { return auxValid ? auxFall_us : firstByte_us; }
+  
+  // Байт в передаче E32, которая принесла кадр (для поправки на airtime)
+  uint16_t airBytes() const { return batchBytes ? batchBytes : byteCount; }
 };
 
 // Структура для статистики приема на RX
 struct RxStats {
-  uint32_t rxTime_us;   // Время приема (микросекунды)
+  uint32_t rxTime_us;   // Время приема начала кадра (микросекунды)
+  uint32_t rxEnd_us;    // Время приема последнего байта (микросекунды)
+  uint32_t airtime_us;  // Поправка: эфир первого подпакета до начала кадра (микросекунды)
   int32_t latency_us;   // Задержка TX->RX (микросекунды)
   int rssi;             // RSSI (dBm) - пока заглушка
   int snr;              // SNR (dB) - пока заглушка
   
-  RxStats() : rxTime_us(0), latency_us(0), rssi(-100), snr(0) {}
+  RxStats() : rxTime_us(0), rxEnd_us(0), airtime_us(0), latency_us(0),
+              rssi(-100), snr(0) {}
+  
+  // Оценка момента начала кадра в эфире - не зависит от длины кадра
+  uint32_t arrivalTime_us() const { return rxTime_us - airtime_us; }
+};
+
+// ===== Бинарный формат =====
+constexpr uint8_t BINARY_FRAME_MAGIC   = 0xB0;  // Старший полубайт - маркер
+constexpr uint8_t BINARY_MAGIC_MASK    = 0xF0;
+constexpr uint8_t BINARY_WIRE_VERSION  = 1;     // Младший полубайт - версия
+constexpr size_t  BINARY_PREFIX_SIZE   = 2;     // magic + len
+constexpr size_t  BINARY_HEADER_SIZE   = 14;    // magic + len + euid + time + seq
+constexpr uint8_t BINARY_CRC_FLAG      = 0x08;  // Бит версии: за телом CRC
+constexpr size_t  FRAME_CRC_SIZE       = 2;
+constexpr size_t  BINARY_MAX_FRAME     = BINARY_PREFIX_SIZE + 255 + FRAME_CRC_SIZE;
+constexpr uint8_t BINARY_DELTA_VERSION = 2;
+constexpr uint8_t BINARY_TAGGED_VERSION = 3;
+constexpr size_t  BINARY_TAGGED_HEADER_SIZE = BINARY_HEADER_SIZE + 2;  // + tag
+
+// Заголовок бинарного кадра v1/v3 для тега
+constexpr size_t binaryHeaderSize(uint16_t tagId) {
+  return tagId ? BINARY_TAGGED_HEADER_SIZE : BINARY_HEADER_SIZE;
+}
+
+// Кадр v1/v3 целиком, с CRC, если включен
+constexpr size_t binaryFrameSize(uint16_t tagId, size_t payloadLen) {
+  return binaryHeaderSize(tagId) + payloadLen + (Config::Protocol::FRAME_CRC ? FRAME_CRC_SIZE : 0);
+}
+constexpr uint8_t BATCH_FRAME_MAGIC    = BINARY_FRAME_MAGIC | 0x0F;  // Пакет кадров
+constexpr size_t  BATCH_PREFIX_SIZE    = 2;     // magic + len
+
+// ===== Дельта-сжатие (бинарный формат v2) =====
+constexpr uint8_t DELTA_KEYFRAME_FLAG  = 0x80;
+constexpr uint8_t DELTA_EPOCH_SHIFT    = 4;
+constexpr uint8_t DELTA_EPOCH_MASK     = 0x07;
+constexpr uint8_t DELTA_DICT_MASK      = 0x0F;
+constexpr size_t  DELTA_KEYFRAME_FIXED = 13;    // hdr + euid + time + seq (после tag)
+constexpr size_t  DELTA_MAX_BODY       = 64;    // Тело v2 целиком в буфере парсера
+// Эпоха 3 бита: после 8 пропущенных ключевых кадров подряд дельта совпадает
+// по эпохе со старой точкой отсчета. Дельта времени TX от ключевого кадра
+// должна сходиться с временем RX с его приема - иначе точка отсчета чужая.
+constexpr uint32_t DELTA_MAX_SKEW_US   = 1000000;
+
+// Словарь частых payload: индекс 1..DELTA_DICTIONARY_SIZE, общий для TX и RX
+extern const char* const DELTA_DICTIONARY[];
+extern const uint8_t DELTA_DICTIONARY_SIZE;
+
+// Кодер потока v2 (TX). Состояние - последний ключевой кадр; ID тега -
+// getLocalTagId(), его смена начинает поток с ключевого кадра.
+class DeltaEncoder {
+public:
+  DeltaEncoder();
+  
+  // Кодирование кадра v2, возвращает длину (0 - не влезло, состояние не меняется)
+  size_t encode(uint8_t* out, size_t outSize, const char* message, uint32_t sequence);
+  
+  // Следующий кадр - ключевой (например, ключевой кадр не ушел в эфир)
+  void forceKeyframe() { hasRef = false; }
+  
+private:
+  uint32_t refEuid;
+  uint32_t refTime;
+  uint32_t refSeq;
+  uint16_t refTag;
+  uint8_t epoch;
+  uint8_t sinceKeyframe;
+  bool hasRef;
+};
+
+// Размер кадра v2 для заданных дельт с CRC, если включен (для сравнения форматов)
+size_t deltaFrameSize(uint16_t tagId, const char* message, bool keyframe,
+                      int32_t euidDelta, int32_t timeDelta, int32_t seqDelta);
+
+// ===== Потоковый парсер =====
+// Принимает байты по одному прямо из UART, O(1) работы на байт, без кучи.
+// Текстовый кадр завершается на '\n'/'\r', бинарный - по длине из заголовка.
+// Мусор перед "EUID:" пропускается (как indexOf в старом parsePacket).
+// Пакет кадров (0xBF) разбирается на отдельные кадры; для каждого известны
+// длина пакета и индекс в нем.
+// CRC считается по ходу приема (шаг таблицы на байт) и сверяется на
+// терминаторе / последнем байте; несовпадение - FRAME_ERROR и getCrcErrors().
+// С кадрированием (Protocol::COBS_FRAMING) синхрослово 0x00 начинает кадр
+// COBS и прерывает текущий; байты декодируются и идут в тот же разбор, кадр
+// кончается по длине из заголовка. Байты вне кадра COBS - кадры старой
+// прошивки без синхрослова, разбираются как есть; 0x00 внутри их бинарного
+// тела - данные, а не синхрослово.
+
+class PacketParser {
+public:
+  enum Result : uint8_t {
+    NEED_MORE,    // Кадр еще не завершен
+    FRAME_OK,     // Кадр разобран, см. packet()
+    FRAME_ERROR   // Кадр отброшен (формат/переполнение)
+  };
+  
+  PacketParser();
+  
+  // Подать очередной байт
+  Result feed(uint8_t b);
+  
+  // Последний разобранный пакет (действителен после FRAME_OK)
+  const PacketData& packet() const { return current; }
+  
+  // Сброс в начальное состояние (начало нового кадра)
+  void reset();
+  
+  // Идет прием кадра (false - между кадрами, байт был разделителем)
+  bool inFrame() const { return cobs.isActive() || state != SEEK || frameBytes > 0 || batchRemaining > 0; }
+  
+  // Кадрирование синхрословом (по умолчанию Protocol::COBS_FRAMING);
+  // false - 0x00 всегда данные (поток только от старой прошивки)
+  void setSyncFraming(bool enabled) { syncFraming = enabled; syncTail = false; cobs.stop(); }
+  
+  // Кадр COBS: длина принята, байт до конца кадра известно заранее
+  bool frameLengthKnown() const { return cobs.hasLength(); }
+  uint8_t frameBytesRemaining() const { return cobs.getRemaining(); }
+  
+  // Идет прием пакета кадров: после FRAME_OK последуют кадры того же пакета
+  bool inBatch() const { return batchRemaining > 0 || state == BATCH_LEN; }
+  
+  // Последний FRAME_OK: длина пакета на проводе (0 - одиночный кадр) и индекс кадра в нем
+  uint16_t batchBytes() const { return frameBatchBytes; }
+  uint8_t batchIndex() const { return frameBatchIndex; }
+  
+  // Счетчики
+  uint32_t getFramesOk() const { return framesOk; }
+  uint32_t getFramesError() const { return framesError; }
+  
+  // Кадры v2 без своего ключевого кадра (пропущен в эфире) - входят в ошибки
+  uint32_t getDeltaMisses() const { return deltaMisses; }
+  
+  // Кадры с неверным CRC или без CRC при REQUIRE_CRC - входят в ошибки
+  uint32_t getCrcErrors() const { return crcErrors; }
+  
+  // Последний FRAME_ERROR - отказ по CRC
+  bool lastErrorCrc() const { return crcRejected; }
+  
+  // Кадры COBS, прерванные синхрословом или длиной (потеря/искажение байт) - входят в ошибки
+  uint32_t getSyncErrors() const { return syncErrors; }
+  
+private:
+  enum State : uint8_t {
+    SEEK,         // Поиск "EUID:" или бинарного маркера
+    EUID_VALUE,
+    MSG_TAG,      // Ожидание "MSG:" после ','
+    MSG_VALUE,    // Значение до ",TIME:"
+    TIME_VALUE,
+    SEQ_TAG,      // Ожидание "SEQ:" после ','
+    SEQ_VALUE,
+    TAGID_TAG,    // Ожидание "TAG:" после ','
+    TAGID_VALUE,
+    FIELD_TAG,    // ',' после SEQ/TAG: "TAG:" или "CRC:"
+    CRC_TAG,
+    CRC_VALUE,
+    BIN_LEN,
+    BIN_BODY,
+    BIN_CRC,      // 2 байта CRC за телом
+    BATCH_LEN,    // Длина пакета кадров после 0xBF
+    SKIP          // Ошибка: ждем терминатор или бинарный маркер
+  };
+  
+  PacketData current;
+  State state;
+  uint8_t tagPos;       // Позиция в сопоставляемом теге
+  uint16_t fieldLen;    // Длина текущего поля / принятых байт тела
+  uint16_t bodyLen;     // Длина тела бинарного кадра
+  uint16_t frameBytes;  // Байт в текущем кадре (для отличия пустых строк)
+  uint32_t binEuid;
+  bool binTagged;       // Бинарный v3 (v1 + tag)
+  bool binCrc;          // За телом CRC
+  uint16_t crc;         // CRC принятой части кадра
+  uint16_t rxCrc;       // CRC из кадра
+  uint32_t framesOk;
+  uint32_t framesError;
+  uint32_t crcErrors;
+  bool crcRejected;
+  
+  CobsDecoder cobs;
+  bool syncFraming;
+  bool syncTail;        // Кадр COBS кончился ошибкой: за ним может идти его хвост
+  
+  // Тело бинарного кадра или пакета без синхрослова (длина уже принята и не 0:
+  // ноль вместо длины - синхрослово за хвостом испорченного кадра COBS)
+  bool inUnframedBinary() const { return state == BIN_BODY || state == BIN_CRC || batchRemaining > 0; }
+  uint32_t syncErrors;
+  
+  // Декодер v2: тело кадра и точки отсчета (последний ключевой кадр) по тегам
+  struct DeltaRef {
+    uint32_t euid;
+    uint32_t time;
+    uint32_t seq;
+    uint32_t rx_us;   // Прием ключевого кадра (micros)
+    uint16_t tag;
+    uint8_t epoch;
+    bool used;
+  };
+  
+  bool deltaFrame;
+  uint8_t deltaBody[DELTA_MAX_BODY];
+  DeltaRef deltaRefs[Config::Tag::MAX_TAGS];
+  uint8_t deltaRefNext;  // Таблица полна - замена по кругу
+  uint32_t deltaMisses;
+  
+  // Пакет кадров: переживает reset() между вложенными кадрами
+  uint16_t batchRemaining;  // Байт пакета еще не принято
+  uint16_t batchTotal;      // Длина текущего пакета с заголовком
+  uint8_t batchNext;        // Индекс следующего кадра в пакете
+  uint16_t frameBatchBytes;
+  uint8_t frameBatchIndex;
+  
+  Result feedPayload(uint8_t b);
+  Result feedFrame(uint8_t b);
+  Result startSyncFrame();
+  Result endOfData(Result r);
+  Result completeBinary(bool checked);
+  Result completeDelta();
+  DeltaRef* findDeltaRef(uint16_t tag, bool create);
+  void setBinaryEuid(uint32_t counter);
+  void beginFrame();
+  Result fail();
+  Result failCrc();
+  Result complete();
+  Result completeUnchecked();
+  bool appendMessage(char c);
 };
 
 // ===== Функции работы с пакетами =====
 
-// Генерация уникального EUID
-String generateEUID();
+// ID тега в исходящих кадрах (по умолчанию Config::Tag::ID)
+void setLocalTagId(uint16_t tagId);
+uint16_t getLocalTagId();
+
+// Весь тракт кадра - буферы вызывающего, без String и кучи
+// (на AVR куча фрагментируется за часы работы).
+
+// Уникальный EUID "COUNTER_MICROS" с '\0' (буфер от PACKET_EUID_SIZE);
+// возвращает длину без '\0', 0 - буфер мал
+size_t generateEUID(char* out, size_t outSize);
+
+// Текстовый кадр с ",CRC:" (если включен) и терминатором '\n' (без '\0');
+// возвращает длину (0 - не влезло)
+size_t buildPacket(uint8_t* out, size_t outSize, const char* message, uint32_t sequence);
+
+// Парсинг принятого пакета (обертка над PacketParser): текст, бинарный или
+// кадр синхрослова целиком
+PacketData parsePacket(const char* data, size_t length);
+
+// Кодирование бинарного кадра (v3 с ID тега, v1 без) с CRC, если включен;
+// возвращает длину (0 - не влезло)
+size_t encodeBinaryPacket(uint8_t* out, size_t outSize, const char* message, uint32_t sequence);
 
-// Формирование пакета для отправки
-String buildPacket(const String& message, uint32_t sequence);
+// То же с заданной меткой TIME вместо micros() (опорный кадр SYNC: начало эфира)
+size_t encodeBinaryPacketAt(uint8_t* out, size_t outSize, const char* message, uint32_t sequence,
+                            uint32_t timestamp_us);
 
-// Парсинг принятого пакета
-PacketData parsePacket(const String& rawData);
+// Декодирование бинарного кадра целиком (magic + len + тело [+ CRC])
+PacketData decodeBinaryPacket(const uint8_t* frame, size_t length);
+
+// Является ли байт началом бинарного кадра
+inline bool isBinaryFrameStart(uint8_t b) {
+  return (b & BINARY_MAGIC_MASK) == BINARY_FRAME_MAGIC;
+}
+
+// Числовой ключ EUID для хеш-таблиц: "COUNTER_MICROS" упаковывается
+// без потерь в (counter << 32) | micros, иначе - FNV-1a 64
+uint64_t euidToKey(const char* euid);
+
+// Ключ передачи с учетом тега: одинаковые EUID разных тегов не совпадают
+inline uint64_t frameKey(const PacketData& packet) {
+  return euidToKey(packet.euid) ^ ((uint64_t)packet.tagId << 48);
+}
+
+// Модуляция E32 для настроенного air data rate
+constexpr LoraModulation E32_MODULATION = e32Modulation(Config::Protocol::AIR_DATA_RATE);
+static_assert(E32_SUBPACKET_SIZE == Config::Protocol::SUBPACKET_SIZE, "E32 subpacket size");
+
+// Время в эфире для кадра заданной длины (микросекунды), модель SX1276
+constexpr uint32_t estimateAirtime_us(size_t frameBytes) {
+  return e32Airtime_us(E32_MODULATION, frameBytes);
+}
+
+// Эфир до начала кадра на RX: E32 роняет AUX и выдает байты на UART
+// после приема первого подпакета, остальные приходят следом
+constexpr uint32_t estimateRxLead_us(size_t frameBytes) {
+  return estimateAirtime_us(frameBytes < E32_SUBPACKET_SIZE ? frameBytes : E32_SUBPACKET_SIZE);
+}
 
 // Вычисление статистики приема
 RxStats calculateRxStats(const PacketData& packet, uint32_t rxTime_us);
 
+// Вычисление статистики по меткам кадра с поправкой на время в эфире
+RxStats calculateRxStats(const PacketData& packet, const RxFrameTiming& timing);
+
 #endif // PACKET_H
@@ -0,0 +1,37 @@
+#ifndef RAM_MONITOR_H
+#define RAM_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== RAM High-Water Mark =====
+// AVR: begin() заполняет свободную RAM между кучей и стеком шаблоном;
+// минимальный запас - нетронутые байты шаблона над концом кучи (стек
+// пишет сверху, куча снизу). __brkval != 0 - был malloc (String, new):
+// тракт кадра должен работать без кучи, отчет это показывает.
+// ESP32: минимум свободной кучи за все время и запас стека задачи loop.
+// Хост: отчета нет.
+
+class RamMonitor {
+public:
+  RamMonitor();
+  
+  // Первым вызовом в setup(): дальше стек глубже не опускался
+  void begin();
+  
+  // Свободно сейчас / минимум с begin() (AVR: между кучей и стеком)
+  uint32_t getFreeNow() const;
+  uint32_t getMinFree() const;
+  
+  // Байт кучи в использовании (AVR: 0 - malloc ни разу не вызывался)
+  uint32_t getHeapUsed() const;
+  
+  void printReport(Print& out) const;
+  
+private:
+  uint8_t* paintEnd;  // Конец заполненной области (ниже - шаблон, AVR)
+};
+
+extern RamMonitor ramMonitor;
+
+#endif // RAM_MONITOR_H
@@ -0,0 +1,67 @@
+#ifndef RX_CAPTURE_H
+#define RX_CAPTURE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "capture.h"
+
+// ===== RX Capture (USB Serial) =====
+// Запись сырого приема по команде "capture on": LoRaModule::read() отдает
+// каждый байт с меткой чтения и новый спад AUX, события копятся в блок
+// capture.h и уходят одной записью в USB Serial. На хосте replay прогоняет
+// запись через тот же разбор, метки и TDOA (src/native/replay.cpp).
+// TX буфер не вмещает блок - он отбрасывается и считается, прием не ждет USB.
+// Включение и выключение применяет poll() - в том же потоке, что и чтение
+// (в RX_PIPELINE - задача reader), блок не делится между ядрами.
+
+class RxCapture {
+public:
+  RxCapture();
+  
+  // Узел для заголовка записи
+  void begin(uint8_t anchorId, float anchorX, float anchorY);
+  
+  // Запрос из консоли; применяется в poll()
+  void setEnabled(bool on) { requested = on; }
+  bool isEnabled() const { return requested; }
+  
+  // Запись идет (проверка в LoRaModule::read())
+  bool isActive() const { return active; }
+  
+  // События из LoRaModule::read(): спад AUX (метка ISR) и байт UART
+  void recordAux(uint32_t fall_us);
+  void recordByte(uint8_t b, uint32_t read_us);
+  
+  // Старт/стоп по запросу; неполный блок уходит не позже Capture::FLUSH_MS
+  void poll();
+  
+  // "capture": состояние и счетчики
+  void printReport(Print& out) const;
+  
+  uint32_t getSent() const { return sent; }
+  uint32_t getDropped() const { return dropped; }
+  
+private:
+  CaptureHeader node;
+  volatile bool requested;
+  bool active;
+  
+  uint8_t record[Config::Capture::CHUNK_SIZE];
+  size_t length;          // 0 - блок пуст
+  uint16_t sequence;
+  uint32_t lastEvent_us;
+  uint32_t chunkStart_ms;
+  
+  uint32_t bytesCaptured;
+  uint32_t sent;          // Записей (заголовки и блоки)
+  uint32_t dropped;
+  
+  void recordEvent(uint32_t time_us, bool aux, uint8_t data);
+  void flush();
+  void write(const uint8_t* frame, size_t frameLength);
+};
+
+// Глобальный экземпляр (определен в rx_capture.cpp)
+extern RxCapture rxCapture;
+
+#endif // RX_CAPTURE_H
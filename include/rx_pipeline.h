@@ -0,0 +1,92 @@
+#ifndef RX_PIPELINE_H
+#define RX_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+#include "spsc_queue.h"
+
+// ===== Dual-core RX pipeline (ESP32, -D RX_PIPELINE) =====
+// reader  (core 0, высокий приоритет): UART -> метки времени -> PacketParser,
+//         готовый кадр с метками уходит в SPSC очередь
+// process (core 1): calculateRxStats, синхронизация, TDOA (обработчик из rx_main)
+// render  (core 1, низкий приоритет): OLED с собственной частотой,
+//         показывает последний опубликованный кадр
+// Медленный I2C и Serial больше не задерживают чтение UART.
+
+#if defined(RX_PIPELINE) && !defined(PLATFORM_ESP32)
+  #error "RX_PIPELINE requires ESP32 (FreeRTOS, two cores)"
+#endif
+
+#ifdef PLATFORM_ESP32
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class RxPipeline {
+public:
+  typedef void (*FrameHandler)(const PacketData& packet, const RxFrameTiming& timing);
+  typedef void (*IdleHandler)();
+  
+  RxPipeline();
+  
+  // Запуск задач; onFrame вызывается в задаче process для каждого кадра,
+  // onIdle - там же после опустошения очереди (не реже раза в 100 мс)
+  void start(FrameHandler onFrame, IdleHandler onIdle = nullptr);
+  
+  // Из обработчика кадра: последний кадр для задачи render
+  void publishDisplay(const PacketData& packet, const RxStats& stats);
+  
+private:
+  // Кадр между reader и process
+  struct RxFrame {
+    PacketData packet;
+    RxFrameTiming timing;
+    uint32_t enqueue_us;
+  };
+  
+  // Время стадии: счетчики пишет одна задача, отчет берет разности (без сброса)
+  struct StageTiming {
+    volatile uint32_t count;
+    volatile uint32_t total_us;
+    volatile uint32_t max_us;
+    uint32_t reportedCount;
+    uint32_t reportedTotal_us;
+    
+    StageTiming() : count(0), total_us(0), max_us(0), reportedCount(0), reportedTotal_us(0) {}
+    void add(uint32_t us);
+    uint32_t windowAverage();
+  };
+  
+  SpscQueue<RxFrame, Config::Pipeline::QUEUE_DEPTH> queue;
+  FrameHandler frameHandler;
+  IdleHandler idleHandler;
+  TaskHandle_t processTask;
+  volatile uint32_t dropped;
+  
+  StageTiming readStage;     // Последний байт кадра -> в очереди
+  StageTiming queueStage;    // В очереди -> извлечен задачей process
+  StageTiming processStage;  // Обработчик кадра
+  StageTiming renderStage;   // Вывод на OLED
+  
+  // Последний кадр для render, защищен spinlock
+  portMUX_TYPE displayMux;
+  PacketData displayPacket;
+  RxStats displayStats;
+  bool displayDirty;
+  
+  static void readerTask(void* param);
+  static void processTaskEntry(void* param);
+  static void renderTask(void* param);
+  
+  void readerLoop();
+  void processLoop();
+  void renderLoop();
+  void report();
+};
+
+extern RxPipeline rxPipeline;
+
+#endif // PLATFORM_ESP32
+
+#endif // RX_PIPELINE_H
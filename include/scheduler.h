@@ -0,0 +1,84 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Cooperative Deadline Scheduler =====
+// Задачи - короткие неблокирующие функции (конечные автоматы). run() из loop()
+// выполняет просроченные задачи по порядку дедлайнов. Периодическая задача
+// получает следующий дедлайн от предыдущего, а не от момента запуска, поэтому
+// период не уплывает. Задача с периодом 0 ждет wake()/wakeIn().
+
+// Разброс интервала между событиями относительно номинального периода
+struct PeriodJitter {
+  uint32_t nominal_us;
+  uint32_t count;        // Интервалов
+  int32_t  minDev_us;    // Самый ранний (отрицательный - раньше номинала)
+  int32_t  maxDev_us;    // Самый поздний
+  uint32_t sumAbsDev_us;
+  
+  explicit PeriodJitter(uint32_t nominal = 0) { reset(nominal); }
+  
+  void reset(uint32_t nominal);
+  void mark(uint32_t now_us);           // Очередное событие
+  uint32_t avgAbsDev_us() const { return count ? sumAbsDev_us / count : 0; }
+  
+private:
+  uint32_t last_us;
+  bool hasLast;
+};
+
+class Scheduler {
+public:
+  typedef void (*TaskFn)();
+  static const uint8_t NO_TASK = 0xFF;
+  
+  struct TaskStats {
+    uint32_t runs;
+    uint32_t skipped;      // Пропущенные периоды (задача опоздала больше чем на период)
+    uint32_t maxLate_us;   // Запуск позже дедлайна
+    uint32_t maxRun_us;    // Время выполнения
+  };
+  
+  Scheduler();
+  
+  // Добавить задачу; первый запуск через phase_ms. NO_TASK - таблица полна
+  uint8_t add(const char* name, TaskFn fn, uint32_t period_ms, uint32_t phase_ms = 0);
+  
+  // Разовый запуск: как можно скорее / через delay_ms
+  void wake(uint8_t id);
+  void wakeIn(uint8_t id, uint32_t delay_ms);
+  
+  // Новый период; следующий дедлайн - от предыдущего (из самой задачи -
+  // от ее текущего дедлайна), без ухода периода
+  void setPeriod(uint8_t id, uint32_t period_ms);
+  
+  // Выполнить все просроченные задачи; вернуть мкс до ближайшего дедлайна
+  uint32_t run();
+  
+  uint8_t getTaskCount() const { return taskCount; }
+  const char* getName(uint8_t id) const { return tasks[id].name; }
+  const TaskStats& getStats(uint8_t id) const { return tasks[id].stats; }
+  
+  // Печать таблицы задач и сброс максимумов
+  void printStats(Print& out);
+  
+private:
+  struct Task {
+    const char* name;
+    TaskFn fn;
+    uint32_t period_us;
+    uint32_t deadline_us;
+    bool armed;
+    TaskStats stats;
+  };
+  
+  Task tasks[Config::Scheduler::MAX_TASKS];
+  uint8_t taskCount;
+  
+  // Просроченная задача с самым ранним дедлайном или NO_TASK
+  uint8_t nextDue(uint32_t now_us);
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,94 @@
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Sequence Gap / Loss Tracking =====
+// Поток одного передатчика: наибольший принятый SEQ и битовая карта
+// окна из 64 номеров за ним (бит i - принят SEQ top-i). O(1) на кадр:
+//   SEQ > top     - новый кадр; пропущенные номера сразу считаются потерянными
+//   SEQ в окне    - бит уже стоит: дубликат, иначе опоздавший кадр
+//                   (переставлен в пути, из потерь вычитается)
+//   далеко от top - подозрительный (искажен или тег перезапущен): не
+//                   учитывается; следующий за ним SEQ подтверждает перезапуск
+//                   (как probation в RFC 3550 A.1)
+// Потери = пропуски SEQ, еще не закрытые опоздавшими кадрами.
+
+class SequenceTracker {
+public:
+  enum Verdict : uint8_t {
+    SEQ_NEW,        // Следующий или после пропуска
+    SEQ_LATE,       // Опоздавший (закрыл пропуск)
+    SEQ_DUPLICATE,  // Уже принят - отбросить
+    SEQ_SUSPECT,    // Вне окна, не подтвержден - в счетчики не входит
+    SEQ_RESYNC      // Скачок подтвержден: поток начат заново
+  };
+  
+  static const uint8_t WINDOW = 64;
+  
+  struct Counters {
+    uint32_t received;    // Уникальных кадров
+    uint32_t lost;        // Пропущенных номеров
+    uint32_t duplicates;
+    uint32_t outOfOrder;
+    uint32_t suspect;
+    uint32_t resyncs;
+  };
+  
+  SequenceTracker() { reset(); }
+  
+  void reset();
+  Verdict track(uint32_t sequence);
+  
+  const Counters& getCounters() const { return counters; }
+  uint32_t getTop() const { return top; }
+  
+  // Доля потерь: lost / (received + lost), промилле
+  uint16_t getLossPermille() const;
+  
+private:
+  uint64_t seen;
+  uint32_t top;
+  uint32_t probationSeq;  // Ожидаемый SEQ после подозрительного
+  bool probation;
+  bool started;
+  Counters counters;
+  
+  void restart(uint32_t sequence);
+};
+
+// Таблица потоков по идентификатору отправителя. Полна - вытесняется
+// отправитель, который молчит дольше всех.
+class SequenceTable {
+public:
+  // Отправитель - ID тега (0 - кадры без ID); опорные кадры - SENDER_SYNC | ID anchor
+  static const uint16_t SENDER_SYNC = Config::Tag::MAX_ID + 1;
+  
+  SequenceTable();
+  
+  SequenceTracker::Verdict track(uint16_t sender, uint32_t sequence);
+  
+  // Поток отправителя (nullptr - нет в таблице)
+  const SequenceTracker* find(uint16_t sender) const;
+  
+  // Строка на отправителя: принято, потери, дубликаты, перестановки
+  void printReport(Print& out) const;
+  
+private:
+  struct Entry {
+    uint16_t sender;
+    bool used;
+    uint32_t lastSeen_ms;
+    SequenceTracker tracker;
+  };
+  
+  Entry entries[Config::Seq::MAX_SENDERS];
+  uint32_t evicted;
+  
+  Entry* findOrCreate(uint16_t sender);
+};
+
+extern SequenceTable sequenceTable;
+
+#endif // SEQUENCE_TRACKER_H
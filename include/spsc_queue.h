@@ -0,0 +1,61 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+
+// ===== Lock-free SPSC Queue =====
+// Один производитель и один потребитель (разные задачи/ядра), без мьютексов.
+// head пишет только производитель, tail - только потребитель; публикация
+// элемента - store-release индекса после копирования данных.
+// N - степень двойки; индексы свободно переполняются (uint32_t).
+
+template <typename T, uint16_t N>
+class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+  
+public:
+  SpscQueue() : head(0), tail(0), highWater(0) {}
+  
+  // Производитель: false - очередь полна
+  bool push(const T& item) {
+    uint32_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    if (h - t >= N) return false;
+    
+    items[h & (N - 1)] = item;
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    
+    uint16_t depth = (uint16_t)(h + 1 - t);
+    if (depth > highWater) highWater = depth;
+    return true;
+  }
+  
+  // Потребитель: false - очередь пуста
+  bool pop(T& item) {
+    uint32_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    if (h == t) return false;
+    
+    item = items[t & (N - 1)];
+    __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+  
+  uint16_t size() const {
+    return (uint16_t)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) -
+                      __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+  }
+  
+  // Максимальная заполненность с момента старта (пишет производитель)
+  uint16_t getHighWater() const { return highWater; }
+  
+  static constexpr uint16_t capacity() { return N; }
+  
+private:
+  T items[N];
+  uint32_t head;
+  uint32_t tail;
+  volatile uint16_t highWater;
+};
+
+#endif // SPSC_QUEUE_H
@@ -2,7 +2,10 @@
 #define TDOA_H
 
 #include <Arduino.h>
+#include "config.h"
 #include "packet.h"
+#include "tdoa_solver.h"
+#include "tdoa_tracker.h"
 
 // ===== TDOA (Time Difference of Arrival) Navigation =====
 // Для GPS-less навигации по LoRa
@@ -10,9 +13,12 @@
 struct Position2D {
   float x;  // Координата X (метры)
   float y;  // Координата Y (метры)
+  float residual_m;     // RMS невязка решения (метры) - для отбраковки
+  float gdop;           // Геометрический фактор точности
+  uint8_t anchorsUsed;  // Сколько anchor участвовало в решении
   bool valid;
   
-  Position2D() : x(0), y(0), valid(false) {}
+  Position2D() : x(0), y(0), residual_m(0), gdop(0), anchorsUsed(0), valid(false) {}
 };
 
 struct AnchorNode {
@@ -31,36 +37,107 @@ public:
   // Регистрация anchor узла (RX станции с известными координатами)
   void registerAnchor(uint8_t id, float x, float y);
   
-  // Обработка принятого пакета на anchor узле
+  // Обработка принятого пакета на anchor узле (этот узел - первый registerAnchor)
   void processRxPacket(const PacketData& packet, const RxStats& stats);
   
-  // Вычисление позиции на основе TDOA (минимум 3 anchor)
+  // Обработка времени приема от указанного anchor узла
+  void processRxPacket(const PacketData& packet, const RxStats& stats, uint8_t anchorId);
+  
+  // Вычисление позиции на основе TDOA (минимум 3 anchor); ключ - frameKey()
   Position2D calculatePosition(const String& euid);
+  Position2D calculatePosition(uint64_t euidKey);
+  
+  // Разовое решение последнего кадра тега (с выводом, как calculatePosition); трек не меняет
+  Position2D locateTag(uint16_t tagId);
+  
+  // Шаг трекера по последнему кадру каждого тега, когда метки anchor собраны
+  // (все anchor или пауза TRACK_SETTLE_MS); возвращает число новых позиций.
+  // Трек обновляют уже 2 anchor, начинают - 3. Без вывода - вызывается периодически.
+  uint8_t locateAll();
+  
+  // Позиция тега, для живого трека - экстраполированная на сейчас
+  // (false - тега нет или еще не решен)
+  bool getTagPosition(uint16_t tagId, Position2D& pos) const;
+  
+  // Строка на тег: кадры, давность, позиция и скорость трека
+  void printTags(Print& out) const;
   
   // Получить количество зарегистрированных anchor
   uint8_t getAnchorCount() const { return anchorCount; }
   
+  // Сколько живых (не истекших) измерений пришлось вытеснить
+  uint32_t getEvictedLive() const { return evictedLive; }
+  
 private:
-  static constexpr uint8_t MAX_ANCHORS = 8;
+  static constexpr uint8_t MAX_ANCHORS = TDOA_MAX_ANCHORS;
   AnchorNode anchors[MAX_ANCHORS];
   uint8_t anchorCount;
   
   // Хранение временных меток для TDOA расчетов
   struct TDOAMeasurement {
-    String euid;
+    uint64_t key;         // euidToKey(euid)
     uint32_t rxTimes_us[MAX_ANCHORS];
-    uint8_t rxCount;
+    uint8_t anchorIds[MAX_ANCHORS];
+    uint8_t rxCount;      // 0 - слот никогда не использовался
     uint32_t lastUpdate_ms;
   };
   
-  static constexpr uint8_t MAX_MEASUREMENTS = 10;
+  // Хеш-таблица с открытой адресацией (линейное пробирование).
+  // Истекшие по MEASUREMENT_TTL_MS записи переиспользуются при вставке.
+  static constexpr uint16_t MAX_MEASUREMENTS = Config::Tdoa::MEASUREMENT_SLOTS;
+  static_assert((MAX_MEASUREMENTS & (MAX_MEASUREMENTS - 1)) == 0,
+                "MEASUREMENT_SLOTS must be a power of two");
   TDOAMeasurement measurements[MAX_MEASUREMENTS];
+  uint32_t evictedLive;
+  
+  // Состояние по тегам: измерение последнего кадра, трек и последняя позиция.
+  // Таблица полна - вытесняется тег, который молчит дольше всех.
+  struct TagState {
+    uint16_t tagId;
+    bool used;
+    bool solved;              // lastKey уже обработан трекером
+    uint64_t lastKey;         // frameKey() последнего кадра
+    uint32_t lastSeen_ms;
+    uint32_t frames;
+    Position2D position;      // Последняя действительная позиция
+    uint32_t positionTime_ms;
+    TdoaTracker tracker;
+    uint32_t trackInits;      // Начал трека (решений solveTdoa)
+    uint32_t trackUpdates;    // Обновлений без полного решения
+  };
   
-  // Поиск/создание записи измерения по EUID
-  TDOAMeasurement* findOrCreateMeasurement(const String& euid);
+  TagState tags[Config::Tag::MAX_TAGS];
+  uint32_t evictedTags;
+  
+  TagState* findTag(uint16_t tagId);
+  const TagState* findTag(uint16_t tagId) const;
+  TagState* findOrCreateTag(uint16_t tagId);
+  
+  static uint16_t slotFor(uint64_t key);
+  bool isExpired(const TDOAMeasurement& meas, uint32_t now_ms) const;
+  
+  // Поиск записи измерения по ключу (nullptr - нет)
+  TDOAMeasurement* findMeasurement(uint64_t key);
+  
+  // Поиск/создание записи измерения по ключу
+  TDOAMeasurement* findOrCreateMeasurement(uint64_t key);
+  
+  // Поиск anchor по ID
+  const AnchorNode* findAnchor(uint8_t id) const;
+  
+  // Anchor с известными координатами и разности расстояний к первому из них
+  // в типе T (float - трекер, TdoaScalar - решатель);
+  // разность вне диапазона T (rangeDiffFromTime) - anchor пропускается;
+  // frameTime_us - метка первого. Возвращает число anchor.
+  template <typename T>
+  uint8_t collectRangeDiffs(const TDOAMeasurement& meas, T* ax, T* ay,
+                            T* rangeDiff_m, uint32_t& frameTime_us) const;
   
   // Триангуляция по TDOA
   Position2D trilaterate(const TDOAMeasurement& meas);
+  
+  // Шаг трекера тега по измерению (true - новая позиция)
+  bool trackTag(TagState& tag, const TDOAMeasurement& meas);
 };
 
 // Глобальный экземпляр (определен в tdoa.cpp)
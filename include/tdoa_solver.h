@@ -0,0 +1,68 @@
+#ifndef TDOA_SOLVER_H
+#define TDOA_SOLVER_H
+
+#include <stdint.h>
+#include "fixed_point.h"
+
+// ===== TDOA Multilateration Solver =====
+// Гиперболическая навигация по разностям расстояний до anchor узлов.
+// 1) Замкнутое начальное приближение (в духе Chan/Fang): линейная система
+//    относительно (x, y) с r0 как параметром + квадратное уравнение для r0.
+// 2) Фиксированное число шагов Gauss-Newton по исходным гиперболам.
+// Все буферы на стеке, размер задан TDOA_MAX_ANCHORS; без кучи и без Arduino,
+// чтобы собираться и на хосте (src/native/tdoa_bench.cpp).
+// Тип вычислений - параметр шаблона: float, Q16_16 или Q24_8 (fixed_point.h).
+// Для фиксированной точки координаты относительно anchor 0 масштабируются
+// степенью двойки (NumTraits::MAX_INPUT_EXP), чтобы суммы квадратов в
+// нормальных уравнениях не переполнялись.
+
+constexpr uint8_t TDOA_MAX_ANCHORS      = 8;
+constexpr uint8_t TDOA_GN_ITERATIONS    = 5;
+constexpr float SPEED_OF_LIGHT_M_PER_US = 299.792458f;  // Скорость света (м/мкс)
+
+// Тип решателя платформы: на Mega (без FPU) - Q16.16, иначе float.
+// -D TDOA_FIXED_POINT - фиксированная точка и на остальных платформах.
+#if defined(__AVR_ATmega2560__) || defined(TDOA_FIXED_POINT)
+typedef Q16_16 TdoaScalar;
+#else
+typedef float TdoaScalar;
+#endif
+
+// Скорость света в типе решателя (Q16.16: 19647259 / 2^16, ошибка 2e-8)
+template <typename T>
+constexpr T speedOfLight_m_per_us() {
+  return NumTraits<T>::fromFloat(SPEED_OF_LIGHT_M_PER_US);
+}
+
+// Разность расстояний c * dt в типе решателя; false - не представима
+// (Q16.16: |dt| > ~109 мкс, Q24.8: > ~27 мс). Насыщенная разность дала бы
+// ложное решение с valid - такой anchor в решение не берется.
+template <typename T>
+inline bool rangeDiffFromTime(int32_t dt_us, T& rangeDiff_m) {
+  rangeDiff_m = NumTraits<T>::fromInt(dt_us) * speedOfLight_m_per_us<T>();
+  return NumTraits<T>::isValid(rangeDiff_m);
+}
+
+struct TdoaSolution {
+  float x;           // Координата X (метры)
+  float y;           // Координата Y (метры)
+  float residual_m;  // RMS невязка гипербол после уточнения (метры)
+  float gdop;        // sqrt(trace((J^T J)^-1)) - геометрический фактор
+  bool valid;
+  
+  TdoaSolution() : x(0), y(0), residual_m(0), gdop(0), valid(false) {}
+};
+
+// anchorX/anchorY - координаты anchor узлов, anchor 0 - опорный.
+// rangeDiff_m[i] = c * (t_i - t_0), rangeDiff_m[0] игнорируется.
+// Нужно минимум 3 anchor не на одной прямой.
+// Инстанцирован для float, Q16_16 и Q24_8 (tdoa_solver.cpp).
+template <typename T>
+TdoaSolution solveTdoa(const T* anchorX, const T* anchorY,
+                       const T* rangeDiff_m, uint8_t count);
+
+// Входы float, решение в TdoaScalar платформы
+TdoaSolution solveTdoa(const float* anchorX, const float* anchorY,
+                       const float* rangeDiff_m, uint8_t count);
+
+#endif // TDOA_SOLVER_H
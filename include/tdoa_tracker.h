@@ -0,0 +1,76 @@
+#ifndef TDOA_TRACKER_H
+#define TDOA_TRACKER_H
+
+#include <stdint.h>
+#include "tdoa_solver.h"
+
+// ===== TDOA Position Tracker =====
+// Фильтр Калмана с моделью постоянной скорости, состояние (x, y, vx, vy).
+// Прогноз - белый шум ускорения; обновление - разности расстояний кадра
+// по одной (скалярные шаги EKF), без обращения матриц: 2+ anchor уже
+// уточняют трек, а шаг дешевле полного solveTdoa. Трек начинается (и
+// после потери начинается заново) с решения solveTdoa по 3+ anchor.
+// Шум разностей считается независимым (общий опорный anchor не учтен).
+// Матрицы фиксированного размера, без кучи и без Arduino (как tdoa_solver).
+
+constexpr float    TDOA_TRACK_ACCEL_SIGMA   = 0.5f;      // RMS ускорения тега (м/с^2)
+constexpr float    TDOA_TRACK_RANGE_SIGMA_M = 10.0f;     // RMS шума разности расстояний (м)
+constexpr float    TDOA_TRACK_INIT_SPEED    = 2.0f;      // RMS скорости нового трека (м/с)
+constexpr float    TDOA_TRACK_GATE          = 9.0f;      // Отбраковка: innovation^2 / S (3 sigma)
+constexpr uint8_t  TDOA_TRACK_MAX_MISSES    = 3;         // Кадров подряд без принятых разностей
+constexpr uint32_t TDOA_TRACK_MAX_COAST_US  = 10000000;  // Без обновлений дольше - трек потерян
+
+class TdoaTracker {
+public:
+  enum Result : uint8_t {
+    TRACK_NONE,      // Нечем обновить: одна метка, или трека нет и для начала мало anchor
+    TRACK_INIT,      // Трек начат решением solveTdoa
+    TRACK_UPDATE,    // Прогноз + принята хотя бы одна разность
+    TRACK_REJECTED   // Все разности отбракованы - остался прогноз
+  };
+  
+  TdoaTracker();
+  
+  void setNoise(float accelSigma_mps2, float rangeSigma_m);
+  void reset();
+  
+  // Кадр: anchor 0 опорный, rangeDiff_m[i] = c * (t_i - t_0), t_us - время кадра.
+  // Трек есть - прогноз до t_us и обновление (нужно 2+ anchor), иначе - начало
+  // трека (3+ anchor).
+  Result step(const float* anchorX, const float* anchorY,
+              const float* rangeDiff_m, uint8_t count, uint32_t t_us);
+  
+  // Трек жив: начат и не потерян к моменту t_us
+  bool isTracking(uint32_t t_us) const;
+  
+  // Экстраполяция позиции на t_us без изменения состояния
+  void positionAt(uint32_t t_us, float& x, float& y) const;
+  
+  float getX() const { return state[0]; }
+  float getY() const { return state[1]; }
+  float getVx() const { return state[2]; }
+  float getVy() const { return state[3]; }
+  uint32_t getTime_us() const { return time_us; }
+  
+  // sqrt(Pxx + Pyy) - ожидаемая ошибка позиции (метры)
+  float getPositionSigma() const;
+  
+  // RMS принятых разностей последнего обновления до коррекции (метры)
+  float getInnovationRms() const { return innovationRms; }
+  
+private:
+  float state[4];  // x, y, vx, vy
+  float P[4][4];   // Ковариация состояния
+  float accelVar;
+  float rangeVar;
+  float innovationRms;
+  uint32_t time_us;
+  uint8_t misses;
+  bool initialized;
+  
+  void initialize(const TdoaSolution& sol, uint32_t t_us);
+  void predict(uint32_t t_us);
+  bool updateScalar(float ax, float ay, float ax0, float ay0, float rangeDiff_m);
+};
+
+#endif // TDOA_TRACKER_H
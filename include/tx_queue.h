@@ -0,0 +1,91 @@
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "packet.h"
+#include "scheduler.h"
+
+// ===== Non-blocking TX Queue =====
+// Кадры (beacon и сообщения из консоли) ждут в очереди, пока модуль занят.
+// poll() вызывается задачей планировщика: опрашивает текущую передачу
+// (LoRaModule::pollSend) и, когда AUX HIGH, запускает следующий кадр.
+// Кадр собирается в момент запуска - поле TIME совпадает с началом передачи.
+// Пакетирование: первый кадр ждет BATCH_FLUSH_MS попутные кадры, затем все,
+// что влезает в подпакет E32, уходит одной передачей (LoRaModule::flushBatch).
+
+class TxQueue {
+public:
+  struct Entry {
+    uint32_t sequence;
+    uint32_t queued_us;
+    bool beacon;
+    uint8_t frameOffset;   // Собранный кадр в буфере передачи
+    uint8_t frameLen;
+    char message[Config::Tx::MAX_FRAME + 1];
+  };
+  
+  // Вызывается по завершении передачи (из poll())
+  typedef void (*SentHandler)(const Entry& entry, bool success);
+  
+  TxQueue();
+  
+  void setSentHandler(SentHandler handler) { sentHandler = handler; }
+  
+  // Поставить кадр в очередь; false - очередь полна
+  bool enqueue(const char* message, uint32_t sequence, bool beacon);
+  
+  // Шаг автомата передачи
+  void poll();
+  
+  uint8_t size() const { return count; }
+  bool isSending() const { return sending; }
+  
+  // Пакетирование (по умолчанию Config::Tx::BATCHING)
+  void setBatching(bool enabled) { batching = enabled; }
+  
+  // Логических кадров на секунду эфира (преамбулы делят кадры пакета)
+  float getFramesPerAirSecond() const;
+  
+  // Период beacon по фактическому началу передачи
+  const PeriodJitter& getBeaconJitter() const { return beaconJitter; }
+  
+  // Номинальный период beacon для джиттера (меняется BeaconPacer)
+  void setBeaconPeriod(uint32_t period_ms) { beaconJitter.nominal_us = period_ms * 1000UL; }
+  
+  // Оценка эфира всех передач с запуска (us)
+  uint64_t getAirtime_us() const { return airtime_us; }
+  
+  // Печать счетчиков и джиттера периода beacon
+  void printStats(Print& out);
+  
+private:
+  Entry entries[Config::Tx::QUEUE_DEPTH];
+  uint8_t head;
+  uint8_t count;
+  
+  bool sending;
+  bool batching;
+  bool deferredCurrent;  // Первый кадр очереди уже ждал AUX
+  uint8_t inFlight;      // Кадров в текущей передаче (с головы очереди)
+  uint8_t frame[Config::Tx::MAX_FRAME + 1];  // Кадры текущей передачи подряд
+  
+  DeltaEncoder deltaEncoder;  // Формат v2 (-D WIRE_FORMAT_DELTA)
+  SentHandler sentHandler;
+  PeriodJitter beaconJitter;
+  uint32_t maxWait_us;   // Постановка в очередь -> начало передачи
+  uint32_t sent;
+  uint32_t failed;
+  uint32_t dropped;      // Очередь полна
+  uint32_t deferred;     // Кадров, ждавших освобождения AUX
+  uint32_t transmissions;
+  uint64_t airtime_us;   // Оценка эфира всех передач
+  
+  size_t buildFrame(const Entry& entry, uint8_t* out, size_t room);
+  void pop();
+  void finish(bool success);
+};
+
+extern TxQueue txQueue;
+
+#endif // TX_QUEUE_H
@@ -0,0 +1,100 @@
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "crc16.h"
+#include "cobs_framing.h"
+
+// ===== Anchor -> Collector Measurement Uplink =====
+// Anchor знает только свою метку прихода кадра, все метки одного EUID
+// собираются на хосте (src/native/collector.cpp). Записи идут в USB Serial
+// в кадре синхрослова (cobs_framing.h): текстовый лог и консоль делят тот
+// же порт, коллектор берет только 0x00 + COBS, в тексте нуля не бывает.
+// Поля little-endian, CRC-16 по всей записи до него.
+//
+// Запись измерения, 22 байта (+3 кадр):
+//   [0]      UPLINK_MEASUREMENT_MAGIC
+//   [1]      ID anchor
+//   [2..9]   frameKey() кадра - ключ объединения (EUID + тег)
+//   [10..11] ID тега
+//   [12..15] начало кадра в эфире, шкала опорного anchor (us)
+//   [16..17] возраст: от начала кадра до записи (по 100 us, насыщение)
+//   [18]     флаги UPLINK_FLAG_*
+//   [19]     джиттер синхронизации часов (по 0.1 us, насыщение)
+//   [20..21] CRC-16
+//
+// Запись anchor, 12 байт - при старте и раз в Uplink::ANCHOR_INFO_MS,
+// коллектор, запущенный позже, узнает координаты:
+//   [0] UPLINK_ANCHOR_MAGIC, [1] ID, [2..5] X, [6..9] Y (float, м), [10..11] CRC-16
+
+constexpr uint8_t UPLINK_MEASUREMENT_MAGIC = 0xC1;
+constexpr uint8_t UPLINK_ANCHOR_MAGIC      = 0xC2;
+constexpr size_t  UPLINK_MEASUREMENT_SIZE  = 22;
+constexpr size_t  UPLINK_ANCHOR_SIZE       = 12;
+constexpr size_t  UPLINK_CRC_SIZE          = 2;
+constexpr size_t  UPLINK_MAX_RECORD        = UPLINK_MEASUREMENT_SIZE;
+constexpr size_t  UPLINK_MAX_FRAME         = UPLINK_MAX_RECORD + FRAME_SYNC_OVERHEAD;
+
+constexpr uint8_t UPLINK_FLAG_AUX       = 0x01;  // Метка по спаду AUX (иначе первый байт UART)
+constexpr uint8_t UPLINK_FLAG_REFERENCE = 0x02;  // Anchor - опорный, метка без пересчета
+
+struct UplinkMeasurement {
+  uint64_t key;
+  uint32_t arrival_us;    // Шкала опорного anchor
+  uint16_t tagId;
+  uint16_t age_100us;
+  uint8_t anchorId;
+  uint8_t flags;
+  uint8_t jitter_100ns;
+  
+  UplinkMeasurement() : key(0), arrival_us(0), tagId(0), age_100us(0),
+                        anchorId(0), flags(0), jitter_100ns(0) {}
+};
+
+struct UplinkAnchor {
+  uint8_t id;
+  float x;
+  float y;
+  
+  UplinkAnchor() : id(0), x(0), y(0) {}
+};
+
+// Запись в кадре синхрослова, возвращает длину (0 - не влезло)
+size_t encodeUplinkMeasurement(uint8_t* out, size_t outSize, const UplinkMeasurement& m);
+size_t encodeUplinkAnchor(uint8_t* out, size_t outSize, const UplinkAnchor& a);
+
+// Потоковый разбор записей из байт порта; байты вне кадров (лог) и записи
+// других типов (capture.h) пропускаются
+class UplinkDecoder {
+public:
+  enum Result : uint8_t {
+    UPLINK_NONE,          // Нужны еще байты
+    UPLINK_MEASUREMENT,   // Запись в measurement()
+    UPLINK_ANCHOR,        // Запись в anchor()
+    UPLINK_ERROR          // Запись uplink с неверной длиной или CRC
+  };
+  
+  UplinkDecoder() : length(0), records(0), errors(0) {}
+  
+  Result feed(uint8_t b);
+  
+  const UplinkMeasurement& measurement() const { return meas; }
+  const UplinkAnchor& anchor() const { return anchorInfo; }
+  
+  uint32_t getRecords() const { return records; }
+  uint32_t getErrors() const { return errors; }
+  
+private:
+  CobsDecoder cobs;
+  uint8_t buffer[UPLINK_MAX_RECORD];
+  uint8_t length;
+  UplinkMeasurement meas;
+  UplinkAnchor anchorInfo;
+  uint32_t records;
+  uint32_t errors;
+  
+  Result complete();
+};
+
+#endif // UPLINK_H
@@ -17,13 +17,19 @@
 #include "lora_module.h"
 #include "packet.h"
 #include "tdoa.h"
-
-// Конфигурация этого anchor узла
-static const uint8_t ANCHOR_ID = 0;    // Уникальный ID этого RX (0, 1, 2...)
-static const float ANCHOR_X = 0.0;     // Координата X (метры)
-static const float ANCHOR_Y = 0.0;     // Координата Y (метры)
+#include "clock_sync.h"
+#include "logger.h"
+#include "latency_stats.h"
+#include "sequence_tracker.h"
+#include "config_store.h"
+#include "ram_monitor.h"
+#include "anchor_uplink.h"
+#include "rx_capture.h"
 
 void setup() {
+  // Шаблон в свободной RAM - до первых глубоких вызовов
+  ramMonitor.begin();
+  
   // Инициализация LoRa модуля
   if (!loraModule.initialize()) {
     Serial.println("ERROR: Module initialization failed!");
@@ -33,84 +39,259 @@ void setup() {
     }
   }
   
+  // Фоновый вывод лога (ESP32: отдельная задача, AVR: из простоя loop)
+  logger.begin();
+  
+  // Аппаратная метка начала кадра по спаду AUX
+  loraModule.enableRxTimestamps();
+  
+  // ID и координаты anchor из NVS/EEPROM (команда "anchor") - одна прошивка на все anchor
+  ConfigStore::LoadResult stored = configStore.load();
+  const NodeConfig& node = configStore.config();
+  
   // Регистрация этого узла как anchor для TDOA
-  tdoaNavigator.registerAnchor(ANCHOR_ID, ANCHOR_X, ANCHOR_Y);
+  tdoaNavigator.registerAnchor(node.anchorId, node.anchorX, node.anchorY);
+  
+  // Общая шкала времени: опорный anchor передает SYNC, остальные подстраиваются
+  clockSync.configure(node.anchorId == Config::Sync::REFERENCE_ANCHOR_ID,
+                      node.anchorX, node.anchorY,
+                      Config::Sync::REFERENCE_X, Config::Sync::REFERENCE_Y);
   
   Serial.println();
   Serial.println("===== Arduino Mega 2560 RX MODE =====");
   Serial.println("Platform: ATmega2560 @ 16MHz");
   Serial.print("Anchor ID: ");
-  Serial.print(ANCHOR_ID);
+  Serial.print(node.anchorId);
   Serial.print(" at position (");
-  Serial.print(ANCHOR_X);
+  Serial.print(node.anchorX);
   Serial.print(", ");
-  Serial.print(ANCHOR_Y);
-  Serial.println(")");
+  Serial.print(node.anchorY);
+  Serial.print("), config: ");
+  Serial.println(ConfigStore::resultName(stored));
   Serial.println("Listening for LoRa packets...");
+  Serial.println("Commands: stats (latency percentiles, loss), tags (per-tag position track),");
+  Serial.println("          mem (RAM high-water mark), anchor [<id> <x> <y>] (show/save anchor config),");
+  Serial.println("          uplink [on|off] (binary measurement records for the host collector),");
+  Serial.println("          capture [on|off] (raw RX bytes with timestamps for host replay)");
   Serial.println();
+  
+  // Записи меток для коллектора - после текста приветствия
+  anchorUplink.begin(node.anchorId, node.anchorX, node.anchorY);
+  rxCapture.begin(node.anchorId, node.anchorX, node.anchorY);
+}
+
+// Опорный anchor: периодическая передача кадра SYNC со своей меткой времени
+static void sendSyncFrame() {
+  static uint32_t syncSequence = 0;
+  
+  if (digitalRead(Config::Pins::E32_AUX) == LOW) return;  // Модуль занят
+  
+  // TIME - ожидаемое начало эфира: остальные anchor привязывают SYNC к эфиру.
+  // Пока задержка TX не измерена по AUX, уходит пробный кадр
+  const char* message = clockSync.isTxDelayMeasured() ? SYNC_MESSAGE : SYNC_PROBE_MESSAGE;
+  uint8_t frame[BINARY_MAX_FRAME];
+  uint32_t write_us = micros();
+  uint32_t model_us = loraModule.txAirDelay_us(binaryFrameSize(getLocalTagId(), strlen(message)));
+  size_t len = encodeBinaryPacketAt(frame, sizeof(frame), message, syncSequence,
+                                    clockSync.referenceStamp(write_us, model_us));
+  syncSequence++;
+  bool success = loraModule.sendMessage(frame, len);
+  
+  uint32_t airStart_us;
+  if (success && loraModule.getSendAirStart_us(airStart_us)) clockSync.onReferenceSent(write_us, airStart_us);
+  
+  LOG_INFO(LOG_SYNC_SENT, syncSequence - 1, success);
+}
+
+// Обработка успешно разобранного пакета
+static void handlePacket(const PacketData& packet, const RxFrameTiming& timing) {
+  // Учет SEQ по отправителю (тег или опорный anchor); повтор дальше не идет
+  uint16_t sender = isSyncPacket(packet)
+                      ? (uint16_t)(SequenceTable::SENDER_SYNC | Config::Sync::REFERENCE_ANCHOR_ID)
+                      : packet.tagId;
+  SequenceTracker::Verdict verdict = sequenceTable.track(sender, packet.sequence);
+  if (verdict == SequenceTracker::SEQ_DUPLICATE) {
+    LOG_WARN(LOG_SEQ_DUPLICATE, packet.sequence, sender);
+    return;
+  }
+  if (verdict == SequenceTracker::SEQ_SUSPECT) {
+    LOG_WARN(LOG_SEQ_SUSPECT, packet.sequence, sender);
+  } else if (verdict == SequenceTracker::SEQ_RESYNC) {
+    LOG_INFO(LOG_SEQ_RESYNC, packet.sequence, sender);
+  }
+  
+  // Вычисляем статистику приема (начало кадра + поправка на airtime)
+  RxStats stats = calculateRxStats(packet, timing);
+  
+  // Опорный кадр синхронизации - только обновляет модель часов (пробный - ничего)
+  if (isSyncPacket(packet)) {
+    if (isSyncProbe(packet)) return;
+    clockSync.processReference(packet.txTime_us, stats.arrivalTime_us());
+    LOG_INFO(LOG_SYNC_SAMPLE, clockSync.getSampleCount(),
+             (int32_t)(clockSync.getSkewPpm() * 1000.0f),
+             (int32_t)(clockSync.getJitterUs() * 1000.0f));
+    return;
+  }
+  
+  // Перцентили задержки и джиттера (команда "stats")
+  rxLatencyStats.record(packet.tagId, stats);
+  
+  // Сохраняем в TDOA navigator для будущих расчетов (в шкале опорного anchor)
+  if (clockSync.isLocked()) {
+    RxStats refStats = stats;
+    refStats.rxTime_us = clockSync.toReference(stats.rxTime_us);
+    tdoaNavigator.processRxPacket(packet, refStats);
+    
+    // Метка для коллектора на хосте - решение по всем anchor
+    anchorUplink.publish(packet, refStats.arrivalTime_us(), stats, timing);
+  } else {
+    LOG_WARN(LOG_TDOA_NOT_SYNCED, packet.sequence);
+  }
+  
+  // Мигание LED при приеме
+  digitalWrite(Config::Pins::LED, HIGH);
+  delay(10);
+  digitalWrite(Config::Pins::LED, LOW);
+  
+  // Запись в лог без форматирования - печать в фоне
+  LOG_INFO(LOG_RX_FRAME, packet.sequence, stats.latency_us, stats.airtime_us);
+}
+
+// Шаг трекера тегов между кадрами, не чаще TRACK_INTERVAL_MS
+static void pollTracking() {
+  static uint32_t lastTrackMs = 0;
+  if (millis() - lastTrackMs < Config::Tdoa::TRACK_INTERVAL_MS) return;
+  lastTrackMs = millis();
+  tdoaNavigator.locateAll();
+}
+
+// "anchor" - настройки узла, "anchor <id> <x> <y>" - запись (применится после сброса)
+static void anchorCommand(const char* args) {
+  NodeConfig& node = configStore.config();
+  
+  if (*args != '\0') {
+    uint8_t id;
+    float x, y;
+    if (!ConfigStore::parseAnchor(args, id, x, y)) {
+      Serial.println("Usage: anchor <id 0..255> <x_m> <y_m>");
+      return;
+    }
+    node.anchorId = id;
+    node.anchorX = x;
+    node.anchorY = y;
+    if (!configStore.save()) {
+      Serial.println("ERROR: config save failed");
+      return;
+    }
+    Serial.println("Anchor config saved, reset to apply");
+  }
+  
+  Serial.print("Anchor config: id ");
+  Serial.print(node.anchorId);
+  Serial.print(" at (");
+  Serial.print(node.anchorX);
+  Serial.print(", ");
+  Serial.print(node.anchorY);
+  Serial.println(")");
+}
+
+// "uplink" - состояние, "uplink on|off" - записи для коллектора в USB Serial
+static void uplinkCommand(const char* args) {
+  if (strcmp(args, " on") == 0) {
+    anchorUplink.setEnabled(true);
+  } else if (strcmp(args, " off") == 0) {
+    anchorUplink.setEnabled(false);
+  } else if (*args != '\0') {
+    Serial.println("Usage: uplink [on|off]");
+    return;
+  }
+  anchorUplink.printReport(Serial);
+}
+
+// "capture" - состояние, "capture on|off" - запись сырого приема для replay на хосте
+static void captureCommand(const char* args) {
+  if (strcmp(args, " on") == 0) {
+    rxCapture.setEnabled(true);
+  } else if (strcmp(args, " off") == 0) {
+    rxCapture.setEnabled(false);
+  } else if (*args != '\0') {
+    Serial.println("Usage: capture [on|off]");
+    return;
+  }
+  rxCapture.printReport(Serial);
+}
+
+// Команды из Serial Monitor: строка без ожидания, между кадрами
+static void pollConsole() {
+  static char line[32];  // "anchor <id> <x> <y>" - самая длинная, длиннее - обрезаются
+  static uint8_t len = 0;
+  
+  while (Serial.available() > 0) {
+    char ch = (char)Serial.read();
+    
+    if (ch != '\r' && ch != '\n') {
+      if (len < sizeof(line) - 1) line[len++] = ch;
+      continue;
+    }
+    if (len == 0) continue;
+    line[len] = '\0';
+    len = 0;
+    
+    if (strcmp(line, "stats") == 0) {
+      rxLatencyStats.printReport(Serial);
+      sequenceTable.printReport(Serial);
+    } else if (strncmp(line, "anchor", 6) == 0 && (line[6] == '\0' || line[6] == ' ')) {
+      anchorCommand(line + 6);
+    } else if (strncmp(line, "uplink", 6) == 0 && (line[6] == '\0' || line[6] == ' ')) {
+      uplinkCommand(line + 6);
+    } else if (strncmp(line, "capture", 7) == 0 && (line[7] == '\0' || line[7] == ' ')) {
+      captureCommand(line + 7);
+    } else if (strcmp(line, "mem") == 0) {
+      ramMonitor.printReport(Serial);
+    } else if (strcmp(line, "tags") == 0) {
+      tdoaNavigator.printTags(Serial);
+    } else {
+      Serial.println("Commands: stats, tags, mem, anchor [<id> <x> <y>], uplink [on|off], capture [on|off]");
+    }
+  }
 }
 
 void loop() {
-  static String rxBuffer;
+  static PacketParser rxParser;
+  static uint32_t lastSyncMs = 0;
+  
+  // Опорный anchor: кадры синхронизации
+  if (clockSync.isReference() && millis() - lastSyncMs >= Config::Sync::BEACON_INTERVAL_MS) {
+    lastSyncMs = millis();
+    sendSyncFrame();
+  }
   
   // Читаем UART побайтово для точного захвата времени
   while (loraModule.available() > 0) {
-    uint32_t rxTime_us = micros();  // Захватываем время приема максимально точно
-    char c = loraModule.read();
+    char c = loraModule.read();  // LoRaModule ставит метку времени на байт
     
-    if (c == '\n' || c == '\r') {
-      if (rxBuffer.length() > 0) {
-        // Парсим пакет
-        PacketData packet = parsePacket(rxBuffer);
-        
-        if (packet.valid) {
-          // Вычисляем статистику приема
-          RxStats stats = calculateRxStats(packet, rxTime_us);
-          
-          // Сохраняем в TDOA navigator для будущих расчетов
-          tdoaNavigator.processRxPacket(packet, stats);
-          
-          // Мигание LED при приеме
-          digitalWrite(Config::Pins::LED, HIGH);
-          delay(10);
-          digitalWrite(Config::Pins::LED, LOW);
-          
-          // Выводим информацию с точными временами
-          Serial.print("[");
-          Serial.print(rxTime_us);
-          Serial.print("us] EUID:");
-          Serial.print(packet.euid);
-          Serial.print(" | SEQ:");
-          Serial.print(packet.sequence);
-          Serial.print(" | MSG:");
-          Serial.print(packet.message);
-          Serial.print(" | TX:");
-          Serial.print(packet.txTime_us);
-          Serial.print("us | LAT:");
-          Serial.print(stats.latency_us);
-          Serial.print("us | RSSI:");
-          Serial.print(stats.rssi);
-          Serial.print("dBm | SNR:");
-          Serial.print(stats.snr);
-          Serial.println("dB");
-        } else {
-          // Неизвестный формат
-          Serial.print("[");
-          Serial.print(rxTime_us);
-          Serial.print("us] RAW< ");
-          Serial.println(rxBuffer);
-        }
-        
-        rxBuffer = "";
-      }
-    } else {
-      rxBuffer += c;
-      
-      // Защита от переполнения (Mega имеет меньше RAM)
-      if (rxBuffer.length() > Config::Protocol::MAX_MESSAGE_LENGTH) {
-        Serial.println("Buffer overflow!");
-        rxBuffer = "";
-      }
+    // Кадр завершается прямо на терминаторе (текст) или последнем байте (бинарь)
+    PacketParser::Result result = rxParser.feed((uint8_t)c);
+    
+    if (result == PacketParser::FRAME_OK) {
+      handlePacket(rxParser.packet(), loraModule.takeFrameTiming(rxParser));
+    } else if (result == PacketParser::FRAME_ERROR) {
+      // Неизвестный формат или переполнение
+      RxFrameTiming timing = loraModule.takeFrameTiming(rxParser);
+      if (rxParser.lastErrorCrc()) rxLatencyStats.recordCrcReject();
+      LOG_WARN(LOG_RX_MALFORMED, timing.firstByte_us, timing.byteCount);
+    } else if (!rxParser.inFrame()) {
+      // Разделитель между кадрами (\r\n) - не начало нового кадра
+      loraModule.resetFrameTiming();
     }
   }
+  
+  // Простой между байтами: печать лога, если не заблокирует USB Serial
+  if (!rxParser.inFrame()) {
+    pollTracking();
+    pollConsole();
+    anchorUplink.poll();
+    rxCapture.poll();
+    logger.poll();
+  }
 }
@@ -16,10 +16,185 @@
 #include "config.h"
 #include "lora_module.h"
 #include "packet.h"
+#include "scheduler.h"
+#include "tx_queue.h"
+#include "config_store.h"
+#include "beacon_pacer.h"
+#include "ram_monitor.h"
 
 static uint32_t sequenceNumber = 0;
+static Scheduler scheduler;
+static uint8_t ledTaskId = Scheduler::NO_TASK;
+static uint8_t beaconTaskId = Scheduler::NO_TASK;
+
+// ===== Задачи планировщика (короткие, без ожиданий) =====
+
+// Слот beacon: кадр в очередь, уйдет, как только AUX освободится.
+// Следующий слот - через интервал пейсинга с разбросом (от дедлайна)
+static void beaconTask() {
+  scheduler.setPeriod(beaconTaskId, beaconPacer.nextInterval_ms());
+  txQueue.setBeaconPeriod(beaconPacer.getInterval_ms());
+  
+  if (!txQueue.enqueue("BEACON", sequenceNumber, true)) {
+    Serial.println("WARNING: TX queue full, beacon dropped");
+    return;
+  }
+  sequenceNumber++;
+}
+
+// Опрос передачи и запуск следующего кадра
+static void txTask() {
+  txQueue.poll();
+}
+
+// Конец вспышки LED (разовая задача)
+static void ledOffTask() {
+  digitalWrite(Config::Pins::LED, LOW);
+}
+
+// ID тега: из ConfigStore, если задан командой "/tag <n>", иначе Config::Tag::ID
+static void loadTagId() {
+  configStore.load();
+  setLocalTagId(configStore.config().tagId);
+}
+
+static void storeTagId(const char* arg) {
+  char* end;
+  long id = strtol(arg, &end, 10);
+  if (end == arg || *end != '\0' || id < 0 || id > Config::Tag::MAX_ID) {
+    Serial.print("ERROR: tag id must be 0..");
+    Serial.println(Config::Tag::MAX_ID);
+    return;
+  }
+  
+  configStore.config().tagId = (uint16_t)id;
+  if (!configStore.save()) {
+    Serial.println("ERROR: config save failed");
+    return;
+  }
+  
+  setLocalTagId((uint16_t)id);
+  Serial.print("Tag ID set to ");
+  Serial.print(id);
+  Serial.println(" (saved to EEPROM)");
+}
+
+// Сообщения из Serial Monitor: байты без ожидания, строка - в очередь
+// ("/tag <n>" - команда, в эфир не уходит)
+static void consoleTask() {
+  static char line[Config::Protocol::MAX_SERIAL_INPUT + 1];  // Без String: буфер на все время
+  static size_t len = 0;
+  
+  while (Serial.available() > 0) {
+    char ch = (char)Serial.read();
+    
+    if (ch != '\r' && ch != '\n') {
+      if (len < sizeof(line) - 1) line[len++] = ch;
+      continue;
+    }
+    if (len == 0) continue;
+    line[len] = '\0';
+    len = 0;
+    
+    if (strncmp(line, "/tag ", 5) == 0) {
+      storeTagId(line + 5);
+    } else if (txQueue.enqueue(line, sequenceNumber, false)) {
+      sequenceNumber++;
+    } else {
+      Serial.println("WARNING: TX queue full, message dropped");
+    }
+  }
+}
+
+// Периодический отчет: джиттер периода beacon и задачи планировщика
+static void statusTask() {
+  txQueue.printStats(Serial);
+  beaconPacer.sampleAirtime(txQueue.getAirtime_us());
+  beaconPacer.printReport(Serial);
+  scheduler.printStats(Serial);
+  ramMonitor.printReport(Serial);
+}
+
+// Кадр ушел в эфир: вспышка LED, гасит разовая задача, без delay()
+static void onFrameSent(const TxQueue::Entry& entry, bool success) {
+  if (!success) return;
+  // Эфир передачи с beacon уточняет интервал пейсинга
+  if (entry.beacon) beaconPacer.onBeaconSent(estimateAirtime_us(loraModule.getLastSendBytes()));
+  digitalWrite(Config::Pins::LED, HIGH);
+  scheduler.wakeIn(ledTaskId, Config::Tx::LED_PULSE_MS);
+}
+
+// Сравнение размера и времени в эфире для текстового (только прием) и
+// бинарного кадра; возвращает размер beacon в формате передачи (для пейсинга)
+static size_t printWireFormatInfo() {
+  uint8_t textSample[TEXT_MAX_FRAME];
+  size_t textLen = buildPacket(textSample, sizeof(textSample), "BEACON", 0);
+  size_t binLen = binaryFrameSize(getLocalTagId(), strlen("BEACON"));
+  
+  Serial.print("Wire format: ");
+  Serial.println(Config::Protocol::DELTA_WIRE_FORMAT ? "BINARY v2 (delta)" :
+                 getLocalTagId() ? "BINARY v3 (tagged)" : "BINARY v1");
+  Serial.print("  Tag ID: ");
+  if (getLocalTagId()) Serial.println(getLocalTagId()); else Serial.println("none (single-tag frames)");
+  Serial.print("  Frame CRC: ");
+  Serial.println(Config::Protocol::FRAME_CRC ? "CRC-16/CCITT" : "off");
+  Serial.print("  Framing: ");
+  Serial.println(Config::Protocol::COBS_FRAMING ? "sync + length (COBS), +3 B" : "raw");
+  Serial.print("  BEACON frame: text (RX only) ");
+  Serial.print(textLen);
+  Serial.print(" B (~");
+  Serial.print(estimateAirtime_us(textLen) / 1000);
+  Serial.print(" ms), binary ");
+  Serial.print(binLen);
+  Serial.print(" B (~");
+  Serial.print(estimateAirtime_us(binLen) / 1000);
+  Serial.print(" ms) @ ");
+  Serial.print(Config::Protocol::AIR_DATA_RATE);
+  Serial.println(" bps");
+  
+  // v2: ключевой кадр и самая длинная дельта (последний beacon перед ключевым)
+  const int32_t span = Config::Protocol::DELTA_KEYFRAME_INTERVAL - 1;
+  size_t keyLen = deltaFrameSize(getLocalTagId(), "BEACON", true, 0, 0, 0);
+  size_t deltaLen = deltaFrameSize(getLocalTagId(), "BEACON", false, span, span * Config::Timing::PING_INTERVAL * 1000L, span);
+  Serial.print("  delta v2: key ");
+  Serial.print(keyLen);
+  Serial.print(" B, delta <= ");
+  Serial.print(deltaLen);
+  Serial.print(" B (~");
+  Serial.print(estimateAirtime_us(deltaLen) / 1000);
+  Serial.print(" ms), keyframe every ");
+  Serial.println(Config::Protocol::DELTA_KEYFRAME_INTERVAL);
+  
+  // v2: средний кадр на цикл ключевого кадра - оценка сверху по длинной дельте
+  if (Config::Protocol::DELTA_WIRE_FORMAT) {
+    return (keyLen + span * deltaLen) / Config::Protocol::DELTA_KEYFRAME_INTERVAL + FRAMING_OVERHEAD;
+  }
+  return binLen + FRAMING_OVERHEAD;
+}
+
+// Интервал beacon по бюджетам эфира и коллизий (или фиксированный)
+static void printPacingInfo() {
+  Serial.print("Beacon interval: ");
+  Serial.print(beaconPacer.getInterval_ms());
+  if (!Config::Pacing::ENABLED) {
+    Serial.println(" ms (fixed)");
+    return;
+  }
+  Serial.print(" ms +-");
+  Serial.print(Config::Pacing::JITTER_PERCENT);
+  Serial.print("% (duty ");
+  Serial.print(Config::Pacing::DUTY_CYCLE_PERMILLE / 10.0f, 1);
+  Serial.print("%, collision ");
+  Serial.print(Config::Pacing::COLLISION_PERMILLE / 10.0f, 1);
+  Serial.print("%, ");
+  Serial.print(Config::Pacing::CHANNEL_SENDERS);
+  Serial.println(" sender(s))");
+}
 
 void setup() {
+  // Шаблон в свободной RAM - до первых глубоких вызовов
+  ramMonitor.begin();
+  
   // Инициализация LoRa модуля
   if (!loraModule.initialize()) {
     Serial.println("ERROR: Module initialization failed!");
@@ -29,98 +204,29 @@ void setup() {
     }
   }
   
+  // ID тега из EEPROM (команда "/tag <n>") - одна прошивка на все теги
+  loadTagId();
+  
   Serial.println();
   Serial.println("===== Arduino Mega 2560 TX MODE =====");
   Serial.println("Platform: ATmega2560 @ 16MHz");
   Serial.println("Sending TDOA beacon packets");
   Serial.println("Type text in Serial Monitor to send custom messages.");
+  Serial.println("Command: /tag <n> - set tag ID, 0 - none (stored in EEPROM)");
+  beaconPacer.begin(printWireFormatInfo());
+  printPacingInfo();
   Serial.println();
+  
+  // Задачи: beacon по дедлайнам без накопления ухода периода,
+  // передача и все остальное - неблокирующие автоматы
+  txQueue.setSentHandler(onFrameSent);
+  beaconTaskId = scheduler.add("beacon", beaconTask, beaconPacer.getInterval_ms());
+  scheduler.add("tx", txTask, Config::Tx::SEND_POLL_MS);
+  ledTaskId = scheduler.add("led", ledOffTask, 0);
+  scheduler.add("console", consoleTask, Config::Tx::CONSOLE_PERIOD_MS);
+  scheduler.add("status", statusTask, Config::Tx::STATUS_PERIOD_MS, Config::Tx::STATUS_PERIOD_MS);
 }
 
 void loop() {
-  // 1) Автоматическая отправка beacon пакетов
-  static uint32_t lastSendMs = 0;
-  
-  const uint32_t now = millis();
-  if (now - lastSendMs >= Config::Timing::PING_INTERVAL) {
-    lastSendMs = now;
-    
-    // Проверка готовности модуля перед отправкой
-    if (digitalRead(Config::Pins::E32_AUX) == LOW) {
-      Serial.println("WARNING: Module not ready (AUX=LOW), skipping send");
-      return;
-    }
-    
-    // Формируем пакет с EUID и временной меткой
-    String packet = buildPacket("BEACON", sequenceNumber++);
-    packet += "\n";  // Add newline terminator for RX parsing
-    uint32_t txTime = micros();
-    bool success = loraModule.sendMessage(packet);
-    uint32_t txDuration = micros() - txTime;
-    
-    Serial.print("TX> [");
-    Serial.print(txTime);
-    Serial.print("us] ");
-    Serial.print(packet);
-    
-    if (success) {
-      Serial.print(" [OK] (");
-      Serial.print(txDuration);
-      Serial.println("us)");
-      
-      // Мигание LED при успешной отправке
-      digitalWrite(Config::Pins::LED, HIGH);
-      delay(50);
-      digitalWrite(Config::Pins::LED, LOW);
-    } else {
-      Serial.println(" [FAIL - Module error!]");
-    }
-  }
-  
-  // 2) Отправка пользовательских сообщений из Serial Monitor
-  static String inputBuffer;
-  while (Serial.available() > 0) {
-    char ch = (char)Serial.read();
-    
-    if (ch == '\r' || ch == '\n') {
-      if (inputBuffer.length() > 0) {
-        // Проверка готовности модуля перед отправкой
-        if (digitalRead(Config::Pins::E32_AUX) == LOW) {
-          Serial.println("WARNING: Module not ready (AUX=LOW), skipping send");
-          inputBuffer = "";
-          continue;
-        }
-        
-        String packet = buildPacket(inputBuffer, sequenceNumber++);
-        packet += "\n";  // Add newline terminator for RX parsing
-        uint32_t txTime = micros();
-        bool success = loraModule.sendMessage(packet);
-        uint32_t txDuration = micros() - txTime;
-        
-        Serial.print("TX> [");
-        Serial.print(txTime);
-        Serial.print("us] ");
-        Serial.print(packet);
-        
-        if (success) {
-          Serial.print(" [OK] (");
-          Serial.print(txDuration);
-          Serial.println("us)");
-          
-          // Мигание LED при успешной отправке
-          digitalWrite(Config::Pins::LED, HIGH);
-          delay(50);
-          digitalWrite(Config::Pins::LED, LOW);
-        } else {
-          Serial.println(" [FAIL - Module error!]");
-        }
-        
-        inputBuffer = "";
-      }
-    } else {
-      if (inputBuffer.length() < Config::Protocol::MAX_SERIAL_INPUT) {
-        inputBuffer += ch;
-      }
-    }
-  }
+  scheduler.run();
 }
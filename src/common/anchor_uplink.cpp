@@ -0,0 +1,72 @@
+#include "anchor_uplink.h"
+#include "clock_sync.h"
+
+AnchorUplink anchorUplink;
+
+AnchorUplink::AnchorUplink()
+  : enabled(false), lastAnchorInfo_ms(0), sent(0), dropped(0) {}
+
+void AnchorUplink::begin(uint8_t anchorId, float anchorX, float anchorY) {
+  node.id = anchorId;
+  node.x = anchorX;
+  node.y = anchorY;
+  setEnabled(Config::Uplink::ENABLED);
+}
+
+void AnchorUplink::setEnabled(bool on) {
+  enabled = on;
+  if (enabled) sendAnchorInfo();  // Коллектор сразу получает координаты
+}
+
+void AnchorUplink::publish(const PacketData& packet, uint32_t refArrival_us,
+                           const RxStats& stats, const RxFrameTiming& timing) {
+  if (!enabled) return;
+  
+  UplinkMeasurement m;
+  m.key = frameKey(packet);
+  m.arrival_us = refArrival_us;
+  m.tagId = packet.tagId;
+  m.anchorId = node.id;
+  
+  uint32_t age = (micros() - stats.arrivalTime_us()) / 100;
+  m.age_100us = age > 0xFFFF ? 0xFFFF : (uint16_t)age;
+  
+  m.flags = (timing.auxValid ? UPLINK_FLAG_AUX : 0) |
+            (clockSync.isReference() ? UPLINK_FLAG_REFERENCE : 0);
+  float jitter = clockSync.getJitterUs() * 10.0f;
+  m.jitter_100ns = jitter >= 255.0f ? 255 : (uint8_t)jitter;
+  
+  uint8_t frame[UPLINK_MAX_FRAME];
+  write(frame, encodeUplinkMeasurement(frame, sizeof(frame), m));
+}
+
+void AnchorUplink::poll() {
+  if (enabled && millis() - lastAnchorInfo_ms >= Config::Uplink::ANCHOR_INFO_MS) sendAnchorInfo();
+}
+
+void AnchorUplink::sendAnchorInfo() {
+  lastAnchorInfo_ms = millis();
+  uint8_t frame[UPLINK_MAX_FRAME];
+  write(frame, encodeUplinkAnchor(frame, sizeof(frame), node));
+}
+
+void AnchorUplink::write(const uint8_t* frame, size_t length) {
+  if (length == 0) return;
+  if (Serial.availableForWrite() < (int)length) {
+    dropped++;
+    return;
+  }
+  Serial.write(frame, length);
+  sent++;
+}
+
+void AnchorUplink::printReport(Print& out) const {
+  out.print("Uplink: ");
+  out.print(enabled ? "on" : "off");
+  out.print(", anchor ");
+  out.print(node.id);
+  out.print(", records sent ");
+  out.print(sent);
+  out.print(", dropped (USB TX full) ");
+  out.println(dropped);
+}
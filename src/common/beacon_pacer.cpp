@@ -0,0 +1,78 @@
+#include "beacon_pacer.h"
+#include <math.h>
+
+BeaconPacer beaconPacer;
+
+static_assert(Config::Pacing::COLLISION_PERMILLE > 0 && Config::Pacing::COLLISION_PERMILLE <= 500,
+              "negLog1m series converges for p <= 0.5");
+static_assert(Config::Pacing::DUTY_CYCLE_PERMILLE > 0 && Config::Pacing::DUTY_CYCLE_PERMILLE <= 1000,
+              "duty cycle is a fraction of airtime");
+
+// Бюджеты выполнимы даже для кадра максимальной длины (два подпакета E32)
+static_assert(requiredInterval_ms(estimateAirtime_us(Config::Tx::MAX_FRAME)) <= Config::Pacing::MAX_INTERVAL_MS,
+              "pacing budgets need a longer MAX_INTERVAL_MS for full-size frames");
+
+BeaconPacer::BeaconPacer()
+  : beaconAirtime_us(0), interval_ms(Config::Timing::PING_INTERVAL), rngState(1),
+    windowAirtime_us(0), windowStart_ms(0), windowLength_ms(0),
+    utilizationPermille(0), windowStarted(false) {
+}
+
+void BeaconPacer::begin(size_t beaconFrameBytes) {
+  beaconAirtime_us = estimateAirtime_us(beaconFrameBytes);
+  interval_ms = Config::Pacing::ENABLED ? pacedInterval_ms(beaconAirtime_us) : Config::Timing::PING_INTERVAL;
+  rngState = micros() | 1;
+}
+
+void BeaconPacer::onBeaconSent(uint32_t airtime_us) {
+  // Дельта-кадры v2 чередуются с ключевыми - среднее сглаживает разницу
+  beaconAirtime_us = beaconAirtime_us - beaconAirtime_us / 8 + airtime_us / 8;
+  if (Config::Pacing::ENABLED) interval_ms = pacedInterval_ms(beaconAirtime_us);
+}
+
+uint32_t BeaconPacer::nextInterval_ms() {
+  if (!Config::Pacing::ENABLED || Config::Pacing::JITTER_PERCENT == 0) return interval_ms;
+
+  // xorshift32: равномерно в [-spread, +spread]
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  uint32_t spread = interval_ms * Config::Pacing::JITTER_PERCENT / 100;
+  return interval_ms - spread + rngState % (2 * spread + 1);
+}
+
+void BeaconPacer::sampleAirtime(uint64_t totalAirtime_us) {
+  uint32_t now = millis();
+
+  if (windowStarted && now != windowStart_ms) {
+    windowLength_ms = now - windowStart_ms;
+    // мкс эфира на мс окна = промилле
+    utilizationPermille = (uint16_t)((totalAirtime_us - windowAirtime_us) / windowLength_ms);
+  }
+  windowAirtime_us = totalAirtime_us;
+  windowStart_ms = now;
+  windowStarted = true;
+}
+
+void BeaconPacer::printReport(Print& out) const {
+  // Вероятность коллизии при такой же загрузке от каждого из N передатчиков
+  float collision = 1.0f - expf(-2.0f * Config::Pacing::CHANNEL_SENDERS * utilizationPermille / 1000.0f);
+
+  out.print("  pacing: interval=");
+  out.print(interval_ms);
+  out.print("ms +-");
+  out.print(Config::Pacing::JITTER_PERCENT);
+  out.print("% beacon_air=");
+  out.print(beaconAirtime_us / 1000.0f, 1);
+  out.print("ms util=");
+  out.print(utilizationPermille / 10.0f, 1);
+  out.print("% (budget ");
+  out.print(Config::Pacing::DUTY_CYCLE_PERMILLE / 10.0f, 1);
+  out.print("%) p_coll=");
+  out.print(collision * 100.0f, 1);
+  out.print("% (budget ");
+  out.print(Config::Pacing::COLLISION_PERMILLE / 10.0f, 1);
+  out.print("%) over ");
+  out.print(windowLength_ms);
+  out.println("ms");
+}
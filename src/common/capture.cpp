@@ -0,0 +1,168 @@
+#include "capture.h"
+
+static void putU16(uint8_t* dst, uint16_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t* dst, uint32_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+  dst[2] = (uint8_t)(v >> 16);
+  dst[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t getU16(const uint8_t* src) {
+  return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* src) {
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+         ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void putFloat(uint8_t* dst, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  putU32(dst, bits);
+}
+
+static float getFloat(const uint8_t* src) {
+  uint32_t bits = getU32(src);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// CRC в хвост записи и кадр синхрослова
+static size_t frameRecord(uint8_t* out, size_t outSize, uint8_t* record, size_t length) {
+  putU16(record + length - CAPTURE_CRC_SIZE, crc16(record, length - CAPTURE_CRC_SIZE));
+  return encodeSyncFrame(out, outSize, record, length);
+}
+
+uint8_t captureBuildFlags() {
+  return (Config::Protocol::COBS_FRAMING ? CAPTURE_FLAG_COBS : 0) |
+         (Config::Protocol::REQUIRE_CRC ? CAPTURE_FLAG_CRC : 0) |
+         CAPTURE_FLAG_BINARY |
+         (Config::Protocol::DELTA_WIRE_FORMAT ? CAPTURE_FLAG_DELTA : 0);
+}
+
+size_t encodeCaptureHeader(uint8_t* out, size_t outSize, const CaptureHeader& header) {
+  uint8_t record[CAPTURE_HEADER_SIZE];
+  record[0] = CAPTURE_HEADER_MAGIC;
+  record[1] = header.anchorId;
+  record[2] = header.version;
+  record[3] = header.flags;
+  putFloat(record + 4, header.x);
+  putFloat(record + 8, header.y);
+  putU32(record + 12, header.loraBaud);
+  putU32(record + 16, header.start_us);
+  return frameRecord(out, outSize, record, sizeof(record));
+}
+
+size_t beginCaptureChunk(uint8_t* record, uint8_t anchorId, uint16_t sequence, uint32_t base_us) {
+  record[0] = CAPTURE_CHUNK_MAGIC;
+  record[1] = anchorId;
+  putU16(record + 2, sequence);
+  putU32(record + 4, base_us);
+  return CAPTURE_CHUNK_PREFIX;
+}
+
+size_t putCaptureEvent(uint8_t* dst, uint32_t dt_us, bool aux, uint8_t data) {
+  // dt << 1 | aux - до 33 бит, по 7 бит на байт, старший бит - продолжение
+  uint64_t v = ((uint64_t)dt_us << 1) | (aux ? 1 : 0);
+  size_t n = 0;
+  while (v >= 0x80) {
+    dst[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  dst[n++] = (uint8_t)v;
+  if (!aux) dst[n++] = data;
+  return n;
+}
+
+size_t encodeCaptureChunk(uint8_t* out, size_t outSize, uint8_t* record, size_t length) {
+  return frameRecord(out, outSize, record, length + CAPTURE_CRC_SIZE);
+}
+
+CaptureDecoder::Result CaptureDecoder::feed(uint8_t b) {
+  if (b == FRAME_SYNC) {
+    // Новый кадр; незаконченный предыдущий - потерянные байты
+    bool partial = cobs.isActive() && cobs.hasLength();
+    cobs.start();
+    length = 0;
+    if (!partial) return CAPTURE_NONE;
+    errors++;
+    return CAPTURE_ERROR;
+  }
+  if (!cobs.isActive()) return CAPTURE_NONE;  // Текст лога между записями
+  
+  uint8_t value;
+  CobsDecoder::Result r = cobs.decode(b, value);
+  if (r == CobsDecoder::COBS_NONE) return CAPTURE_NONE;
+  if (r == CobsDecoder::COBS_ERROR) {
+    errors++;
+    return CAPTURE_ERROR;
+  }
+  
+  buffer[length++] = value;
+  return cobs.isActive() ? CAPTURE_NONE : complete();
+}
+
+CaptureDecoder::Result CaptureDecoder::complete() {
+  // Записи uplink.h и другие - не наши
+  if (buffer[0] != CAPTURE_HEADER_MAGIC && buffer[0] != CAPTURE_CHUNK_MAGIC) return CAPTURE_NONE;
+  
+  bool sizeOk = buffer[0] == CAPTURE_HEADER_MAGIC
+                  ? length == CAPTURE_HEADER_SIZE
+                  : length >= CAPTURE_CHUNK_PREFIX + CAPTURE_CRC_SIZE;
+  if (!sizeOk || crc16(buffer, length - CAPTURE_CRC_SIZE) != getU16(buffer + length - CAPTURE_CRC_SIZE)) {
+    errors++;
+    return CAPTURE_ERROR;
+  }
+  records++;
+  
+  if (buffer[0] == CAPTURE_HEADER_MAGIC) {
+    headerInfo.anchorId = buffer[1];
+    headerInfo.version = buffer[2];
+    headerInfo.flags = buffer[3];
+    headerInfo.x = getFloat(buffer + 4);
+    headerInfo.y = getFloat(buffer + 8);
+    headerInfo.loraBaud = getU32(buffer + 12);
+    headerInfo.start_us = getU32(buffer + 16);
+    return CAPTURE_HEADER;
+  }
+  
+  eventPos = CAPTURE_CHUNK_PREFIX;
+  eventTime_us = getU32(buffer + 4);
+  return CAPTURE_CHUNK;
+}
+
+uint16_t CaptureDecoder::chunkSequence() const {
+  return getU16(buffer + 2);
+}
+
+bool CaptureDecoder::nextEvent(CaptureEvent& event) {
+  if (length < CAPTURE_CHUNK_PREFIX + CAPTURE_CRC_SIZE || buffer[0] != CAPTURE_CHUNK_MAGIC) return false;
+  size_t end = length - CAPTURE_CRC_SIZE;
+  
+  uint64_t v = 0;
+  uint8_t shift = 0;
+  for (;;) {
+    if (eventPos >= end || shift > 35) return false;  // Обрыв varint - конец блока
+    uint8_t b = buffer[eventPos++];
+    v |= (uint64_t)(b & 0x7F) << shift;
+    shift += 7;
+    if (!(b & 0x80)) break;
+  }
+  
+  event.aux = (v & 1) != 0;
+  eventTime_us += (uint32_t)(v >> 1);
+  event.time_us = eventTime_us;
+  event.data = 0;
+  if (!event.aux) {
+    if (eventPos >= end) return false;
+    event.data = buffer[eventPos++];
+  }
+  return true;
+}
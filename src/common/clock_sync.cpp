@@ -0,0 +1,130 @@
+#include "clock_sync.h"
+#include "tdoa_solver.h"
+
+ClockSync clockSync;
+
+bool isSyncPacket(const PacketData& packet) {
+  return packet.valid && (strcmp(packet.message, SYNC_MESSAGE) == 0 || isSyncProbe(packet));
+}
+
+bool isSyncProbe(const PacketData& packet) {
+  return packet.valid && strcmp(packet.message, SYNC_PROBE_MESSAGE) == 0;
+}
+
+ClockSync::ClockSync()
+  : head(0), count(0), consecutiveRejects(0), reference(false),
+    propagation_us(0), rejected(0), lastSample_ms(0), txDelay_us(0),
+    baseLocal_us(0), baseOffset_us(0), intercept(0), slope(0), jitter_us(0) {
+}
+
+void ClockSync::configure(bool isReference, float anchorX, float anchorY, float refX, float refY) {
+  reference = isReference;
+  
+  float dx = anchorX - refX;
+  float dy = anchorY - refY;
+  propagation_us = (uint32_t)(sqrtf(dx * dx + dy * dy) / SPEED_OF_LIGHT_M_PER_US + 0.5f);
+  
+  Serial.print("SYNC: ");
+  if (reference) {
+    Serial.println("this anchor is the time reference");
+  } else {
+    Serial.print("following reference anchor #");
+    Serial.print(Config::Sync::REFERENCE_ANCHOR_ID);
+    Serial.print(", propagation ");
+    Serial.print(propagation_us);
+    Serial.println("us");
+  }
+}
+
+int32_t ClockSync::predictOffset(uint32_t local_us) const {
+  float dt = (float)(int32_t)(local_us - baseLocal_us);
+  float correction = intercept + slope * dt;
+  return baseOffset_us + (int32_t)(correction >= 0 ? correction + 0.5f : correction - 0.5f);
+}
+
+uint32_t ClockSync::referenceStamp(uint32_t write_us, uint32_t model_us) const {
+  return write_us + (txDelay_us ? txDelay_us : model_us);
+}
+
+void ClockSync::onReferenceSent(uint32_t write_us, uint32_t airStart_us) {
+  // Эфир раньше записи или позже таймаута передачи - подъем AUX не от этого кадра
+  uint32_t delay = airStart_us - write_us;
+  if (delay == 0 || delay > Config::Tx::SEND_TIMEOUT_MS * 1000UL) return;
+  txDelay_us = delay;
+}
+
+void ClockSync::processReference(uint32_t refTx_us, uint32_t localArrival_us) {
+  if (reference) return;
+  
+  // Опорные часы в момент прихода кадра к этому anchor
+  int32_t offset = (int32_t)(refTx_us + propagation_us - localArrival_us);
+  
+  // Отбраковка выбросов (битая метка, пропущенный AUX) при захваченной синхронизации.
+  // Несколько подряд - значит сдвинулись часы (перезагрузка опорного), начинаем заново.
+  if (isLocked()) {
+    int32_t error = offset - predictOffset(localArrival_us);
+    if (error > (int32_t)Config::Sync::MAX_OUTLIER_US ||
+        error < -(int32_t)Config::Sync::MAX_OUTLIER_US) {
+      rejected++;
+      if (++consecutiveRejects < Config::Sync::MIN_SAMPLES) return;
+      count = 0;
+      head = 0;
+    }
+  }
+  consecutiveRejects = 0;
+  
+  samples[head].local_us = localArrival_us;
+  samples[head].offset_us = offset;
+  head = (head + 1) % Config::Sync::WINDOW;
+  if (count < Config::Sync::WINDOW) count++;
+  lastSample_ms = millis();
+  
+  refit();
+}
+
+void ClockSync::refit() {
+  // Точки относительно последней - малые числа, float хватает
+  uint8_t last = (head + Config::Sync::WINDOW - 1) % Config::Sync::WINDOW;
+  baseLocal_us = samples[last].local_us;
+  baseOffset_us = samples[last].offset_us;
+  
+  float xs[Config::Sync::WINDOW];
+  float ys[Config::Sync::WINDOW];
+  float meanX = 0, meanY = 0;
+  
+  for (uint8_t i = 0; i < count; i++) {
+    xs[i] = (float)(int32_t)(samples[i].local_us - baseLocal_us);
+    ys[i] = (float)(samples[i].offset_us - baseOffset_us);
+    meanX += xs[i];
+    meanY += ys[i];
+  }
+  meanX /= count;
+  meanY /= count;
+  
+  float sxx = 0, sxy = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    sxx += (xs[i] - meanX) * (xs[i] - meanX);
+    sxy += (xs[i] - meanX) * (ys[i] - meanY);
+  }
+  
+  slope = (sxx > 0) ? sxy / sxx : 0;
+  intercept = meanY - slope * meanX;
+  
+  float sse = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    float r = ys[i] - (intercept + slope * xs[i]);
+    sse += r * r;
+  }
+  jitter_us = (count > 2) ? sqrtf(sse / (count - 2)) : 0;
+}
+
+bool ClockSync::isLocked() const {
+  if (reference) return true;
+  return count >= Config::Sync::MIN_SAMPLES &&
+         millis() - lastSample_ms <= Config::Sync::HOLDOVER_MS;
+}
+
+uint32_t ClockSync::toReference(uint32_t local_us) const {
+  if (reference) return local_us;
+  return local_us + (uint32_t)predictOffset(local_us);
+}
@@ -0,0 +1,70 @@
+#include "cobs_framing.h"
+
+size_t encodeSyncFrame(uint8_t* out, size_t outSize, const uint8_t* data, size_t length) {
+  if (length == 0 || length > FRAME_MAX_PAYLOAD || length + FRAME_SYNC_OVERHEAD > outSize) return 0;
+  
+  out[0] = FRAME_SYNC;
+  
+  // Группа: код на месте out[code], затем байты до нуля
+  size_t code = 1;
+  size_t pos = 2;
+  uint8_t run = 1;
+  for (size_t i = 0; i <= length; i++) {
+    uint8_t b = (i == 0) ? (uint8_t)length : data[i - 1];
+    if (b == 0) {
+      out[code] = run;
+      code = pos++;
+      run = 1;
+    } else {
+      out[pos++] = b;
+      run++;
+    }
+  }
+  out[code] = run;
+  return pos;
+}
+
+void CobsDecoder::start() {
+  run = 0;
+  remaining = 0;
+  zeroPending = false;
+  haveLength = false;
+  active = true;
+}
+
+void CobsDecoder::stop() {
+  run = 0;
+  remaining = 0;
+  zeroPending = false;
+  haveLength = false;
+  active = false;
+}
+
+CobsDecoder::Result CobsDecoder::decode(uint8_t b, uint8_t& out) {
+  uint8_t value;
+  if (run == 0) {
+    // Кодовый байт: неявный 0 предыдущей группы - байт данных
+    bool zero = zeroPending;
+    run = b - 1;
+    zeroPending = (b != 0xFF);
+    if (!zero) return COBS_NONE;
+    value = 0;
+  } else {
+    run--;
+    value = b;
+  }
+  
+  if (!haveLength) {
+    if (value == 0) {
+      stop();
+      return COBS_ERROR;
+    }
+    remaining = value;
+    haveLength = true;
+    return COBS_NONE;
+  }
+  
+  out = value;
+  if (--remaining == 0) stop();
+  return COBS_DATA;
+}
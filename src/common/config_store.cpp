@@ -0,0 +1,167 @@
+#include "config_store.h"
+#include "crc16.h"
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef PLATFORM_ESP32
+  #include <Preferences.h>
+#elif defined(PLATFORM_MEGA2560)
+  #include <EEPROM.h>
+#endif
+
+ConfigStore configStore;
+
+NodeConfig::NodeConfig()
+  : anchorId(Config::Node::ANCHOR_ID),
+    anchorX(Config::Node::ANCHOR_X),
+    anchorY(Config::Node::ANCHOR_Y),
+    tagId(Config::Tag::ID) {
+}
+
+static void putFloat(uint8_t* p, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(bits >> (8 * i));
+}
+
+static float getFloat(const uint8_t* p) {
+  uint32_t bits = 0;
+  for (uint8_t i = 0; i < 4; i++) bits |= (uint32_t)p[i] << (8 * i);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void ConfigStore::encode(uint8_t* record) const {
+  record[0] = RECORD_MAGIC;
+  record[1] = RECORD_VERSION;
+  record[2] = PAYLOAD_SIZE;
+  
+  uint8_t* payload = record + 3;
+  payload[0] = current.anchorId;
+  putFloat(payload + 1, current.anchorX);
+  putFloat(payload + 5, current.anchorY);
+  payload[9] = (uint8_t)current.tagId;
+  payload[10] = (uint8_t)(current.tagId >> 8);
+  
+  uint16_t crc = crc16(record, 3 + PAYLOAD_SIZE);
+  record[3 + PAYLOAD_SIZE] = (uint8_t)crc;
+  record[4 + PAYLOAD_SIZE] = (uint8_t)(crc >> 8);
+}
+
+ConfigStore::LoadResult ConfigStore::decode(const uint8_t* record) {
+  if (record[0] != RECORD_MAGIC) return LOAD_EMPTY;
+  if (record[1] != RECORD_VERSION || record[2] != PAYLOAD_SIZE) return LOAD_BAD_VERSION;
+  
+  uint16_t crc = record[3 + PAYLOAD_SIZE] | (uint16_t)record[4 + PAYLOAD_SIZE] << 8;
+  if (crc != crc16(record, 3 + PAYLOAD_SIZE)) return LOAD_BAD_CRC;
+  
+  const uint8_t* payload = record + 3;
+  current.anchorId = payload[0];
+  current.anchorX = getFloat(payload + 1);
+  current.anchorY = getFloat(payload + 5);
+  current.tagId = payload[9] | (uint16_t)payload[10] << 8;
+  return LOAD_OK;
+}
+
+ConfigStore::LoadResult ConfigStore::load() {
+  uint8_t record[RECORD_SIZE];
+  current = NodeConfig();
+  if (!readRecord(record)) return LOAD_EMPTY;
+  
+  LoadResult result = decode(record);
+  if (result != LOAD_OK) current = NodeConfig();
+  return result;
+}
+
+bool ConfigStore::save() {
+  uint8_t record[RECORD_SIZE];
+  encode(record);
+  return writeRecord(record);
+}
+
+#ifdef PLATFORM_ESP32
+
+bool ConfigStore::readRecord(uint8_t* record) {
+  Preferences prefs;
+  if (!prefs.begin("node", true)) return false;  // Пространства еще нет
+  size_t len = prefs.getBytes("cfg", record, RECORD_SIZE);
+  prefs.end();
+  return len == RECORD_SIZE;
+}
+
+bool ConfigStore::writeRecord(const uint8_t* record) {
+  Preferences prefs;
+  if (!prefs.begin("node", false)) return false;
+  size_t len = prefs.putBytes("cfg", record, RECORD_SIZE);
+  prefs.end();
+  return len == RECORD_SIZE;
+}
+
+#elif defined(PLATFORM_MEGA2560)
+
+bool ConfigStore::readRecord(uint8_t* record) {
+  for (uint8_t i = 0; i < RECORD_SIZE; i++) {
+    record[i] = EEPROM.read(Config::Node::EEPROM_ADDR + i);
+  }
+  return true;
+}
+
+bool ConfigStore::writeRecord(const uint8_t* record) {
+  // update пишет только измененные байты - ресурс EEPROM ~100k циклов
+  for (uint8_t i = 0; i < RECORD_SIZE; i++) {
+    EEPROM.update(Config::Node::EEPROM_ADDR + i, record[i]);
+  }
+  return true;
+}
+
+#else
+
+// Хост: запись живет до конца процесса
+static uint8_t hostRecord[ConfigStore::RECORD_SIZE];
+static bool hostRecordValid = false;
+
+bool ConfigStore::readRecord(uint8_t* record) {
+  if (!hostRecordValid) return false;
+  memcpy(record, hostRecord, RECORD_SIZE);
+  return true;
+}
+
+bool ConfigStore::writeRecord(const uint8_t* record) {
+  memcpy(hostRecord, record, RECORD_SIZE);
+  hostRecordValid = true;
+  return true;
+}
+
+#endif
+
+bool ConfigStore::parseAnchor(const char* args, uint8_t& id, float& x, float& y) {
+  char* end;
+  long value = strtol(args, &end, 10);
+  if (end == args || value < 0 || value > 255) return false;
+  
+  const char* next = end;
+  double px = strtod(next, &end);
+  if (end == next) return false;
+  next = end;
+  double py = strtod(next, &end);
+  if (end == next) return false;
+  
+  while (*end == ' ') end++;
+  if (*end != '\0' || !isfinite(px) || !isfinite(py)) return false;
+  
+  id = (uint8_t)value;
+  x = (float)px;
+  y = (float)py;
+  return true;
+}
+
+const char* ConfigStore::resultName(LoadResult result) {
+  switch (result) {
+    case LOAD_OK:          return "loaded";
+    case LOAD_EMPTY:       return "no record, defaults";
+    case LOAD_BAD_VERSION: return "other version, defaults";
+    case LOAD_BAD_CRC:     return "CRC mismatch, defaults";
+  }
+  return "?";
+}
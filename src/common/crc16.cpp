@@ -0,0 +1,23 @@
+#include "crc16.h"
+
+static_assert(crc16Const("123456789") == 0x29B1, "CRC-16/CCITT-FALSE check value");
+
+// 256 элементов раскрываются препроцессором, значения считает компилятор
+#define CRC16_ROW4(i)   crc16TableEntry(i), crc16TableEntry(i + 1), crc16TableEntry(i + 2), crc16TableEntry(i + 3)
+#define CRC16_ROW16(i)  CRC16_ROW4(i), CRC16_ROW4(i + 4), CRC16_ROW4(i + 8), CRC16_ROW4(i + 12)
+#define CRC16_ROW64(i)  CRC16_ROW16(i), CRC16_ROW16(i + 16), CRC16_ROW16(i + 32), CRC16_ROW16(i + 48)
+
+const uint16_t CRC16_TABLE[256] PROGMEM = {
+  CRC16_ROW64(0), CRC16_ROW64(64), CRC16_ROW64(128), CRC16_ROW64(192)
+};
+
+#undef CRC16_ROW4
+#undef CRC16_ROW16
+#undef CRC16_ROW64
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+  for (size_t i = 0; i < len; i++) {
+    crc = crc16Update(crc, data[i]);
+  }
+  return crc;
+}
@@ -1,14 +1,79 @@
 #include "display.h"
+#include "latency_stats.h"
 
 DisplayManager displayManager;
 
 #ifdef PLATFORM_ESP32
 
-DisplayManager::DisplayManager() {
+// Сборка текста строки экрана без String и кучи
+class RowText {
+public:
+  RowText() : len(0) { text[0] = '\0'; }
+  
+  // Длиннее maxLen - обрезка с ".." на конце
+  RowText& add(const char* str, uint8_t maxLen = sizeof(text) - 1) {
+    size_t strLen = strlen(str);
+    bool truncate = strLen > maxLen;
+    size_t take = truncate ? maxLen - 2 : strLen;
+    for (size_t i = 0; i < take; i++) put(str[i]);
+    if (truncate) {
+      put('.');
+      put('.');
+    }
+    return *this;
+  }
+  
+  RowText& add(uint32_t value) {
+    char digits[10];
+    uint8_t n = 0;
+    do {
+      digits[n++] = '0' + value % 10;
+      value /= 10;
+    } while (value);
+    while (n) put(digits[--n]);
+    return *this;
+  }
+  
+  RowText& add(int32_t value) {
+    if (value < 0) {
+      put('-');
+      return add((uint32_t)(-(int64_t)value));
+    }
+    return add((uint32_t)value);
+  }
+  
+  // Длительность: мкс, мс с двумя знаками
+  RowText& addDuration(uint32_t us) {
+    if (us < 1000) return add(us).add(" us");
+    uint32_t centiMs = (us + 5) / 10;
+    uint32_t frac = centiMs % 100;
+    return add(centiMs / 100).add(frac < 10 ? ".0" : ".").add(frac).add(" ms");
+  }
+  
+  const char* c_str() const { return text; }
+  
+private:
+  char text[Config::Display::OLED_WIDTH / 6 + 1];
+  uint8_t len;
+  
+  void put(char c) {
+    if ((size_t)len + 1 >= sizeof(text)) return;
+    text[len++] = c;
+    text[len] = '\0';
+  }
+};
+
+DisplayManager::DisplayManager()
+  : page(PAGE_RX), dirtyRows(0), lastFlushMs(0), flushCount(0), lastFlushUs(0), maxFlushUs(0), fullFrameUs(0) {
+  // Fast-mode I2C и во время, и после передачи (по умолчанию после - 100 кГц)
   display = new Adafruit_SSD1306(Config::Display::OLED_WIDTH, 
                                   Config::Display::OLED_HEIGHT, 
-                                  &Wire, -1);
+                                  &Wire, -1,
+                                  Config::Display::I2C_CLOCK_HZ,
+                                  Config::Display::I2C_CLOCK_HZ);
   isEnabled = Config::Display::OLED_ENABLED;
+  
+  for (uint8_t i = 0; i < ROWS; i++) rows[i][0] = '\0';
 }
 
 bool DisplayManager::initialize() {
@@ -18,6 +83,7 @@ bool DisplayManager::initialize() {
   
   // Инициализация I2C с нестандартными пинами
   Wire.begin(Config::Pins::OLED_SDA, Config::Pins::OLED_SCL);
+  Wire.setClock(Config::Display::I2C_CLOCK_HZ);
   
   // Инициализация дисплея
   if (!display->begin(SSD1306_SWITCHCAPVCC, Config::Display::OLED_ADDRESS)) {
@@ -37,175 +103,253 @@ bool DisplayManager::initialize() {
   display->clearDisplay();
   display->setTextSize(1);
   display->setTextColor(SSD1306_WHITE);
-  display->setCursor(0, 0);
-  display->println("  LoRa TDOA System");
-  display->println("  ================");
-  display->println();
-  display->println("  Initializing...");
+  display->setTextWrap(false);
+  
+  // Эталон: полный кадр 1 КБ, как раньше на каждый пакет
+  uint32_t start = micros();
   display->display();
+  fullFrameUs = micros() - start;
+  
+  Serial.print("OLED: full frame push ");
+  Serial.print(fullFrameUs);
+  Serial.print("us @ ");
+  Serial.print(Config::Display::I2C_CLOCK_HZ / 1000);
+  Serial.println(" kHz");
+  
+  clearRows();
+  setRow(0, "  LoRa TDOA System");
+  setRow(1, "  ================");
+  setRow(3, "  Initializing...");
+  flush();
   
   return true;
 }
 
+void DisplayManager::setRow(uint8_t row, const char* text) {
+  if (row >= ROWS) return;
+  if (strncmp(rows[row], text, COLS) == 0) return;
+  
+  strncpy(rows[row], text, COLS);
+  rows[row][COLS] = '\0';
+  dirtyRows |= (uint8_t)(1 << row);
+}
+
+void DisplayManager::clearRows() {
+  for (uint8_t i = 0; i < ROWS; i++) setRow(i, "");
+}
+
+void DisplayManager::tick() {
+  if (!isEnabled || !dirtyRows) return;
+  if (millis() - lastFlushMs < 1000 / Config::Display::MAX_REFRESH_HZ) return;
+  flush();
+}
+
+void DisplayManager::flush() {
+  if (!isEnabled || !dirtyRows) return;
+  
+  uint32_t start = micros();
+  
+  // Перерисовка только измененных строк в буфере
+  for (uint8_t row = 0; row < ROWS; row++) {
+    if (!(dirtyRows & (1 << row))) continue;
+    display->fillRect(0, row * 8, Config::Display::OLED_WIDTH, 8, SSD1306_BLACK);
+    display->setCursor(0, row * 8);
+    display->print(rows[row]);
+  }
+  
+  // Отправка подряд идущих грязных страниц одним окном адресов
+  uint8_t row = 0;
+  while (row < ROWS) {
+    if (!(dirtyRows & (1 << row))) {
+      row++;
+      continue;
+    }
+    uint8_t first = row;
+    while (row < ROWS && (dirtyRows & (1 << row))) row++;
+    pushPages(first, row - 1);
+  }
+  
+  dirtyRows = 0;
+  lastFlushMs = millis();
+  lastFlushUs = micros() - start;
+  if (lastFlushUs > maxFlushUs) maxFlushUs = lastFlushUs;
+  flushCount++;
+}
+
+void DisplayManager::pushPages(uint8_t first, uint8_t last) {
+  display->ssd1306_command(SSD1306_PAGEADDR);
+  display->ssd1306_command(first);
+  display->ssd1306_command(last);
+  display->ssd1306_command(SSD1306_COLUMNADDR);
+  display->ssd1306_command(0);
+  display->ssd1306_command(Config::Display::OLED_WIDTH - 1);
+  
+  const uint8_t* data = display->getBuffer() + first * Config::Display::OLED_WIDTH;
+  size_t remaining = (size_t)(last - first + 1) * Config::Display::OLED_WIDTH;
+  
+  // Байт управления 0x40 + данные: транзакция не больше буфера Wire
+  const size_t maxChunk = Config::Display::I2C_CHUNK - 1;
+  while (remaining > 0) {
+    size_t chunk = remaining < maxChunk ? remaining : maxChunk;
+    Wire.beginTransmission(Config::Display::OLED_ADDRESS);
+    Wire.write((uint8_t)0x40);  // Co=0, D/C=1: поток данных
+    for (size_t i = 0; i < chunk; i++) Wire.write(data[i]);
+    Wire.endTransmission();
+    data += chunk;
+    remaining -= chunk;
+  }
+}
+
 void DisplayManager::showInitScreen(const String& mode) {
   if (!isEnabled) return;
   
-  display->clearDisplay();
-  display->setTextSize(1);
-  display->setCursor(0, 0);
-  
-  display->println("===== LoRa TDOA =====");
-  display->println();
-  display->print("Mode: ");
-  display->println(mode);
-  display->println();
-  display->println("Platform: ESP32 v1302");
-  display->print("LoRa: GPIO");
-  display->print(Config::Pins::UART_RX);
-  display->print("/");
-  display->println(Config::Pins::UART_TX);
-  display->print("AUX:  GPIO");
-  display->println(Config::Pins::E32_AUX);
-  display->print("LED:  GPIO");
-  display->println(Config::Pins::LED);
+  RowText modeRow, loraRow, auxRow, ledRow;
+  modeRow.add("Mode: ").add(mode.c_str());
+  loraRow.add("LoRa: GPIO").add((uint32_t)Config::Pins::UART_RX).add("/").add((uint32_t)Config::Pins::UART_TX);
+  auxRow.add("AUX:  GPIO").add((uint32_t)Config::Pins::E32_AUX);
+  ledRow.add("LED:  GPIO").add((uint32_t)Config::Pins::LED);
   
-  display->display();
+  setRow(0, "===== LoRa TDOA =====");
+  setRow(1, "");
+  setRow(2, modeRow.c_str());
+  setRow(3, "");
+  setRow(4, "Platform: ESP32 v1302");
+  setRow(5, loraRow.c_str());
+  setRow(6, auxRow.c_str());
+  setRow(7, ledRow.c_str());
+  
+  flush();  // Экран состояния - сразу, без ограничения частоты
 }
 
 void DisplayManager::showError(const String& error) {
   if (!isEnabled) return;
   
-  display->clearDisplay();
-  display->setTextSize(1);
-  display->setCursor(0, 0);
+  RowText errorRow;
+  errorRow.add(error.c_str());
   
-  display->println("===== ERROR =====");
-  display->println();
-  display->println(error);
-  display->println();
-  display->println("Check connections");
-  display->println("and reset device.");
+  setRow(0, "===== ERROR =====");
+  setRow(1, "");
+  setRow(2, errorRow.c_str());
+  setRow(3, "");
+  setRow(4, "Check connections");
+  setRow(5, "and reset device.");
+  setRow(6, "");
+  setRow(7, "");
   
-  display->display();
+  flush();
 }
 
 void DisplayManager::showTxStatus(uint32_t sequence, const String& message, bool success) {
   if (!isEnabled) return;
   
-  display->clearDisplay();
-  display->setTextSize(1);
-  display->setCursor(0, 0);
+  RowText statusRow, packetsRow, msgRow, uptimeRow;
+  statusRow.add("Status: ").add(success ? "OK" : "FAIL");
+  packetsRow.add("Packets: ").add(sequence);
+  msgRow.add("MSG: ").add(message.c_str(), 16);
+  uptimeRow.add("Uptime: ").add(millis() / 1000).add("s");
   
-  // Заголовок
-  display->println("==== TX MODE ====");
-  display->println();
+  setRow(0, "==== TX MODE ====");
+  setRow(1, "");
+  setRow(2, statusRow.c_str());
+  setRow(3, packetsRow.c_str());
+  setRow(4, "");
+  setRow(5, msgRow.c_str());
+  setRow(6, "");
+  setRow(7, uptimeRow.c_str());
   
-  // Статус отправки
-  display->print("Status: ");
-  if (success) {
-    display->println("OK");
-  } else {
-    display->println("FAIL");
-  }
-  
-  // Счетчик пакетов
-  display->print("Packets: ");
-  display->println(sequence);
+  tick();
+}
+
+void DisplayManager::setPage(Page newPage) { page = newPage; }
+DisplayManager::Page DisplayManager::getPage() const { return page; }
+
+void DisplayManager::showLatencyPage() {
+  // Завершенное окно, пока его нет - текущее
+  bool last = rxLatencyStats.lastLatency().count > 0;
+  LatencySummary lat = last ? rxLatencyStats.lastLatency() : rxLatencyStats.currentLatency();
+  LatencySummary jit = last ? rxLatencyStats.lastJitter() : rxLatencyStats.currentJitter();
   
-  // Текущее сообщение (обрезаем если длинное)
-  display->println();
-  display->print("MSG: ");
-  String truncMsg = truncateString(message, 16);
-  display->println(truncMsg);
+  RowText winRow, p50Row, p90Row, p99Row, maxRow, jitP99Row, jitMaxRow;
+  winRow.add(last ? "Last " : "Now ").add(Config::Stats::WINDOW_MS / 1000).add("s n=").add(lat.count);
+  p50Row.add("LAT p50 ").addDuration(lat.p50_us);
+  p90Row.add("    p90 ").addDuration(lat.p90_us);
+  p99Row.add("    p99 ").addDuration(lat.p99_us);
+  maxRow.add("    max ").addDuration(lat.max_us);
+  jitP99Row.add("JIT p99 ").addDuration(jit.p99_us);
+  jitMaxRow.add("    max ").addDuration(jit.max_us);
   
-  // Время работы
-  display->println();
-  display->print("Uptime: ");
-  display->print(millis() / 1000);
-  display->println("s");
+  setRow(0, "=== RX LATENCY ===");
+  setRow(1, winRow.c_str());
+  setRow(2, p50Row.c_str());
+  setRow(3, p90Row.c_str());
+  setRow(4, p99Row.c_str());
+  setRow(5, maxRow.c_str());
+  setRow(6, jitP99Row.c_str());
+  setRow(7, jitMaxRow.c_str());
   
-  display->display();
+  tick();
 }
 
 void DisplayManager::showRxStatus(const PacketData& packet, const RxStats& stats) {
   if (!isEnabled) return;
   
-  display->clearDisplay();
-  display->setTextSize(1);
-  display->setCursor(0, 0);
-  
-  // Заголовок
-  display->println("==== RX MODE ====");
-  display->println();
-  
-  // EUID (обрезаем)
-  display->print("EUID: ");
-  String truncEUID = truncateString(packet.euid, 12);
-  display->println(truncEUID);
-  
-  // Номер пакета
-  display->print("SEQ:  ");
-  display->println(packet.sequence);
-  
-  // Сообщение (обрезаем)
-  display->print("MSG:  ");
-  String truncMsg = truncateString(packet.message, 12);
-  display->println(truncMsg);
-  
-  // Задержка
-  display->println();
-  display->print("LAT: ");
-  if (stats.latency_us >= 0) {
-    if (stats.latency_us < 1000) {
-      display->print(stats.latency_us);
-      display->println(" us");
-    } else {
-      display->print(stats.latency_us / 1000.0, 2);
-      display->println(" ms");
-    }
+  if (page == PAGE_LATENCY) {
+    showLatencyPage();
+    return;
+  }
+  
+  RowText euidRow, seqRow, msgRow, latRow, rssiRow;
+  euidRow.add("EUID: ").add(packet.euid, 12);
+  seqRow.add("SEQ:  ").add(packet.sequence);
+  msgRow.add("MSG:  ").add(packet.message, 12);
+  
+  // Задержка: мкс, мс с двумя знаками или N/A
+  latRow.add("LAT: ");
+  if (stats.latency_us < 0) {
+    latRow.add("N/A");
   } else {
-    display->println("N/A");
+    latRow.addDuration((uint32_t)stats.latency_us);
   }
   
-  // RSSI и SNR
-  display->print("RSSI: ");
-  display->print(stats.rssi);
-  display->print(" SNR: ");
-  display->println(stats.snr);
+  rssiRow.add("RSSI: ").add((int32_t)stats.rssi).add(" SNR: ").add((int32_t)stats.snr);
   
-  display->display();
+  setRow(0, "==== RX MODE ====");
+  setRow(1, "");
+  setRow(2, euidRow.c_str());
+  setRow(3, seqRow.c_str());
+  setRow(4, msgRow.c_str());
+  setRow(5, "");
+  setRow(6, latRow.c_str());
+  setRow(7, rssiRow.c_str());
+  
+  tick();
 }
 
 void DisplayManager::clear() {
   if (!isEnabled) return;
-  display->clearDisplay();
-  display->display();
+  clearRows();
+  tick();
 }
 
-String DisplayManager::formatTime(uint32_t micros) {
-  if (micros < 1000) {
-    return String(micros) + "us";
-  } else if (micros < 1000000) {
-    return String(micros / 1000.0, 2) + "ms";
-  } else {
-    return String(micros / 1000000.0, 2) + "s";
-  }
-}
-
-String DisplayManager::truncateString(const String& str, uint8_t maxLen) {
-  if (str.length() <= maxLen) {
-    return str;
-  }
-  return str.substring(0, maxLen - 2) + "..";
-}
+uint32_t DisplayManager::getFlushCount() const { return flushCount; }
+uint32_t DisplayManager::getLastFlushUs() const { return lastFlushUs; }
+uint32_t DisplayManager::getMaxFlushUs() const { return maxFlushUs; }
+uint32_t DisplayManager::getFullFrameUs() const { return fullFrameUs; }
 
 #else
 // Заглушки для платформ без дисплея (Arduino Mega)
 DisplayManager::DisplayManager() {}
 bool DisplayManager::initialize() { return true; }
-void DisplayManager::showTxStatus(uint32_t sequence, const String& message, bool success) {}
-void DisplayManager::showRxStatus(const PacketData& packet, const RxStats& stats) {}
-void DisplayManager::showInitScreen(const String& mode) {}
-void DisplayManager::showError(const String& error) {}
+void DisplayManager::showTxStatus(uint32_t /*sequence*/, const String& /*message*/, bool /*success*/) {}
+void DisplayManager::showRxStatus(const PacketData& /*packet*/, const RxStats& /*stats*/) {}
+void DisplayManager::setPage(Page /*page*/) {}
+DisplayManager::Page DisplayManager::getPage() const { return PAGE_RX; }
+void DisplayManager::showInitScreen(const String& /*mode*/) {}
+void DisplayManager::showError(const String& /*error*/) {}
 void DisplayManager::clear() {}
+void DisplayManager::tick() {}
+uint32_t DisplayManager::getFlushCount() const { return 0; }
+uint32_t DisplayManager::getLastFlushUs() const { return 0; }
+uint32_t DisplayManager::getMaxFlushUs() const { return 0; }
+uint32_t DisplayManager::getFullFrameUs() const { return 0; }
 #endif
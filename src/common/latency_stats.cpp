@@ -0,0 +1,167 @@
+#include "latency_stats.h"
+
+RxLatencyStats rxLatencyStats;
+
+// ===== LogLinearHistogram =====
+
+void LogLinearHistogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  count = 0;
+  maxValue = 0;
+}
+
+uint16_t LogLinearHistogram::bucketOf(uint32_t value) {
+  if (value < (1UL << SUB_BITS)) return (uint16_t)value;
+  if (value >= (1UL << MAX_BITS)) return BUCKETS - 1;
+  
+  // Старший бит задает октаву, следующие SUB_BITS бит - корзину внутри нее
+  uint8_t msb = SUB_BITS;
+  while (value >> (msb + 1)) msb++;
+  uint8_t shift = msb - SUB_BITS;
+  uint16_t sub = (uint16_t)(value >> shift) & ((1U << SUB_BITS) - 1);
+  return (uint16_t)((shift + 1) << SUB_BITS) + sub;
+}
+
+uint32_t LogLinearHistogram::bucketUpper(uint16_t bucket) {
+  if (bucket < (1U << SUB_BITS)) return bucket;
+  
+  uint8_t shift = (bucket >> SUB_BITS) - 1;
+  uint32_t sub = bucket & ((1U << SUB_BITS) - 1);
+  uint32_t low = ((1UL << SUB_BITS) + sub) << shift;
+  return low + (1UL << shift) - 1;
+}
+
+void LogLinearHistogram::record(uint32_t value) {
+  uint16_t& bucket = counts[bucketOf(value)];
+  if (bucket < 0xFFFF) bucket++;
+  count++;
+  if (value > maxValue) maxValue = value;
+}
+
+uint32_t LogLinearHistogram::percentile(uint8_t pct) const {
+  if (count == 0) return 0;
+  
+  // Ранг с округлением вверх: p99 из 10 значений - десятое
+  uint32_t rank = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+  if (rank == 0) rank = 1;
+  
+  uint32_t seen = 0;
+  for (uint16_t i = 0; i < BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      // Последняя корзина открыта сверху - ее граница только max
+      uint32_t upper = i == BUCKETS - 1 ? maxValue : bucketUpper(i);
+      return upper < maxValue ? upper : maxValue;
+    }
+  }
+  return maxValue;
+}
+
+// ===== RxLatencyStats =====
+
+RxLatencyStats::RxLatencyStats()
+  : windowStartMs(0), negative(0), crcRejects(0) {
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) transits[i].used = false;
+}
+
+LatencySummary RxLatencyStats::summarize(const LogLinearHistogram& hist) {
+  LatencySummary summary;
+  summary.count = hist.getCount();
+  summary.p50_us = hist.percentile(50);
+  summary.p90_us = hist.percentile(90);
+  summary.p99_us = hist.percentile(99);
+  summary.max_us = hist.getMax();
+  return summary;
+}
+
+void RxLatencyStats::roll() {
+  lastLatencyWindow = summarize(latency);
+  lastJitterWindow = summarize(jitter);
+  latency.reset();
+  jitter.reset();
+  windowStartMs = millis();
+}
+
+RxLatencyStats::TagTransit* RxLatencyStats::findOrCreateTransit(uint16_t tagId, bool& created) {
+  TagTransit* victim = &transits[0];
+  uint32_t now = millis();
+  
+  // Свободная запись предпочтительнее, иначе - самая давняя
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    TagTransit& entry = transits[i];
+    if (entry.used && entry.tagId == tagId) {
+      created = false;
+      return &entry;
+    }
+    if (!victim->used) continue;
+    if (!entry.used || now - entry.lastSeen_ms > now - victim->lastSeen_ms) victim = &entry;
+  }
+  
+  victim->tagId = tagId;
+  victim->used = true;
+  created = true;
+  return victim;
+}
+
+void RxLatencyStats::record(uint16_t tagId, const RxStats& stats) {
+  if (millis() - windowStartMs >= Config::Stats::WINDOW_MS) roll();
+  
+  if (stats.latency_us < 0) {
+    negative++;
+  } else {
+    latency.record((uint32_t)stats.latency_us);
+  }
+  
+  // Транзит без airtime: длина кадра не попадает в джиттер
+  // Разность только внутри потока одного тега: часы разных тегов не сравнимы
+  int32_t transit = stats.latency_us - (int32_t)stats.airtime_us;
+  bool created;
+  TagTransit* entry = findOrCreateTransit(tagId, created);
+  if (!created) {
+    int32_t d = transit - entry->lastTransit_us;
+    jitter.record(d < 0 ? (uint32_t)-d : (uint32_t)d);
+  }
+  entry->lastTransit_us = transit;
+  entry->lastSeen_ms = millis();
+}
+
+static void printSummary(Print& out, const char* label, const LatencySummary& s) {
+  out.print(label);
+  out.print(" n=");
+  out.print(s.count);
+  out.print(" p50=");
+  out.print(s.p50_us);
+  out.print("us p90=");
+  out.print(s.p90_us);
+  out.print("us p99=");
+  out.print(s.p99_us);
+  out.print("us max=");
+  out.print(s.max_us);
+  out.println("us");
+}
+
+void RxLatencyStats::printReport(Print& out) const {
+  out.print("RX latency stats: window ");
+  out.print(Config::Stats::WINDOW_MS / 1000);
+  out.print("s, current ");
+  out.print(getWindowAge_s());
+  out.print("s, ");
+  out.print(LogLinearHistogram::BUCKETS);
+  out.print(" buckets, err <=");
+  out.print(100.0f / (1 << LogLinearHistogram::SUB_BITS), 1);
+  out.println("%");
+  
+  printSummary(out, "  latency now: ", currentLatency());
+  printSummary(out, "  latency last:", lastLatencyWindow);
+  printSummary(out, "  jitter now:  ", currentJitter());
+  printSummary(out, "  jitter last: ", lastJitterWindow);
+  
+  if (negative) {
+    out.print("  negative latency (tag clock ahead): ");
+    out.println(negative);
+  }
+  if (crcRejects) {
+    out.print("  CRC rejects: ");
+    out.println(crcRejects);
+  }
+}
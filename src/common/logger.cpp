@@ -0,0 +1,213 @@
+#include "logger.h"
+
+#ifdef PLATFORM_ESP32
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+#endif
+
+Logger logger;
+
+// Подписи событий: имя и до трех аргументов (nullptr - не печатать)
+struct LogEventInfo {
+  const char* name;
+  const char* args[3];
+};
+
+static const LogEventInfo EVENT_INFO[LOG_EVENT_COUNT] = {
+  {"rx byte",         {"value", nullptr, nullptr}},
+  {"rx frame",        {"seq", "lat_us", "air_us"}},
+  {"rx malformed",    {"first_us", "bytes", nullptr}},
+  {"rx alive",        {"ok", "err", "available"}},
+  {"sync sent",       {"seq", "ok", nullptr}},
+  {"sync sample",     {"samples", "skew_ppb", "jitter_ns"}},
+  {"sync status",     {"locked", "samples", "rejected"}},
+  {"tdoa recorded",   {"key_lo", "anchors", nullptr}},
+  {"tdoa not synced", {"seq", nullptr, nullptr}},
+  {"pipeline queue",  {"hwm", "dropped", "frames"}},
+  {"pipeline avg",    {"read_us", "queue_us", "process_us"}},
+  {"pipeline max",    {"read_us", "queue_us", "process_us"}},
+  {"pipeline render", {"renders", "avg_us", "max_us"}},
+  {"display flush",   {"flushes", "max_us", "full_us"}},
+  {"seq duplicate",   {"seq", "sender", nullptr}},
+  {"seq suspect",     {"seq", "sender", nullptr}},
+  {"seq resync",      {"seq", "sender", nullptr}},
+};
+
+static const char LEVEL_CHARS[] = "-EWID";
+
+// Атомарные операции над индексами очереди.
+// AVR: одно ядро, нет CAS - короткая критическая секция (SREG сохраняется, можно из ISR).
+#ifdef PLATFORM_MEGA2560
+  template <typename T>
+  static inline T atomicLoad(const T* p) {
+    uint8_t sreg = SREG;
+    cli();
+    T value = *(const volatile T*)p;
+    SREG = sreg;
+    return value;
+  }
+
+  template <typename T>
+  static inline void atomicStore(T* p, T value) {
+    uint8_t sreg = SREG;
+    cli();
+    *(volatile T*)p = value;
+    SREG = sreg;
+  }
+
+  template <typename T>
+  static inline bool atomicCas(T* p, T expected, T desired) {
+    uint8_t sreg = SREG;
+    cli();
+    bool ok = (*(volatile T*)p == expected);
+    if (ok) *(volatile T*)p = desired;
+    SREG = sreg;
+    return ok;
+  }
+
+  template <typename T>
+  static inline void atomicIncrement(T* p) {
+    uint8_t sreg = SREG;
+    cli();
+    (*(volatile T*)p)++;
+    SREG = sreg;
+  }
+#else
+  template <typename T>
+  static inline T atomicLoad(const T* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  template <typename T>
+  static inline void atomicStore(T* p, T value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+  }
+
+  template <typename T>
+  static inline bool atomicCas(T* p, T expected, T desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+  }
+
+  template <typename T>
+  static inline void atomicIncrement(T* p) {
+    __atomic_fetch_add(p, 1, __ATOMIC_RELAXED);
+  }
+#endif
+
+#ifdef PLATFORM_ESP32
+static void drainTask(void* param) {
+  for (;;) {
+    logger.drain(Serial, Config::Log::DRAIN_BATCH);
+    vTaskDelay(pdMS_TO_TICKS(Config::Log::DRAIN_PERIOD_MS));
+  }
+}
+#endif
+
+Logger::Logger()
+  : enqueuePos(0), dequeuePos(0), dropped(0), reportedDropped(0) {
+  for (Index i = 0; i < CAPACITY; i++) {
+    cells[i].seq = i;
+  }
+}
+
+void Logger::begin() {
+  #ifdef PLATFORM_ESP32
+    xTaskCreatePinnedToCore(drainTask, "log", Config::Log::DRAIN_TASK_STACK, nullptr,
+                            Config::Log::DRAIN_TASK_PRIORITY, nullptr,
+                            Config::Log::DRAIN_TASK_CORE);
+  #endif
+}
+
+bool Logger::record(uint8_t level, LogEvent event, int32_t a0, int32_t a1, int32_t a2) {
+  Index pos = atomicLoad(&enqueuePos);
+  Cell* cell;
+  
+  // Резервируем ячейку: несколько производителей (задачи, ISR) соревнуются через CAS
+  for (;;) {
+    cell = &cells[pos & MASK];
+    IndexDiff diff = (IndexDiff)(atomicLoad(&cell->seq) - pos);
+    
+    if (diff == 0) {
+      if (atomicCas(&enqueuePos, pos, (Index)(pos + 1))) break;
+      pos = atomicLoad(&enqueuePos);
+    } else if (diff < 0) {
+      atomicIncrement(&dropped);  // Полон: потребитель не успевает
+      return false;
+    } else {
+      pos = atomicLoad(&enqueuePos);
+    }
+  }
+  
+  cell->record.time_us = micros();
+  cell->record.level = level;
+  cell->record.event = event;
+  cell->record.args[0] = a0;
+  cell->record.args[1] = a1;
+  cell->record.args[2] = a2;
+  
+  // Публикация записи потребителю
+  atomicStore(&cell->seq, (Index)(pos + 1));
+  return true;
+}
+
+bool Logger::pop(LogRecord& out) {
+  Cell* cell = &cells[dequeuePos & MASK];
+  IndexDiff diff = (IndexDiff)(atomicLoad(&cell->seq) - (Index)(dequeuePos + 1));
+  if (diff < 0) return false;  // Пусто (или запись еще не опубликована)
+  
+  out = cell->record;
+  atomicStore(&cell->seq, (Index)(dequeuePos + CAPACITY));
+  dequeuePos++;
+  return true;
+}
+
+uint8_t Logger::drain(Print& out, uint8_t maxRecords) {
+  uint32_t droppedNow = atomicLoad(&dropped);
+  if (droppedNow != reportedDropped) {
+    out.print("[log] dropped ");
+    out.print(droppedNow - reportedDropped);
+    out.print(" records (total ");
+    out.print(droppedNow);
+    out.println(")");
+    reportedDropped = droppedNow;
+  }
+  
+  uint8_t printed = 0;
+  LogRecord rec;
+  while (printed < maxRecords && pop(rec)) {
+    print(out, rec);
+    printed++;
+  }
+  return printed;
+}
+
+void Logger::poll() {
+  if (Serial.availableForWrite() < Config::Log::POLL_MIN_TX_SPACE) return;
+  drain(Serial, 1);
+}
+
+void Logger::print(Print& out, const LogRecord& rec) {
+  out.print("[");
+  out.print(rec.time_us);
+  out.print("] ");
+  out.print(LEVEL_CHARS[rec.level <= LOG_LEVEL_DEBUG ? rec.level : 0]);
+  out.print(" ");
+  
+  if (rec.event >= LOG_EVENT_COUNT) {
+    out.print("event #");
+    out.println(rec.event);
+    return;
+  }
+  
+  const LogEventInfo& info = EVENT_INFO[rec.event];
+  out.print(info.name);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (!info.args[i]) break;
+    out.print(" ");
+    out.print(info.args[i]);
+    out.print("=");
+    out.print(rec.args[i]);
+  }
+  out.println();
+}
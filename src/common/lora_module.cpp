@@ -1,17 +1,53 @@
 #include "lora_module.h"
+#include "rx_capture.h"
 
 LoRaModule loraModule;
 
+#ifndef IRAM_ATTR
+  #define IRAM_ATTR
+#endif
+
+// Метки последних спада и подъема AUX, пишутся из ISR
+static volatile uint32_t auxFallTime_us = 0;
+static volatile uint16_t auxFallCount = 0;
+static volatile uint32_t auxRiseTime_us = 0;
+static volatile uint16_t auxRiseCount = 0;
+
+static void IRAM_ATTR onAuxChange() {
+  uint32_t now = micros();
+  if (digitalRead(Config::Pins::E32_AUX) == LOW) {
+    auxFallTime_us = now;
+    auxFallCount++;
+  } else {
+    auxRiseTime_us = now;
+    auxRiseCount++;
+  }
+}
+
 // Инициализация для разных платформ
 #ifdef PLATFORM_ESP32
 LoRaModule::LoRaModule() 
   : loraSerial(2),  // ESP32: UART2
-    e32(&loraSerial, Config::Pins::E32_AUX) {
+    e32(&loraSerial, Config::Pins::E32_AUX),
+    lastAuxFallCount(0), captureAuxCount(0),
+    sendActive(false), sendSawBusy(false), sendStart_us(0), sendUart_us(0),
+    batchLen(0), batchFrames(0), lastSendBytes(0), sendAirStart_us(0), sendAirStartValid(false) {
 }
 #elif defined(PLATFORM_MEGA2560)
 LoRaModule::LoRaModule() 
   : loraSerial(Serial1),  // Mega: UART1
-    e32(&Serial1, Config::Pins::E32_AUX) {
+    e32(&Serial1, Config::Pins::E32_AUX),
+    lastAuxFallCount(0), captureAuxCount(0),
+    sendActive(false), sendSawBusy(false), sendStart_us(0), sendUart_us(0),
+    batchLen(0), batchFrames(0), lastSendBytes(0), sendAirStart_us(0), sendAirStartValid(false) {
+}
+#elif defined(PLATFORM_NATIVE)
+LoRaModule::LoRaModule() 
+  : loraSerial(1),  // Native: UART симулятора E32
+    e32(&loraSerial, Config::Pins::E32_AUX),
+    lastAuxFallCount(0), captureAuxCount(0),
+    sendActive(false), sendSawBusy(false), sendStart_us(0), sendUart_us(0),
+    batchLen(0), batchFrames(0), lastSendBytes(0), sendAirStart_us(0), sendAirStartValid(false) {
 }
 #endif
 
@@ -37,6 +73,8 @@ bool LoRaModule::initialize() {
                      Config::Pins::UART_RX, Config::Pins::UART_TX);
   #elif defined(PLATFORM_MEGA2560)
     Serial1.begin(Config::Protocol::LORA_BAUD_RATE);
+  #elif defined(PLATFORM_NATIVE)
+    loraSerial.begin(Config::Protocol::LORA_BAUD_RATE);
   #endif
   delay(Config::Timing::UART_INIT_DELAY);
   
@@ -75,13 +113,42 @@ bool LoRaModule::checkReady() {
   return true;
 }
 
-bool LoRaModule::sendMessage(const String& message) {
-  if (message.length() == 0) return false;
+size_t LoRaModule::toWire(const uint8_t* data, size_t length, const uint8_t*& wire) {
+  if (!Config::Protocol::COBS_FRAMING) {
+    wire = data;
+    return length;
+  }
+  wire = wireBuffer;
+  return encodeSyncFrame(wireBuffer, sizeof(wireBuffer), data, length);
+}
+
+bool LoRaModule::sendMessage(const uint8_t* data, size_t length) {
+  if (length == 0 || length > 255) return false;
   
-  ResponseStatus rs = e32.sendMessage(message);
+  const uint8_t* wire;
+  size_t wireLength = toWire(data, length, wire);
+  if (wireLength == 0) return false;
+  
+  noInterrupts();
+  uint16_t riseCount = auxRiseCount;
+  interrupts();
+  
+  lastSendBytes = wireLength;
+  sendAirStartValid = false;
+  ResponseStatus rs = e32.sendMessage(wire, (uint8_t)wireLength);
   printStatus("sendMessage", rs);
   
   if (rs.code == E32_SUCCESS) {
+    // Подъем AUX - конец эфира последнего подпакета
+    noInterrupts();
+    uint32_t riseTime = auxRiseTime_us;
+    bool rose = (auxRiseCount != riseCount);
+    interrupts();
+    if (rose) {
+      sendAirStart_us = riseTime - estimateAirtime_us(wireLength);
+      sendAirStartValid = true;
+    }
+    
     digitalWrite(Config::Pins::LED, !digitalRead(Config::Pins::LED));
     return true;
   }
@@ -89,17 +156,162 @@ bool LoRaModule::sendMessage(const String& message) {
   return false;
 }
 
+uint32_t LoRaModule::txAirDelay_us(size_t length) const {
+  // Первый подпакет на UART; неполный уходит после паузы UART
+  size_t bytes = length + FRAMING_OVERHEAD;
+  if (bytes > Config::Protocol::SUBPACKET_SIZE) bytes = Config::Protocol::SUBPACKET_SIZE;
+  if (bytes < Config::Protocol::SUBPACKET_SIZE) bytes += Config::Protocol::IDLE_GAP_BYTES;
+  return (uint32_t)(bytes * 10UL * 1000000UL / Config::Protocol::LORA_BAUD_RATE);
+}
+
+bool LoRaModule::getSendAirStart_us(uint32_t& airStart_us) const {
+  if (!sendAirStartValid) return false;
+  airStart_us = sendAirStart_us;
+  return true;
+}
+
+bool LoRaModule::startSend(const uint8_t* data, size_t length) {
+  if (sendActive) return false;
+  if (digitalRead(Config::Pins::E32_AUX) == LOW) return false;
+  
+  const uint8_t* wire;
+  size_t wireLength = toWire(data, length, wire);
+  if (wireLength == 0 || wireLength > Config::Tx::MAX_FRAME) return false;
+  
+  // Прозрачный режим: байты в UART - это и есть кадр. Запись уходит в TX буфер
+  // драйвера, ожидание AUX (waitCompleteResponse библиотеки) - в pollSend()
+  loraSerial.write(wire, wireLength);
+  
+  sendStart_us = micros();
+  lastSendBytes = wireLength;
+  sendUart_us = (uint32_t)(wireLength * 10UL * 1000000UL / Config::Protocol::LORA_BAUD_RATE);
+  sendSawBusy = false;
+  sendActive = true;
+  return true;
+}
+
+LoRaModule::SendState LoRaModule::pollSend() {
+  if (!sendActive) return SEND_IDLE;
+  
+  uint32_t elapsed = micros() - sendStart_us;
+  
+  if (digitalRead(Config::Pins::E32_AUX) == LOW) {
+    sendSawBusy = true;
+    if (elapsed < Config::Tx::SEND_TIMEOUT_MS * 1000UL) return SEND_BUSY;
+    sendActive = false;
+    return SEND_TIMEOUT;
+  }
+  
+  // AUX HIGH сразу после записи - модуль еще не получил байты с UART
+  if (!sendSawBusy && elapsed < sendUart_us + Config::Timing::AUX_SETTLE_US) return SEND_BUSY;
+  
+  sendActive = false;
+  return SEND_DONE;
+}
+
 int LoRaModule::available() {
   return loraSerial.available();
 }
 
 char LoRaModule::read() {
-  return loraSerial.read();
+  uint32_t now = micros();
+  
+  if (frameTiming.byteCount == 0) {
+    frameTiming.firstByte_us = now;
+    
+    // Спад AUX перед первым байтом - аппаратное начало кадра
+    noInterrupts();
+    uint32_t fallTime = auxFallTime_us;
+    uint16_t fallCount = auxFallCount;
+    interrupts();
+    
+    if (fallCount != lastAuxFallCount &&
+        now - fallTime <= Config::Timing::AUX_FRAME_WINDOW_US) {
+      frameTiming.auxFall_us = fallTime;
+      frameTiming.auxValid = true;
+    }
+    lastAuxFallCount = fallCount;
+  }
+  
+  frameTiming.lastByte_us = now;
+  frameTiming.byteCount++;
+  
+  uint8_t b = (uint8_t)loraSerial.read();
+  if (rxCapture.isActive()) captureRead(b, now);
+  return (char)b;
+}
+
+// Байт и спады AUX с прошлого чтения - в запись приема (rx_capture.h)
+void LoRaModule::captureRead(uint8_t b, uint32_t now) {
+  noInterrupts();
+  uint32_t fallTime = auxFallTime_us;
+  uint16_t fallCount = auxFallCount;
+  interrupts();
+  
+  if (fallCount != captureAuxCount) {
+    captureAuxCount = fallCount;
+    rxCapture.recordAux(fallTime);
+  }
+  rxCapture.recordByte(b, now);
+}
+
+void LoRaModule::enableRxTimestamps() {
+  attachInterrupt(digitalPinToInterrupt(Config::Pins::E32_AUX), onAuxChange, CHANGE);
+  Serial.print("RX timestamps: AUX edges on GPIO");
+  Serial.println(Config::Pins::E32_AUX);
+}
+
+RxFrameTiming LoRaModule::takeFrameTiming(const PacketParser& parser) {
+  RxFrameTiming timing = frameTiming;
+  timing.batchBytes = parser.batchBytes();
+  
+  // Внутри пакета метки не сбрасываются: следующие кадры пакета получают
+  // то же начало (спад AUX / первый байт пакета)
+  if (!parser.inBatch()) frameTiming = RxFrameTiming();
+  return timing;
+}
+
+bool LoRaModule::batchAppend(const uint8_t* data, size_t length) {
+  if (length == 0 || !batchFits(length)) return false;
+  memcpy(batchBuffer + BATCH_PREFIX_SIZE + batchLen, data, length);
+  batchLen += length;
+  batchFrames++;
+  return true;
+}
+
+bool LoRaModule::batchFits(size_t length) const {
+  // Один кадр уходит без заголовка пакета - ему доступен весь MAX_FRAME
+  if (batchFrames == 0) return length + FRAMING_OVERHEAD <= Config::Tx::MAX_FRAME;
+  return BATCH_PREFIX_SIZE + batchLen + length + FRAMING_OVERHEAD <= Config::Tx::BATCH_MAX_BYTES;
+}
+
+bool LoRaModule::flushBatch() {
+  if (batchFrames == 0) return false;
+  
+  bool started;
+  if (batchFrames == 1) {
+    started = startSend(batchBuffer + BATCH_PREFIX_SIZE, batchLen);
+  } else {
+    batchBuffer[0] = BATCH_FRAME_MAGIC;
+    batchBuffer[1] = (uint8_t)batchLen;
+    started = startSend(batchBuffer, BATCH_PREFIX_SIZE + batchLen);
+  }
+  
+  if (started) {
+    batchLen = 0;
+    batchFrames = 0;
+  }
+  return started;
 }
 
 void LoRaModule::printStatus(const char* tag, ResponseStatus& st) {
   Serial.print(tag);
   Serial.print(": code=");
+  // Описание - String библиотеки E32: только для ошибок, успешная отправка без кучи
+  if (st.code == E32_SUCCESS) {
+    Serial.println(st.code);
+    return;
+  }
   Serial.print(st.code);
   Serial.print(" desc=");
   Serial.println(st.getResponseDescription());
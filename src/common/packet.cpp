@@ -1,48 +1,970 @@
 #include "packet.h"
+#include "config.h"
 
 static uint32_t packetCounter = 0;
+static uint16_t localTagId = Config::Tag::ID;
 
-String generateEUID() {
+void setLocalTagId(uint16_t tagId) {
+  localTagId = tagId;
+}
+
+uint16_t getLocalTagId() {
+  return localTagId;
+}
+
+static const uint8_t BINARY_BODY_FIXED = BINARY_HEADER_SIZE - BINARY_PREFIX_SIZE;
+static const uint8_t TAGGED_BODY_FIXED = BINARY_TAGGED_HEADER_SIZE - BINARY_PREFIX_SIZE;
+
+static inline bool isTerminator(uint8_t b) {
+  return b == '\n' || b == '\r';
+}
+
+static inline bool isDecimalDigit(uint8_t b) {
+  return b >= '0' && b <= '9';
+}
+
+// Десятичная запись без snprintf, возвращает число записанных символов
+static size_t formatU32(char* dst, uint32_t value) {
+  char tmp[10];
+  size_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = tmp[n - 1 - i];
+  }
+  return n;
+}
+
+// ===== Текстовый кадр =====
+
+// Теги полей текстового кадра - во flash (PROGMEM), читаются pgm_read_byte
+static const char TAG_EUID[] PROGMEM = "EUID:";
+static const char TAG_MSG[]  PROGMEM = "MSG:";
+static const char TAG_TIME[] PROGMEM = ",TIME:";
+static const char TAG_SEQ[]  PROGMEM = "SEQ:";
+static const char TAG_TAGID[] PROGMEM = "TAG:";
+static const char TAG_CRC[]  PROGMEM = "CRC:";
+
+static const uint8_t TAG_EUID_LEN = sizeof(TAG_EUID) - 1;
+static const uint8_t TAG_MSG_LEN  = sizeof(TAG_MSG) - 1;
+static const uint8_t TAG_TIME_LEN = sizeof(TAG_TIME) - 1;
+static const uint8_t TAG_SEQ_LEN  = sizeof(TAG_SEQ) - 1;
+static const uint8_t TAG_TAGID_LEN = sizeof(TAG_TAGID) - 1;
+static const uint8_t TAG_CRC_LEN  = sizeof(TAG_CRC) - 1;
+static const uint8_t TEXT_CRC_DIGITS = 4;
+
+// CRC текстового кадра начинается с тега, который парсер уже сопоставил
+static const uint16_t TEXT_CRC_START = crc16Const("EUID:");
+
+static inline uint8_t tagByte(const char* tag, uint8_t pos) {
+  return pgm_read_byte(tag + pos);
+}
+
+static inline char hexDigit(uint8_t v) {
+  return (char)(v < 10 ? '0' + v : 'A' + v - 10);
+}
+
+// Значение hex-цифры (верхний регистр), 0xFF - не цифра
+static inline uint8_t hexValue(uint8_t b) {
+  if (isDecimalDigit(b)) return b - '0';
+  if (b >= 'A' && b <= 'F') return b - 'A' + 10;
+  return 0xFF;
+}
+
+// Запись текстового кадра в буфер фиксированного размера, без кучи:
+// после переполнения ничего не пишет, length() - 0. CRC - по ходу записи.
+class TextFrameWriter {
+public:
+  TextFrameWriter(uint8_t* out, size_t outSize)
+    : out(out), size(outSize), len(0), crc(CRC16_INIT), overflow(false) {}
+  
+  void put(char c) {
+    if (len >= size) {
+      overflow = true;
+      return;
+    }
+    out[len++] = (uint8_t)c;
+    crc = crc16Update(crc, (uint8_t)c);
+  }
+  
+  void putTag(const char* tag, uint8_t tagLen) {
+    for (uint8_t i = 0; i < tagLen; i++) put((char)tagByte(tag, i));
+  }
+  
+  void putString(const char* str) {
+    while (*str) put(*str++);
+  }
+  
+  void putDecimal(uint32_t value) {
+    char digits[10];
+    size_t n = formatU32(digits, value);
+    for (size_t i = 0; i < n; i++) put(digits[i]);
+  }
+  
+  // ",CRC:XXXX" от всего записанного
+  void putCrc() {
+    uint16_t value = crc;
+    put(',');
+    putTag(TAG_CRC, TAG_CRC_LEN);
+    for (int8_t shift = 12; shift >= 0; shift -= 4) put(hexDigit((value >> shift) & 0x0F));
+  }
+  
+  size_t length() const { return overflow ? 0 : len; }
+  
+private:
+  uint8_t* out;
+  size_t size;
+  size_t len;
+  uint16_t crc;
+  bool overflow;
+};
+
+size_t generateEUID(char* out, size_t outSize) {
   // Формат: COUNTER_MICROS (например: 123_4567890)
+  if (outSize < PACKET_EUID_SIZE) return 0;
   uint32_t us = micros();
-  return String(packetCounter++) + "_" + String(us);
+  size_t n = formatU32(out, packetCounter++);
+  out[n++] = '_';
+  n += formatU32(out + n, us);
+  out[n] = '\0';
+  return n;
 }
 
-String buildPacket(const String& message, uint32_t sequence) {
-  String euid = generateEUID();
+size_t buildPacket(uint8_t* out, size_t outSize, const char* message, uint32_t sequence) {
+  char euid[PACKET_EUID_SIZE];
+  generateEUID(euid, sizeof(euid));
   uint32_t timestamp_us = micros();
   
-  // Формат: EUID:<id>,MSG:<message>,TIME:<us>,SEQ:<seq>
-  String packet = "EUID:" + euid + 
-                  ",MSG:" + message + 
-                  ",TIME:" + String(timestamp_us) +
-                  ",SEQ:" + String(sequence);
+  // Формат: EUID:<id>,MSG:<message>,TIME:<us>,SEQ:<seq>[,TAG:<tag>][,CRC:<crc>]\n
+  TextFrameWriter frame(out, outSize);
+  frame.putTag(TAG_EUID, TAG_EUID_LEN);
+  frame.putString(euid);
+  frame.put(',');
+  frame.putTag(TAG_MSG, TAG_MSG_LEN);
+  frame.putString(message);
+  frame.putTag(TAG_TIME, TAG_TIME_LEN);
+  frame.putDecimal(timestamp_us);
+  frame.put(',');
+  frame.putTag(TAG_SEQ, TAG_SEQ_LEN);
+  frame.putDecimal(sequence);
+  if (localTagId) {
+    frame.put(',');
+    frame.putTag(TAG_TAGID, TAG_TAGID_LEN);
+    frame.putDecimal(localTagId);
+  }
+  if (Config::Protocol::FRAME_CRC) frame.putCrc();
+  frame.put('\n');  // Терминатор для RX
+  
+  return frame.length();
+}
+
+static void putU16(uint8_t* dst, uint16_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t* dst, uint32_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+  dst[2] = (uint8_t)(v >> 16);
+  dst[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* src) {
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+         ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// ZigZag: малые по модулю знаковые дельты -> малые беззнаковые
+static inline uint32_t zigzagEncode(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t u) {
+  return (int32_t)((u >> 1) ^ (0u - (u & 1)));
+}
+
+// Varint: по 7 бит, старший бит - продолжение (LEB128), до 5 байт на uint32
+static uint8_t varintSize(uint32_t v) {
+  uint8_t n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+static uint8_t putVarint(uint8_t* dst, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    dst[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  dst[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool getVarint(const uint8_t* src, size_t len, size_t& pos, uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35 && pos < len; shift += 7) {
+    uint8_t b = src[pos++];
+    value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// ===== Потоковый парсер =====
+
+PacketParser::PacketParser()
+  : framesOk(0), framesError(0), crcErrors(0), crcRejected(false),
+    syncFraming(Config::Protocol::COBS_FRAMING), syncTail(false), syncErrors(0),
+    deltaRefNext(0), deltaMisses(0), batchRemaining(0),
+    batchTotal(0), batchNext(0), frameBatchBytes(0), frameBatchIndex(0) {
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) deltaRefs[i].used = false;
+  reset();
+}
+
+void PacketParser::reset() {
+  state = SEEK;
+  tagPos = 0;
+  fieldLen = 0;
+  bodyLen = 0;
+  frameBytes = 0;
+  binEuid = 0;
+  binTagged = false;
+  binCrc = false;
+  crc = CRC16_INIT;
+  rxCrc = 0;
+  deltaFrame = false;
+}
+
+void PacketParser::beginFrame() {
+  current.euid[0] = '\0';
+  current.message[0] = '\0';
+  current.txTime_us = 0;
+  current.sequence = 0;
+  current.tagId = 0;
+  current.valid = false;
+  fieldLen = 0;
+  tagPos = 0;
+}
+
+PacketParser::Result PacketParser::fail() {
+  framesError++;
+  crcRejected = false;
+  current.valid = false;
+  state = SKIP;
+  return FRAME_ERROR;
+}
+
+PacketParser::Result PacketParser::failCrc() {
+  Result r = fail();
+  crcErrors++;
+  crcRejected = true;
+  return r;
+}
+
+PacketParser::Result PacketParser::complete() {
+  current.valid = true;
+  framesOk++;
+  
+  bool batched = batchRemaining > 0 || batchTotal > 0;
+  frameBatchBytes = batched ? batchTotal : 0;
+  frameBatchIndex = batched ? batchNext++ : 0;
+  
+  reset();
+  return FRAME_OK;
+}
+
+// Кадр завершен без CRC: принимается, только если CRC не обязателен
+PacketParser::Result PacketParser::completeUnchecked() {
+  if (!Config::Protocol::REQUIRE_CRC) return complete();
+  Result r = failCrc();
+  reset();  // Кадр кончился - терминатор ждать не нужно
+  return r;
+}
+
+bool PacketParser::appendMessage(char c) {
+  if (fieldLen >= PACKET_MESSAGE_SIZE - 1) return false;
+  current.message[fieldLen++] = c;
+  return true;
+}
+
+PacketParser::Result PacketParser::feed(uint8_t b) {
+  if (!syncFraming) return feedPayload(b);
+  if (!cobs.isActive()) {
+    // Вне кадра COBS - кадр старой прошивки; ноль в его бинарном теле - данные.
+    // За испорченным кадром COBS это скорее его хвост - ноль снова синхрослово
+    if (b == FRAME_SYNC && (syncTail || !inUnframedBinary())) return startSyncFrame();
+    Result r = feedPayload(b);
+    if (r != NEED_MORE) syncTail = false;
+    return r;
+  }
+  if (b == FRAME_SYNC) return startSyncFrame();
+  
+  uint8_t value;
+  CobsDecoder::Result c = cobs.decode(b, value);
+  if (c == CobsDecoder::COBS_NONE) return NEED_MORE;
+  if (c == CobsDecoder::COBS_ERROR) {
+    framesError++;
+    syncErrors++;
+    crcRejected = false;
+    syncTail = true;
+    return FRAME_ERROR;
+  }
+  
+  Result r = feedPayload(value);
+  if (cobs.isActive()) return r;
+  
+  // Последний байт по длине; кадр не разобран - длина могла быть искажена
+  r = endOfData(r);
+  syncTail = (r != FRAME_OK);
+  return r;
+}
+
+PacketParser::Result PacketParser::startSyncFrame() {
+  Result r = NEED_MORE;
+  
+  // Предыдущий кадр не дошел до конца (повторное синхрослово без длины - не кадр)
+  if (cobs.isActive() && cobs.hasLength() && state != SKIP) {
+    r = fail();
+    syncErrors++;
+  } else if (!cobs.isActive() && state != SEEK && state != SKIP) {
+    r = fail();  // Текстовый кадр без синхрослова оборван
+  }
+  
+  reset();
+  batchRemaining = 0;
+  batchTotal = 0;
+  syncTail = false;
+  cobs.start();
+  return r;
+}
+
+// Кадр COBS кончился по длине: незавершенный внутри кадр обрезан
+PacketParser::Result PacketParser::endOfData(Result r) {
+  if (r == NEED_MORE && (state != SEEK || frameBytes > 0 || batchRemaining > 0)) {
+    if (state != SKIP) {
+      r = fail();
+      syncErrors++;
+    }
+    reset();
+    batchRemaining = 0;
+  }
+  return r;
+}
+
+PacketParser::Result PacketParser::feedPayload(uint8_t b) {
+  if (batchRemaining == 0) {
+    batchTotal = 0;  // Вне пакета
+    return feedFrame(b);
+  }
+  
+  batchRemaining--;
+  Result r = feedFrame(b);
   
-  return packet;
+  // Пакет кончился посреди кадра - кадр обрезан
+  if (batchRemaining == 0 && r == NEED_MORE && (state != SEEK || frameBytes > 0)) {
+    r = (state == SKIP) ? NEED_MORE : fail();
+    reset();
+  }
+  return r;
 }
 
-PacketData parsePacket(const String& rawData) {
-  PacketData data;
-  data.valid = false;
+PacketParser::Result PacketParser::feedFrame(uint8_t b) {
+  bool text = state >= EUID_VALUE && state <= CRC_VALUE;
   
-  int euidStart = rawData.indexOf("EUID:");
-  int msgStart = rawData.indexOf(",MSG:");
-  int timeStart = rawData.indexOf(",TIME:");
-  int seqStart = rawData.indexOf(",SEQ:");
+  // Терминатор внутри текстового кадра - кадр не завершен, сразу к поиску
+  if (isTerminator(b) && text && state != SEQ_VALUE && state != TAGID_VALUE && state != CRC_VALUE) {
+    Result r = fail();
+    reset();
+    return r;
+  }
+  
+  // CRC текста - до последнего байта поля перед ",CRC:"; запятую после SEQ/TAG
+  // добавляет FIELD_TAG, когда следом идет не CRC
+  if (text && state < FIELD_TAG && !(b == ',' && (state == SEQ_VALUE || state == TAGID_VALUE))) {
+    crc = crc16Update(crc, b);
+  }
   
-  if (euidStart != -1 && msgStart != -1 && timeStart != -1 && seqStart != -1) {
-    data.euid = rawData.substring(euidStart + 5, msgStart);
-    data.message = rawData.substring(msgStart + 5, timeStart);
+  switch (state) {
+    case SEEK:
+      if (isTerminator(b)) {
+        // Пустые строки (\r\n) пропускаем, непустой мусор считаем ошибкой
+        bool garbage = frameBytes > 0;
+        reset();
+        if (garbage) {
+          framesError++;
+          return FRAME_ERROR;
+        }
+        return NEED_MORE;
+      }
+      
+      // Бинарный маркер: в тексте байтов 0xB_ вне UTF-8 сообщений нет
+      if (tagPos == 0) {
+        uint8_t magic = b & ~BINARY_CRC_FLAG;
+        if (magic == (BINARY_FRAME_MAGIC | BINARY_WIRE_VERSION) ||
+            magic == (BINARY_FRAME_MAGIC | BINARY_DELTA_VERSION) ||
+            magic == (BINARY_FRAME_MAGIC | BINARY_TAGGED_VERSION)) {
+          beginFrame();
+          state = BIN_LEN;
+          frameBytes = 1;
+          deltaFrame = (magic == (BINARY_FRAME_MAGIC | BINARY_DELTA_VERSION));
+          binTagged = (magic == (BINARY_FRAME_MAGIC | BINARY_TAGGED_VERSION));
+          binCrc = (b & BINARY_CRC_FLAG) != 0;
+          crc = crc16Update(CRC16_INIT, b);
+          return NEED_MORE;
+        }
+      }
+      
+      // Пакет кадров (вложенные пакеты не допускаются - байт считается мусором)
+      if (tagPos == 0 && frameBytes == 0 && b == BATCH_FRAME_MAGIC && batchRemaining == 0) {
+        state = BATCH_LEN;
+        return NEED_MORE;
+      }
+      
+      frameBytes++;
+      if (b == tagByte(TAG_EUID, tagPos)) {
+        if (++tagPos == TAG_EUID_LEN) {
+          beginFrame();
+          state = EUID_VALUE;
+          crc = TEXT_CRC_START;
+        }
+      } else {
+        tagPos = (b == tagByte(TAG_EUID, 0)) ? 1 : 0;
+      }
+      return NEED_MORE;
+    
+    case EUID_VALUE:
+      if (b == ',') {
+        if (fieldLen == 0) return fail();
+        current.euid[fieldLen] = '\0';
+        state = MSG_TAG;
+        tagPos = 0;
+      } else {
+        if (fieldLen >= PACKET_EUID_SIZE - 1) return fail();
+        current.euid[fieldLen++] = (char)b;
+      }
+      return NEED_MORE;
+    
+    case MSG_TAG:
+      if (b != tagByte(TAG_MSG, tagPos)) return fail();
+      if (++tagPos == TAG_MSG_LEN) {
+        state = MSG_VALUE;
+        fieldLen = 0;
+        tagPos = 0;
+      }
+      return NEED_MORE;
+    
+    case MSG_VALUE:
+      // Символы возможного ",TIME:" не пишем в сообщение, пока тег не сорвется
+      if (b == tagByte(TAG_TIME, tagPos)) {
+        if (++tagPos == TAG_TIME_LEN) {
+          current.message[fieldLen] = '\0';
+          state = TIME_VALUE;
+          fieldLen = 0;
+          tagPos = 0;
+        }
+        return NEED_MORE;
+      }
+      
+      for (uint8_t i = 0; i < tagPos; i++) {
+        if (!appendMessage((char)tagByte(TAG_TIME, i))) return fail();
+      }
+      tagPos = 0;
+      
+      if (b == tagByte(TAG_TIME, 0)) {
+        tagPos = 1;
+      } else if (!appendMessage((char)b)) {
+        return fail();
+      }
+      return NEED_MORE;
+    
+    case TIME_VALUE:
+      if (isDecimalDigit(b)) {
+        current.txTime_us = current.txTime_us * 10 + (b - '0');
+        fieldLen++;
+      } else if (b == ',' && fieldLen > 0) {
+        state = SEQ_TAG;
+        tagPos = 0;
+      } else {
+        return fail();
+      }
+      return NEED_MORE;
+    
+    case SEQ_TAG:
+      if (b != tagByte(TAG_SEQ, tagPos)) return fail();
+      if (++tagPos == TAG_SEQ_LEN) {
+        state = SEQ_VALUE;
+        fieldLen = 0;
+        tagPos = 0;
+      }
+      return NEED_MORE;
+    
+    case SEQ_VALUE:
+      if (isDecimalDigit(b)) {
+        current.sequence = current.sequence * 10 + (b - '0');
+        fieldLen++;
+        return NEED_MORE;
+      }
+      if (isTerminator(b) && fieldLen > 0) {
+        return completeUnchecked();
+      }
+      if (b == ',' && fieldLen > 0) {
+        state = FIELD_TAG;
+        return NEED_MORE;
+      }
+      {
+        Result r = fail();
+        if (isTerminator(b)) reset();
+        return r;
+      }
+    
+    case TAGID_TAG:
+      if (b != tagByte(TAG_TAGID, tagPos)) return fail();
+      if (++tagPos == TAG_TAGID_LEN) {
+        state = TAGID_VALUE;
+        current.tagId = 0;
+        fieldLen = 0;
+        tagPos = 0;
+      }
+      return NEED_MORE;
+    
+    case TAGID_VALUE:
+      if (isDecimalDigit(b)) {
+        uint32_t tag = current.tagId * 10UL + (b - '0');
+        if (tag > Config::Tag::MAX_ID) return fail();
+        current.tagId = (uint16_t)tag;
+        fieldLen++;
+        return NEED_MORE;
+      }
+      if (isTerminator(b) && fieldLen > 0) {
+        return completeUnchecked();
+      }
+      if (b == ',' && fieldLen > 0) {
+        state = FIELD_TAG;
+        return NEED_MORE;
+      }
+      {
+        Result r = fail();
+        if (isTerminator(b)) reset();
+        return r;
+      }
+    
+    case FIELD_TAG:
+      if (b == tagByte(TAG_CRC, 0)) {
+        state = CRC_TAG;
+      } else if (b == tagByte(TAG_TAGID, 0)) {
+        crc = crc16Update(crc16Update(crc, ','), b);
+        state = TAGID_TAG;
+      } else {
+        return fail();
+      }
+      tagPos = 1;
+      return NEED_MORE;
     
-    String timeStr = rawData.substring(timeStart + 6, seqStart);
-    String seqStr = rawData.substring(seqStart + 5);
+    case CRC_TAG:
+      if (b != tagByte(TAG_CRC, tagPos)) return fail();
+      if (++tagPos == TAG_CRC_LEN) {
+        state = CRC_VALUE;
+        fieldLen = 0;
+        tagPos = 0;
+      }
+      return NEED_MORE;
     
-    data.txTime_us = timeStr.toInt();
-    data.sequence = seqStr.toInt();
-    data.valid = true;
+    case CRC_VALUE:
+      if (fieldLen < TEXT_CRC_DIGITS && hexValue(b) != 0xFF) {
+        rxCrc = (uint16_t)(rxCrc << 4) | hexValue(b);
+        fieldLen++;
+        return NEED_MORE;
+      }
+      if (isTerminator(b) && fieldLen == TEXT_CRC_DIGITS) {
+        if (rxCrc == crc) return complete();
+        Result r = failCrc();
+        reset();
+        return r;
+      }
+      {
+        Result r = fail();
+        if (isTerminator(b)) reset();
+        return r;
+      }
+    
+    case BIN_LEN: {
+      frameBytes++;
+      crc = crc16Update(crc, b);
+      uint8_t fixed = binTagged ? TAGGED_BODY_FIXED : BINARY_BODY_FIXED;
+      if (deltaFrame ? (b == 0 || b > DELTA_MAX_BODY)
+                     : (b < fixed || b - fixed > (int)(PACKET_MESSAGE_SIZE - 1))) {
+        Result r = fail();
+        reset();  // В бинарном потоке нет терминатора, ищем следующий маркер
+        return r;
+      }
+      bodyLen = b;
+      fieldLen = 0;
+      binEuid = 0;
+      state = BIN_BODY;
+      return NEED_MORE;
+    }
+    
+    case BIN_BODY: {
+      frameBytes++;
+      crc = crc16Update(crc, b);
+      uint16_t off = fieldLen++;
+      
+      if (deltaFrame) {
+        deltaBody[off] = b;
+      } else if (binTagged && off < 2) {
+        // v3: tag перед полями v1 (тело не короче TAGGED_BODY_FIXED)
+        current.tagId |= (uint16_t)b << (8 * off);
+      } else {
+        if (binTagged) off -= 2;
+        if (off < 4) {
+          binEuid |= (uint32_t)b << (8 * off);
+        } else if (off < 8) {
+          current.txTime_us |= (uint32_t)b << (8 * (off - 4));
+        } else if (off < 12) {
+          current.sequence |= (uint32_t)b << (8 * (off - 8));
+        } else {
+          current.message[off - BINARY_BODY_FIXED] = (char)b;
+        }
+      }
+      
+      if (fieldLen < bodyLen) return NEED_MORE;
+      if (binCrc) {
+        state = BIN_CRC;
+        fieldLen = 0;
+        return NEED_MORE;
+      }
+      return completeBinary(false);
+    }
+    
+    case BIN_CRC:
+      frameBytes++;
+      rxCrc |= (uint16_t)b << (8 * fieldLen++);
+      if (fieldLen < FRAME_CRC_SIZE) return NEED_MORE;
+      if (rxCrc != crc) {
+        Result r = failCrc();
+        reset();  // В бинарном потоке нет терминатора
+        return r;
+      }
+      return completeBinary(true);
+    
+    case BATCH_LEN:
+      if (b == 0) {
+        framesError++;
+        reset();
+        return FRAME_ERROR;
+      }
+      batchRemaining = b;
+      batchTotal = BATCH_PREFIX_SIZE + b + (cobs.isActive() ? FRAME_SYNC_OVERHEAD : 0);
+      batchNext = 0;
+      state = SEEK;
+      return NEED_MORE;
+    
+    case SKIP:
+      if (isTerminator(b)) reset();
+      return NEED_MORE;
+  }
+  
+  return NEED_MORE;
+}
+
+// Бинарный кадр принят целиком (checked - CRC сверен)
+PacketParser::Result PacketParser::completeBinary(bool checked) {
+  // Непроверенный кадр не разбирается: ключевой кадр v2 сдвинул бы точку отсчета
+  if (!checked && Config::Protocol::REQUIRE_CRC) {
+    Result r = failCrc();
+    reset();
+    return r;
+  }
+  
+  if (deltaFrame) {
+    Result r = completeDelta();
+    if (r == FRAME_ERROR) reset();  // В бинарном потоке нет терминатора
+    return r;
+  }
+  
+  current.message[bodyLen - (binTagged ? TAGGED_BODY_FIXED : BINARY_BODY_FIXED)] = '\0';
+  setBinaryEuid(binEuid);
+  return complete();
+}
+
+void PacketParser::setBinaryEuid(uint32_t counter) {
+  // EUID в том же виде, что и в текстовом формате: COUNTER_MICROS
+  size_t n = formatU32(current.euid, counter);
+  current.euid[n++] = '_';
+  n += formatU32(current.euid + n, current.txTime_us);
+  current.euid[n] = '\0';
+}
+
+PacketParser::DeltaRef* PacketParser::findDeltaRef(uint16_t tag, bool create) {
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    if (deltaRefs[i].used && deltaRefs[i].tag == tag) return &deltaRefs[i];
+  }
+  if (!create) return nullptr;
+  
+  // Новый тег: свободная запись или по кругу (вытесненный тег ждет ключевой кадр)
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    if (!deltaRefs[i].used) return &deltaRefs[i];
+  }
+  DeltaRef* ref = &deltaRefs[deltaRefNext];
+  deltaRefNext = (uint8_t)((deltaRefNext + 1) % Config::Tag::MAX_TAGS);
+  return ref;
+}
+
+PacketParser::Result PacketParser::completeDelta() {
+  size_t pos = 0;
+  uint32_t tag;
+  if (!getVarint(deltaBody, bodyLen, pos, tag) || tag > Config::Tag::MAX_ID || pos >= bodyLen) {
+    return fail();
+  }
+  
+  uint8_t hdr = deltaBody[pos++];
+  uint8_t epoch = (hdr >> DELTA_EPOCH_SHIFT) & DELTA_EPOCH_MASK;
+  uint8_t dict = hdr & DELTA_DICT_MASK;
+  bool keyframe = (hdr & DELTA_KEYFRAME_FLAG) != 0;
+  uint32_t euid, time, seq;
+  DeltaRef* ref = findDeltaRef((uint16_t)tag, false);
+  
+  if (keyframe) {
+    if (bodyLen < pos - 1 + DELTA_KEYFRAME_FIXED) return fail();
+    euid = getU32(deltaBody + pos);
+    time = getU32(deltaBody + pos + 4);
+    seq  = getU32(deltaBody + pos + 8);
+    pos += DELTA_KEYFRAME_FIXED - 1;
+  } else {
+    // Ключевой кадр этой эпохи от этого тега не принят - точки отсчета нет
+    if (!ref || epoch != ref->epoch) {
+      deltaMisses++;
+      return fail();
+    }
+    uint32_t de, dt, ds;
+    if (!getVarint(deltaBody, bodyLen, pos, de) ||
+        !getVarint(deltaBody, bodyLen, pos, dt) ||
+        !getVarint(deltaBody, bodyLen, pos, ds)) {
+      return fail();
+    }
+    int32_t skew = zigzagDecode(dt) - (int32_t)(micros() - ref->rx_us);
+    if (skew > (int32_t)DELTA_MAX_SKEW_US || skew < -(int32_t)DELTA_MAX_SKEW_US) {
+      deltaMisses++;
+      return fail();
+    }
+    euid = ref->euid + zigzagDecode(de);
+    time = ref->time + zigzagDecode(dt);
+    seq  = ref->seq + zigzagDecode(ds);
+  }
+  
+  if (dict) {
+    if (dict > DELTA_DICTIONARY_SIZE || pos != bodyLen) return fail();
+    strcpy(current.message, DELTA_DICTIONARY[dict - 1]);
+  } else {
+    size_t len = bodyLen - pos;
+    if (len > PACKET_MESSAGE_SIZE - 1) return fail();
+    memcpy(current.message, deltaBody + pos, len);
+    current.message[len] = '\0';
+  }
+  
+  if (keyframe) {
+    if (!ref) ref = findDeltaRef((uint16_t)tag, true);
+    ref->euid = euid;
+    ref->time = time;
+    ref->seq = seq;
+    ref->rx_us = micros();
+    ref->tag = (uint16_t)tag;
+    ref->epoch = epoch;
+    ref->used = true;
+  }
+  
+  current.txTime_us = time;
+  current.sequence = seq;
+  current.tagId = (uint16_t)tag;
+  setBinaryEuid(euid);
+  return complete();
+}
+
+// ===== Дельта-сжатие =====
+
+const char* const DELTA_DICTIONARY[] = {"BEACON", "PING", "PONG", "SYNC"};
+const uint8_t DELTA_DICTIONARY_SIZE = sizeof(DELTA_DICTIONARY) / sizeof(DELTA_DICTIONARY[0]);
+
+static uint8_t dictionaryIndex(const char* message) {
+  for (uint8_t i = 0; i < DELTA_DICTIONARY_SIZE; i++) {
+    if (strcmp(message, DELTA_DICTIONARY[i]) == 0) return i + 1;
+  }
+  return 0;
+}
+
+size_t deltaFrameSize(uint16_t tagId, const char* message, bool keyframe,
+                      int32_t euidDelta, int32_t timeDelta, int32_t seqDelta) {
+  size_t size = BINARY_PREFIX_SIZE + varintSize(tagId) + 1;
+  if (keyframe) {
+    size += DELTA_KEYFRAME_FIXED - 1;
+  } else {
+    size += varintSize(zigzagEncode(euidDelta)) + varintSize(zigzagEncode(timeDelta)) +
+            varintSize(zigzagEncode(seqDelta));
+  }
+  if (!dictionaryIndex(message)) size += strlen(message);
+  if (Config::Protocol::FRAME_CRC) size += FRAME_CRC_SIZE;
+  return size;
+}
+
+DeltaEncoder::DeltaEncoder()
+  : refEuid(0), refTime(0), refSeq(0), refTag(0), epoch(0), sinceKeyframe(0), hasRef(false) {
+}
+
+size_t DeltaEncoder::encode(uint8_t* out, size_t outSize, const char* message, uint32_t sequence) {
+  uint32_t euid = packetCounter;
+  uint32_t time = micros();
+  uint16_t tag = localTagId;
+  bool keyframe = !hasRef || tag != refTag ||
+                  sinceKeyframe + 1 >= Config::Protocol::DELTA_KEYFRAME_INTERVAL;
+  
+  int32_t de = (int32_t)(euid - refEuid);
+  int32_t dt = (int32_t)(time - refTime);
+  int32_t ds = (int32_t)(sequence - refSeq);
+  
+  size_t size = deltaFrameSize(tag, message, keyframe, de, dt, ds);
+  size_t trailer = Config::Protocol::FRAME_CRC ? FRAME_CRC_SIZE : 0;
+  if (size > outSize || size - BINARY_PREFIX_SIZE - trailer > DELTA_MAX_BODY) return 0;
+  
+  uint8_t frameEpoch = keyframe ? (uint8_t)((epoch + 1) & DELTA_EPOCH_MASK) : epoch;
+  uint8_t dict = dictionaryIndex(message);
+  
+  out[0] = BINARY_FRAME_MAGIC | BINARY_DELTA_VERSION | (trailer ? BINARY_CRC_FLAG : 0);
+  out[1] = (uint8_t)(size - BINARY_PREFIX_SIZE - trailer);
+  size_t pos = BINARY_PREFIX_SIZE + putVarint(out + BINARY_PREFIX_SIZE, tag);
+  out[pos++] = (keyframe ? DELTA_KEYFRAME_FLAG : 0) | (frameEpoch << DELTA_EPOCH_SHIFT) | dict;
+  
+  if (keyframe) {
+    putU32(out + pos, euid);
+    putU32(out + pos + 4, time);
+    putU32(out + pos + 8, sequence);
+    pos += 12;
+  } else {
+    pos += putVarint(out + pos, zigzagEncode(de));
+    pos += putVarint(out + pos, zigzagEncode(dt));
+    pos += putVarint(out + pos, zigzagEncode(ds));
+  }
+  if (!dict) {
+    memcpy(out + pos, message, strlen(message));
+    pos += strlen(message);
+  }
+  if (trailer) putU16(out + pos, crc16(out, pos));
+  
+  // Кадр собран - фиксируем состояние
+  packetCounter++;
+  if (keyframe) {
+    refEuid = euid;
+    refTime = time;
+    refSeq = sequence;
+    refTag = tag;
+    epoch = frameEpoch;
+    sinceKeyframe = 0;
+    hasRef = true;
+  } else {
+    sinceKeyframe++;
+  }
+  return size;
+}
+
+PacketData parsePacket(const char* data, size_t length) {
+  PacketParser parser;
+  // Кадр целиком: синхрослово только если он с него начинается (как encodeSyncFrame)
+  parser.setSyncFraming(length > 0 && (uint8_t)data[0] == FRAME_SYNC);
+  
+  for (size_t i = 0; i < length; i++) {
+    if (parser.feed((uint8_t)data[i]) == PacketParser::FRAME_OK) {
+      return parser.packet();
+    }
+  }
+  
+  // Текстовый кадр без терминатора (как в старом API)
+  if (parser.feed('\n') == PacketParser::FRAME_OK) {
+    return parser.packet();
+  }
+  
+  return PacketData();
+}
+
+size_t encodeBinaryPacket(uint8_t* out, size_t outSize, const char* message, uint32_t sequence) {
+  return encodeBinaryPacketAt(out, outSize, message, sequence, micros());
+}
+
+size_t encodeBinaryPacketAt(uint8_t* out, size_t outSize, const char* message, uint32_t sequence,
+                            uint32_t timestamp_us) {
+  size_t header = binaryHeaderSize(localTagId);
+  size_t messageLen = strlen(message);
+  size_t bodyLen = (header - BINARY_PREFIX_SIZE) + messageLen;
+  size_t trailer = Config::Protocol::FRAME_CRC ? FRAME_CRC_SIZE : 0;
+  if (bodyLen > 255 || BINARY_PREFIX_SIZE + bodyLen + trailer > outSize) {
+    return 0;
+  }
+  
+  // v3: раскладка v1 с ID тега после длины
+  uint8_t* fields = out + BINARY_PREFIX_SIZE;
+  out[0] = BINARY_FRAME_MAGIC | (localTagId ? BINARY_TAGGED_VERSION : BINARY_WIRE_VERSION) |
+           (trailer ? BINARY_CRC_FLAG : 0);
+  out[1] = (uint8_t)bodyLen;
+  if (localTagId) {
+    fields[0] = (uint8_t)localTagId;
+    fields[1] = (uint8_t)(localTagId >> 8);
+    fields += 2;
+  }
+  putU32(fields, packetCounter++);
+  putU32(fields + 4, timestamp_us);
+  putU32(fields + 8, sequence);
+  memcpy(out + header, message, messageLen);
+  if (trailer) putU16(out + BINARY_PREFIX_SIZE + bodyLen, crc16(out, BINARY_PREFIX_SIZE + bodyLen));
+  
+  return BINARY_PREFIX_SIZE + bodyLen + trailer;
+}
+
+PacketData decodeBinaryPacket(const uint8_t* frame, size_t length) {
+  if (length < BINARY_HEADER_SIZE) return PacketData();
+  uint8_t magic = frame[0] & ~BINARY_CRC_FLAG;
+  if (magic != (BINARY_FRAME_MAGIC | BINARY_WIRE_VERSION) &&
+      magic != (BINARY_FRAME_MAGIC | BINARY_TAGGED_VERSION)) return PacketData();
+  size_t trailer = (frame[0] & BINARY_CRC_FLAG) ? FRAME_CRC_SIZE : 0;
+  if ((size_t)frame[1] + BINARY_PREFIX_SIZE + trailer != length) return PacketData();
+  
+  return parsePacket((const char*)frame, length);
+}
+
+// Разбор десятичного uint32, указатель сдвигается за последнюю цифру
+static bool parseU32(const char*& p, uint32_t& value) {
+  uint32_t v = 0;
+  const char* start = p;
+  
+  while (isDecimalDigit((uint8_t)*p)) {
+    uint32_t next = v * 10 + (uint32_t)(*p - '0');
+    if (next / 10 != v) return false;  // Переполнение
+    v = next;
+    p++;
+  }
+  
+  value = v;
+  return p != start;
+}
+
+uint64_t euidToKey(const char* euid) {
+  const char* p = euid;
+  uint32_t counter, us;
+  
+  if (parseU32(p, counter) && *p == '_' && parseU32(++p, us) && *p == '\0') {
+    return ((uint64_t)counter << 32) | us;
   }
   
-  return data;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (p = euid; *p; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
 }
 
 RxStats calculateRxStats(const PacketData& packet, uint32_t rxTime_us) {
@@ -60,3 +982,14 @@ RxStats calculateRxStats(const PacketData& packet, uint32_t rxTime_us) {
   
   return stats;
 }
+
+RxStats calculateRxStats(const PacketData& packet, const RxFrameTiming& timing) {
+  RxStats stats = calculateRxStats(packet, timing.start_us());
+  stats.rxEnd_us = timing.lastByte_us;
+  
+  // Спад AUX и первый байт на UART - после приема первого подпакета из эфира,
+  // поэтому начало кадра смещено на его airtime (зависит от длины до 58 байт)
+  stats.airtime_us = estimateRxLead_us(timing.airBytes());
+  
+  return stats;
+}
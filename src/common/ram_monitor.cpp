@@ -0,0 +1,103 @@
+#include "ram_monitor.h"
+
+RamMonitor ramMonitor;
+
+RamMonitor::RamMonitor() : paintEnd(nullptr) {
+}
+
+#ifdef PLATFORM_MEGA2560
+
+extern char __heap_start;
+extern char* __brkval;
+
+static const uint8_t PAINT_BYTE = 0xA5;
+static const uint8_t STACK_GUARD = 32;  // Кадр begin() и прерывания под SP
+
+static uint8_t* heapEnd() {
+  return __brkval ? (uint8_t*)__brkval : (uint8_t*)&__heap_start;
+}
+
+void RamMonitor::begin() {
+  uint8_t* p = heapEnd();
+  paintEnd = (uint8_t*)(uintptr_t)SP - STACK_GUARD;
+  while (p < paintEnd) *p++ = PAINT_BYTE;
+}
+
+uint32_t RamMonitor::getFreeNow() const {
+  uint8_t top;
+  return (uint32_t)(&top - heapEnd());
+}
+
+uint32_t RamMonitor::getMinFree() const {
+  // Первый затертый байт снизу; стековые данные, равные шаблону, дают
+  // завышение на несколько байт
+  const uint8_t* p = heapEnd();
+  uint32_t untouched = 0;
+  while (p < paintEnd && *p == PAINT_BYTE) {
+    p++;
+    untouched++;
+  }
+  return untouched;
+}
+
+uint32_t RamMonitor::getHeapUsed() const {
+  return __brkval ? (uint32_t)(__brkval - &__heap_start) : 0;
+}
+
+void RamMonitor::printReport(Print& out) const {
+  out.print("RAM: free ");
+  out.print(getFreeNow());
+  out.print(" B, min free ");
+  out.print(getMinFree());
+  out.print(" B of ");
+  out.print((uint32_t)((uint8_t*)RAMEND + 1 - (uint8_t*)&__heap_start));
+  out.print(" B after .data/.bss, heap ");
+  if (getHeapUsed() == 0) {
+    out.println("unused");
+  } else {
+    out.print(getHeapUsed());
+    out.println(" B (malloc was called)");
+  }
+}
+
+#elif defined(PLATFORM_ESP32)
+
+void RamMonitor::begin() {
+}
+
+uint32_t RamMonitor::getFreeNow() const {
+  return ESP.getFreeHeap();
+}
+
+uint32_t RamMonitor::getMinFree() const {
+  return ESP.getMinFreeHeap();
+}
+
+uint32_t RamMonitor::getHeapUsed() const {
+  return ESP.getHeapSize() - ESP.getFreeHeap();
+}
+
+void RamMonitor::printReport(Print& out) const {
+  out.print("RAM: heap free ");
+  out.print(getFreeNow());
+  out.print(" B, min free ");
+  out.print(getMinFree());
+  out.print(" B, loop stack headroom ");
+  out.print((uint32_t)uxTaskGetStackHighWaterMark(NULL));
+  out.println(" B");
+}
+
+#else
+
+void RamMonitor::begin() {
+}
+
+uint32_t RamMonitor::getFreeNow() const { return 0; }
+uint32_t RamMonitor::getMinFree() const { return 0; }
+uint32_t RamMonitor::getHeapUsed() const { return 0; }
+
+void RamMonitor::printReport(Print& out) const {
+  out.println("RAM: n/a (host)");
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "rx_capture.h"
+
+RxCapture rxCapture;
+
+static_assert(Config::Capture::CHUNK_SIZE <= CAPTURE_MAX_RECORD &&
+              Config::Capture::CHUNK_SIZE >= CAPTURE_CHUNK_PREFIX + CAPTURE_MAX_EVENT + CAPTURE_CRC_SIZE,
+              "Capture::CHUNK_SIZE out of range");
+
+RxCapture::RxCapture()
+  : requested(false), active(false), length(0), sequence(0), lastEvent_us(0),
+    chunkStart_ms(0), bytesCaptured(0), sent(0), dropped(0) {}
+
+void RxCapture::begin(uint8_t anchorId, float anchorX, float anchorY) {
+  node.anchorId = anchorId;
+  node.x = anchorX;
+  node.y = anchorY;
+  node.flags = captureBuildFlags();
+  node.loraBaud = Config::Protocol::LORA_BAUD_RATE;
+}
+
+void RxCapture::recordAux(uint32_t fall_us) {
+  recordEvent(fall_us, true, 0);
+}
+
+void RxCapture::recordByte(uint8_t b, uint32_t read_us) {
+  recordEvent(read_us, false, b);
+  bytesCaptured++;
+}
+
+void RxCapture::recordEvent(uint32_t time_us, bool aux, uint8_t data) {
+  if (length + CAPTURE_MAX_EVENT + CAPTURE_CRC_SIZE > sizeof(record)) flush();
+  
+  if (length == 0) {
+    length = beginCaptureChunk(record, node.anchorId, sequence, time_us);
+    lastEvent_us = time_us;
+    chunkStart_ms = millis();
+  }
+  
+  // Метка ISR может опередить чтение предыдущего байта - события не идут назад
+  int32_t dt = (int32_t)(time_us - lastEvent_us);
+  if (dt < 0) dt = 0;
+  lastEvent_us += dt;
+  length += putCaptureEvent(record + length, (uint32_t)dt, aux, data);
+}
+
+void RxCapture::poll() {
+  if (requested != active) {
+    if (requested) {
+      // Новая запись: заголовок, блоки с нуля
+      node.start_us = micros();
+      sequence = 0;
+      length = 0;
+      uint8_t frame[CAPTURE_HEADER_SIZE + FRAME_SYNC_OVERHEAD];
+      write(frame, encodeCaptureHeader(frame, sizeof(frame), node));
+      active = true;
+    } else {
+      flush();
+      active = false;
+    }
+  }
+  
+  if (active && length != 0 && millis() - chunkStart_ms >= Config::Capture::FLUSH_MS) flush();
+}
+
+void RxCapture::flush() {
+  if (length == 0) return;
+  uint8_t frame[sizeof(record) + FRAME_SYNC_OVERHEAD];
+  write(frame, encodeCaptureChunk(frame, sizeof(frame), record, length));
+  sequence++;  // И для отброшенного: пропуск номера виден на хосте
+  length = 0;
+}
+
+void RxCapture::write(const uint8_t* frame, size_t frameLength) {
+  if (frameLength == 0) return;
+  if (Serial.availableForWrite() < (int)frameLength) {
+    dropped++;
+    return;
+  }
+  Serial.write(frame, frameLength);
+  sent++;
+}
+
+void RxCapture::printReport(Print& out) const {
+  out.print("Capture: ");
+  out.print(requested ? "on" : "off");
+  out.print(", anchor ");
+  out.print(node.anchorId);
+  out.print(", bytes ");
+  out.print(bytesCaptured);
+  out.print(", records sent ");
+  out.print(sent);
+  out.print(", dropped (USB TX full) ");
+  out.println(dropped);
+}
@@ -0,0 +1,181 @@
+#include "rx_pipeline.h"
+
+#ifdef PLATFORM_ESP32
+
+#include "lora_module.h"
+#include "display.h"
+#include "logger.h"
+#include "latency_stats.h"
+#include "rx_capture.h"
+
+RxPipeline rxPipeline;
+
+void RxPipeline::StageTiming::add(uint32_t us) {
+  count++;
+  total_us += us;
+  if (us > max_us) max_us = us;
+}
+
+uint32_t RxPipeline::StageTiming::windowAverage() {
+  // Разности переживают переполнение счетчиков
+  uint32_t c = count;
+  uint32_t t = total_us;
+  uint32_t n = c - reportedCount;
+  uint32_t avg = n ? (t - reportedTotal_us) / n : 0;
+  reportedCount = c;
+  reportedTotal_us = t;
+  return avg;
+}
+
+RxPipeline::RxPipeline()
+  : frameHandler(nullptr), idleHandler(nullptr), processTask(nullptr), dropped(0), displayDirty(false) {
+  displayMux = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void RxPipeline::start(FrameHandler onFrame, IdleHandler onIdle) {
+  frameHandler = onFrame;
+  idleHandler = onIdle;
+  
+  // process создается первым: reader будит его уведомлением
+  xTaskCreatePinnedToCore(processTaskEntry, "rx_process", Config::Pipeline::TASK_STACK, this,
+                          Config::Pipeline::PROCESS_PRIORITY, &processTask,
+                          Config::Pipeline::PROCESS_CORE);
+  xTaskCreatePinnedToCore(renderTask, "rx_render", Config::Pipeline::TASK_STACK, this,
+                          Config::Pipeline::RENDER_PRIORITY, nullptr,
+                          Config::Pipeline::RENDER_CORE);
+  xTaskCreatePinnedToCore(readerTask, "rx_reader", Config::Pipeline::TASK_STACK, this,
+                          Config::Pipeline::READER_PRIORITY, nullptr,
+                          Config::Pipeline::READER_CORE);
+  
+  Serial.print("RX pipeline: reader core ");
+  Serial.print(Config::Pipeline::READER_CORE);
+  Serial.print(", process core ");
+  Serial.print(Config::Pipeline::PROCESS_CORE);
+  Serial.print(", queue ");
+  Serial.print(Config::Pipeline::QUEUE_DEPTH);
+  Serial.println(" frames");
+}
+
+void RxPipeline::publishDisplay(const PacketData& packet, const RxStats& stats) {
+  portENTER_CRITICAL(&displayMux);
+  displayPacket = packet;
+  displayStats = stats;
+  displayDirty = true;
+  portEXIT_CRITICAL(&displayMux);
+}
+
+void RxPipeline::readerTask(void* param) {
+  ((RxPipeline*)param)->readerLoop();
+}
+
+void RxPipeline::processTaskEntry(void* param) {
+  ((RxPipeline*)param)->processLoop();
+}
+
+void RxPipeline::renderTask(void* param) {
+  ((RxPipeline*)param)->renderLoop();
+}
+
+void RxPipeline::readerLoop() {
+  PacketParser parser;
+  RxFrame frame;
+  
+  for (;;) {
+    while (loraModule.available() > 0) {
+      char c = loraModule.read();  // Метка времени байта
+      LOG_DEBUG(LOG_RX_BYTE, (uint8_t)c);
+      
+      PacketParser::Result result = parser.feed((uint8_t)c);
+      
+      if (result == PacketParser::FRAME_OK) {
+        frame.packet = parser.packet();
+        frame.timing = loraModule.takeFrameTiming(parser);
+        frame.enqueue_us = micros();
+        readStage.add(frame.enqueue_us - frame.timing.lastByte_us);
+        
+        if (queue.push(frame)) {
+          xTaskNotifyGive(processTask);
+        } else {
+          dropped++;  // process не успевает - кадр теряется, чтение не ждет
+        }
+      } else if (result == PacketParser::FRAME_ERROR) {
+        RxFrameTiming timing = loraModule.takeFrameTiming(parser);
+        if (parser.lastErrorCrc()) rxLatencyStats.recordCrcReject();
+        LOG_WARN(LOG_RX_MALFORMED, timing.firstByte_us, timing.byteCount);
+      } else if (!parser.inFrame()) {
+        loraModule.resetFrameTiming();
+      }
+    }
+    
+    // Запись приема - в потоке чтения, между кадрами
+    if (!parser.inFrame()) rxCapture.poll();
+    
+    // Байт на 9600 бод - ~1 мс; начало кадра точно фиксирует AUX ISR
+    vTaskDelay(1);
+  }
+}
+
+void RxPipeline::processLoop() {
+  RxFrame frame;
+  uint32_t lastReportMs = millis();
+  
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    
+    while (queue.pop(frame)) {
+      uint32_t start = micros();
+      queueStage.add(start - frame.enqueue_us);
+      
+      if (frameHandler) frameHandler(frame.packet, frame.timing);
+      processStage.add(micros() - start);
+    }
+    
+    if (idleHandler) idleHandler();
+    
+    if (millis() - lastReportMs >= Config::Pipeline::REPORT_PERIOD_MS) {
+      lastReportMs = millis();
+      report();
+    }
+  }
+}
+
+void RxPipeline::renderLoop() {
+  PacketData packet;
+  RxStats stats;
+  
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(Config::Pipeline::RENDER_PERIOD_MS));
+    
+    // Пачка кадров между тиками - один вывод последнего
+    portENTER_CRITICAL(&displayMux);
+    bool dirty = displayDirty;
+    if (dirty) {
+      packet = displayPacket;
+      stats = displayStats;
+      displayDirty = false;
+    }
+    portEXIT_CRITICAL(&displayMux);
+    
+    // Без нового кадра - дописать строки, отложенные ограничением частоты
+    if (!dirty) {
+      displayManager.tick();
+      continue;
+    }
+    
+    uint32_t start = micros();
+    displayManager.showRxStatus(packet, stats);
+    renderStage.add(micros() - start);
+  }
+}
+
+void RxPipeline::report() {
+  LOG_INFO(LOG_PIPELINE_QUEUE, queue.getHighWater(), dropped, readStage.count);
+  LOG_INFO(LOG_PIPELINE_AVG, readStage.windowAverage(), queueStage.windowAverage(),
+           processStage.windowAverage());
+  LOG_INFO(LOG_PIPELINE_MAX, readStage.max_us, queueStage.max_us, processStage.max_us);
+  LOG_INFO(LOG_PIPELINE_RENDER, renderStage.count, renderStage.windowAverage(), renderStage.max_us);
+  LOG_INFO(LOG_DISPLAY_FLUSH, displayManager.getFlushCount(), displayManager.getMaxFlushUs(),
+           displayManager.getFullFrameUs());
+}
+
+#endif // PLATFORM_ESP32
@@ -0,0 +1,141 @@
+#include "scheduler.h"
+
+// ===== PeriodJitter =====
+
+void PeriodJitter::reset(uint32_t nominal) {
+  nominal_us = nominal;
+  count = 0;
+  minDev_us = 0;
+  maxDev_us = 0;
+  sumAbsDev_us = 0;
+  last_us = 0;
+  hasLast = false;
+}
+
+void PeriodJitter::mark(uint32_t now_us) {
+  if (hasLast) {
+    int32_t dev = (int32_t)(now_us - last_us - nominal_us);
+    if (count == 0 || dev < minDev_us) minDev_us = dev;
+    if (count == 0 || dev > maxDev_us) maxDev_us = dev;
+    sumAbsDev_us += dev < 0 ? (uint32_t)-dev : (uint32_t)dev;
+    count++;
+  }
+  last_us = now_us;
+  hasLast = true;
+}
+
+// ===== Scheduler =====
+
+Scheduler::Scheduler() : taskCount(0) {
+}
+
+uint8_t Scheduler::add(const char* name, TaskFn fn, uint32_t period_ms, uint32_t phase_ms) {
+  if (taskCount >= Config::Scheduler::MAX_TASKS) return NO_TASK;
+  
+  Task& task = tasks[taskCount];
+  task.name = name;
+  task.fn = fn;
+  task.period_us = period_ms * 1000UL;
+  task.deadline_us = micros() + phase_ms * 1000UL;
+  task.armed = period_ms > 0 || phase_ms > 0;
+  memset(&task.stats, 0, sizeof(task.stats));
+  
+  return taskCount++;
+}
+
+void Scheduler::wake(uint8_t id) {
+  wakeIn(id, 0);
+}
+
+void Scheduler::wakeIn(uint8_t id, uint32_t delay_ms) {
+  if (id >= taskCount) return;
+  tasks[id].deadline_us = micros() + delay_ms * 1000UL;
+  tasks[id].armed = true;
+}
+
+void Scheduler::setPeriod(uint8_t id, uint32_t period_ms) {
+  if (id >= taskCount || period_ms == 0) return;
+  Task& task = tasks[id];
+  
+  // Дедлайн уже сдвинут на старый период - заменяем его новым
+  uint32_t period_us = period_ms * 1000UL;
+  if (task.period_us) task.deadline_us += period_us - task.period_us;
+  task.period_us = period_us;
+}
+
+uint8_t Scheduler::nextDue(uint32_t now_us) {
+  uint8_t best = NO_TASK;
+  int32_t bestLate = -1;
+  
+  // Дедлайны сравниваются через разность - переживают переполнение micros()
+  for (uint8_t i = 0; i < taskCount; i++) {
+    if (!tasks[i].armed) continue;
+    int32_t late = (int32_t)(now_us - tasks[i].deadline_us);
+    if (late > bestLate) {
+      best = i;
+      bestLate = late;
+    }
+  }
+  return best;
+}
+
+uint32_t Scheduler::run() {
+  // Каждая задача не больше одного раза за проход: длинная цепочка
+  // просроченных задач не блокирует вызывающий loop()
+  uint8_t budget = taskCount;
+  uint8_t id;
+  
+  while (budget-- && (id = nextDue(micros())) != NO_TASK) {
+    Task& task = tasks[id];
+    uint32_t start = micros();
+    uint32_t late = start - task.deadline_us;
+    
+    if (task.period_us) {
+      task.deadline_us += task.period_us;
+      // Опоздали больше чем на период - слоты не догоняем пачкой
+      while ((int32_t)(start - task.deadline_us) >= 0) {
+        task.deadline_us += task.period_us;
+        task.stats.skipped++;
+      }
+    } else {
+      task.armed = false;
+    }
+    
+    task.fn();
+    
+    uint32_t runTime = micros() - start;
+    task.stats.runs++;
+    if (late > task.stats.maxLate_us) task.stats.maxLate_us = late;
+    if (runTime > task.stats.maxRun_us) task.stats.maxRun_us = runTime;
+  }
+  
+  // Время до ближайшего дедлайна (0 - есть просроченные)
+  uint32_t now = micros();
+  uint32_t wait = 0xFFFFFFFFUL;
+  for (uint8_t i = 0; i < taskCount; i++) {
+    if (!tasks[i].armed) continue;
+    int32_t left = (int32_t)(tasks[i].deadline_us - now);
+    if (left <= 0) return 0;
+    if ((uint32_t)left < wait) wait = (uint32_t)left;
+  }
+  return wait;
+}
+
+void Scheduler::printStats(Print& out) {
+  for (uint8_t i = 0; i < taskCount; i++) {
+    TaskStats& st = tasks[i].stats;
+    out.print("  task ");
+    out.print(tasks[i].name);
+    out.print(": runs=");
+    out.print(st.runs);
+    out.print(" skipped=");
+    out.print(st.skipped);
+    out.print(" late_max=");
+    out.print(st.maxLate_us);
+    out.print("us run_max=");
+    out.print(st.maxRun_us);
+    out.println("us");
+    st.maxLate_us = 0;
+    st.maxRun_us = 0;
+  }
+}
@@ -0,0 +1,151 @@
+#include "sequence_tracker.h"
+
+SequenceTable sequenceTable;
+
+// ===== SequenceTracker =====
+
+void SequenceTracker::reset() {
+  seen = 0;
+  top = 0;
+  probationSeq = 0;
+  probation = false;
+  started = false;
+  memset(&counters, 0, sizeof(counters));
+}
+
+void SequenceTracker::restart(uint32_t sequence) {
+  top = sequence;
+  seen = 1;
+  probation = false;
+  started = true;
+  counters.received++;
+}
+
+SequenceTracker::Verdict SequenceTracker::track(uint32_t sequence) {
+  if (!started) {
+    restart(sequence);
+    return SEQ_NEW;
+  }
+  
+  int32_t ahead = (int32_t)(sequence - top);
+  
+  // Дальше окна назад или большой скачок вперед: искаженный SEQ или
+  // перезапуск тега. Перезапуск подтверждает следующий по порядку кадр.
+  if (ahead <= -(int32_t)WINDOW || ahead > (int32_t)Config::Seq::MAX_JUMP) {
+    if (probation && sequence == probationSeq) {
+      counters.resyncs++;
+      restart(sequence);
+      return SEQ_RESYNC;
+    }
+    probation = true;
+    probationSeq = sequence + 1;
+    counters.suspect++;
+    return SEQ_SUSPECT;
+  }
+  probation = false;
+  
+  if (ahead > 0) {
+    counters.lost += (uint32_t)(ahead - 1);
+    seen = ahead >= WINDOW ? 1 : (seen << ahead) | 1;
+    top = sequence;
+    counters.received++;
+    return SEQ_NEW;
+  }
+  
+  uint64_t bit = (uint64_t)1 << (uint8_t)(-ahead);
+  if (seen & bit) {
+    counters.duplicates++;
+    return SEQ_DUPLICATE;
+  }
+  
+  seen |= bit;
+  counters.received++;
+  counters.outOfOrder++;
+  if (counters.lost) counters.lost--;
+  return SEQ_LATE;
+}
+
+uint16_t SequenceTracker::getLossPermille() const {
+  uint32_t total = counters.received + counters.lost;
+  return total ? (uint16_t)((uint64_t)counters.lost * 1000 / total) : 0;
+}
+
+// ===== SequenceTable =====
+
+SequenceTable::SequenceTable() : evicted(0) {
+  for (uint8_t i = 0; i < Config::Seq::MAX_SENDERS; i++) entries[i].used = false;
+}
+
+SequenceTable::Entry* SequenceTable::findOrCreate(uint16_t sender) {
+  Entry* victim = &entries[0];
+  uint32_t now = millis();
+  
+  // Свободная запись предпочтительнее, иначе - самая давняя
+  for (uint8_t i = 0; i < Config::Seq::MAX_SENDERS; i++) {
+    Entry& entry = entries[i];
+    if (entry.used && entry.sender == sender) return &entry;
+    if (!victim->used) continue;
+    if (!entry.used || now - entry.lastSeen_ms > now - victim->lastSeen_ms) victim = &entry;
+  }
+  
+  if (victim->used) evicted++;
+  victim->sender = sender;
+  victim->used = true;
+  victim->tracker.reset();
+  return victim;
+}
+
+SequenceTracker::Verdict SequenceTable::track(uint16_t sender, uint32_t sequence) {
+  Entry* entry = findOrCreate(sender);
+  entry->lastSeen_ms = millis();
+  return entry->tracker.track(sequence);
+}
+
+const SequenceTracker* SequenceTable::find(uint16_t sender) const {
+  for (uint8_t i = 0; i < Config::Seq::MAX_SENDERS; i++) {
+    if (entries[i].used && entries[i].sender == sender) return &entries[i].tracker;
+  }
+  return nullptr;
+}
+
+void SequenceTable::printReport(Print& out) const {
+  out.print("Sequence tracking (window ");
+  out.print(SequenceTracker::WINDOW);
+  out.print(", evicted ");
+  out.print(evicted);
+  out.println("):");
+  
+  for (uint8_t i = 0; i < Config::Seq::MAX_SENDERS; i++) {
+    const Entry& entry = entries[i];
+    if (!entry.used) continue;
+    const SequenceTracker::Counters& c = entry.tracker.getCounters();
+    uint16_t loss = entry.tracker.getLossPermille();
+    
+    out.print("  ");
+    if (entry.sender & SENDER_SYNC) {
+      out.print("sync anchor ");
+      out.print(entry.sender & ~SENDER_SYNC);
+    } else {
+      out.print("tag ");
+      out.print(entry.sender);
+    }
+    out.print(": rx=");
+    out.print(c.received);
+    out.print(" lost=");
+    out.print(c.lost);
+    out.print(" (");
+    out.print(loss / 10);
+    out.print(".");
+    out.print(loss % 10);
+    out.print("%) dup=");
+    out.print(c.duplicates);
+    out.print(" ooo=");
+    out.print(c.outOfOrder);
+    out.print(" suspect=");
+    out.print(c.suspect);
+    out.print(" resync=");
+    out.print(c.resyncs);
+    out.print(" top=");
+    out.println(entry.tracker.getTop());
+  }
+}
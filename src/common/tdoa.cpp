@@ -1,14 +1,16 @@
 #include "tdoa.h"
+#include "logger.h"
 
 TDOANavigator tdoaNavigator;
 
-TDOANavigator::TDOANavigator() : anchorCount(0) {
+TDOANavigator::TDOANavigator() : anchorCount(0), evictedLive(0), evictedTags(0) {
   // Очистка массивов измерений
-  for (uint8_t i = 0; i < MAX_MEASUREMENTS; i++) {
-    measurements[i].euid = "";
+  for (uint16_t i = 0; i < MAX_MEASUREMENTS; i++) {
+    measurements[i].key = 0;
     measurements[i].rxCount = 0;
     measurements[i].lastUpdate_ms = 0;
   }
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) tags[i].used = false;
 }
 
 void TDOANavigator::registerAnchor(uint8_t id, float x, float y) {
@@ -32,85 +34,376 @@ void TDOANavigator::registerAnchor(uint8_t id, float x, float y) {
 }
 
 void TDOANavigator::processRxPacket(const PacketData& packet, const RxStats& stats) {
+  // Локальный anchor - первый зарегистрированный
+  processRxPacket(packet, stats, anchorCount > 0 ? anchors[0].id : 0);
+}
+
+void TDOANavigator::processRxPacket(const PacketData& packet, const RxStats& stats, uint8_t anchorId) {
   if (!packet.valid) return;
   
-  TDOAMeasurement* meas = findOrCreateMeasurement(packet.euid);
+  TDOAMeasurement* meas = findOrCreateMeasurement(frameKey(packet));
   if (!meas) return;
   
-  // Сохраняем время приема на этом anchor узле
-  // Предполагаем что anchor ID = 0 для первого RX, 1 для второго и т.д.
-  // В реальности нужно передавать anchor ID
-  if (meas->rxCount < MAX_ANCHORS) {
-    meas->rxTimes_us[meas->rxCount] = stats.rxTime_us;
-    meas->rxCount++;
+  // Время начала кадра в эфире: метка первого байта/AUX минус airtime,
+  // чтобы длина кадра не смещала разности времен
+  uint32_t arrival_us = stats.arrivalTime_us();
+  
+  // Повторный прием тем же anchor - обновляем метку
+  uint8_t slot = meas->rxCount;
+  for (uint8_t i = 0; i < meas->rxCount; i++) {
+    if (meas->anchorIds[i] == anchorId) {
+      slot = i;
+      break;
+    }
+  }
+  
+  if (slot < MAX_ANCHORS) {
+    meas->rxTimes_us[slot] = arrival_us;
+    meas->anchorIds[slot] = anchorId;
+    if (slot == meas->rxCount) meas->rxCount++;
     meas->lastUpdate_ms = millis();
   }
   
-  Serial.print("TDOA: Recorded RX time for EUID:");
-  Serial.print(packet.euid);
-  Serial.print(" (");
-  Serial.print(meas->rxCount);
-  Serial.println(" anchors)");
+  // Новый кадр тега - его измерение становится последним
+  TagState* tag = findOrCreateTag(packet.tagId);
+  if (tag->lastKey != meas->key || tag->frames == 0) {
+    tag->lastKey = meas->key;
+    tag->solved = false;
+    tag->frames++;
+  }
+  tag->lastSeen_ms = millis();
+  
+  LOG_DEBUG(LOG_TDOA_RECORDED, (int32_t)meas->key, meas->rxCount);
 }
 
 Position2D TDOANavigator::calculatePosition(const String& euid) {
+  return calculatePosition(euidToKey(euid.c_str()));
+}
+
+Position2D TDOANavigator::calculatePosition(uint64_t euidKey) {
   Position2D pos;
   
   // Найти измерение
-  TDOAMeasurement* meas = nullptr;
-  for (uint8_t i = 0; i < MAX_MEASUREMENTS; i++) {
-    if (measurements[i].euid == euid) {
-      meas = &measurements[i];
-      break;
-    }
-  }
+  TDOAMeasurement* meas = findMeasurement(euidKey);
   
   if (!meas || meas->rxCount < 3) {
     Serial.println("TDOA: Not enough measurements (need 3+ anchors)");
     return pos;
   }
   
-  // TODO: Реализовать TDOA триангуляцию
-  // Это заглушка на будущее
+  uint32_t startUs = micros();
   pos = trilaterate(*meas);
+  uint32_t solveUs = micros() - startUs;
+  
+  Serial.print("TDOA: Fix ");
+  Serial.print(pos.valid ? "OK" : "FAILED");
+  Serial.print(" (");
+  Serial.print(pos.x);
+  Serial.print(", ");
+  Serial.print(pos.y);
+  Serial.print(") residual=");
+  Serial.print(pos.residual_m);
+  Serial.print("m GDOP=");
+  Serial.print(pos.gdop);
+  Serial.print(" in ");
+  Serial.print(solveUs);
+  Serial.println("us");
   
   return pos;
 }
 
-TDOANavigator::TDOAMeasurement* TDOANavigator::findOrCreateMeasurement(const String& euid) {
-  // Поиск существующего
-  for (uint8_t i = 0; i < MAX_MEASUREMENTS; i++) {
-    if (measurements[i].euid == euid) {
-      return &measurements[i];
+Position2D TDOANavigator::locateTag(uint16_t tagId) {
+  TagState* tag = findTag(tagId);
+  if (!tag) {
+    Serial.print("TDOA: Unknown tag ");
+    Serial.println(tagId);
+    return Position2D();
+  }
+  
+  return calculatePosition(tag->lastKey);
+}
+
+uint8_t TDOANavigator::locateAll() {
+  uint8_t fixes = 0;
+  uint32_t now = millis();
+  
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    TagState& tag = tags[i];
+    if (!tag.used || tag.solved) continue;
+    
+    // Измерение истекло или вытеснено - кадр пропущен, трек на прогнозе
+    const TDOAMeasurement* meas = findMeasurement(tag.lastKey);
+    if (!meas) {
+      tag.solved = true;
+      continue;
+    }
+    
+    // Метки остальных anchor еще идут - шаг при следующем вызове
+    if (meas->rxCount < anchorCount && now - meas->lastUpdate_ms < Config::Tdoa::TRACK_SETTLE_MS) {
+      continue;
+    }
+    
+    tag.solved = true;
+    if (trackTag(tag, *meas)) fixes++;
+  }
+  return fixes;
+}
+
+bool TDOANavigator::trackTag(TagState& tag, const TDOAMeasurement& meas) {
+  float ax[MAX_ANCHORS];
+  float ay[MAX_ANCHORS];
+  float rangeDiff_m[MAX_ANCHORS];
+  uint32_t frameTime_us = 0;
+  uint8_t count = collectRangeDiffs(meas, ax, ay, rangeDiff_m, frameTime_us);
+  
+  TdoaTracker& tracker = tag.tracker;
+  TdoaTracker::Result result = tracker.step(ax, ay, rangeDiff_m, count, frameTime_us);
+  
+  if (result == TdoaTracker::TRACK_INIT) {
+    tag.trackInits++;
+  } else if (result == TdoaTracker::TRACK_UPDATE) {
+    tag.trackUpdates++;
+  } else {
+    return false;
+  }
+  
+  // GDOP трека - ожидаемая ошибка в единицах шума разностей
+  Position2D& pos = tag.position;
+  pos.x = tracker.getX();
+  pos.y = tracker.getY();
+  pos.residual_m = tracker.getInnovationRms();
+  pos.gdop = tracker.getPositionSigma() / TDOA_TRACK_RANGE_SIGMA_M;
+  pos.anchorsUsed = count;
+  pos.valid = true;
+  tag.positionTime_ms = millis();
+  return true;
+}
+
+bool TDOANavigator::getTagPosition(uint16_t tagId, Position2D& pos) const {
+  const TagState* tag = findTag(tagId);
+  if (!tag || !tag->position.valid) return false;
+  pos = tag->position;
+  
+  // Между кадрами - прогноз по скорости трека, не дольше TDOA_TRACK_MAX_COAST_US
+  const TdoaTracker& tracker = tag->tracker;
+  if (tracker.isTracking(tracker.getTime_us())) {
+    uint32_t elapsed_ms = millis() - tag->positionTime_ms;
+    if (elapsed_ms > TDOA_TRACK_MAX_COAST_US / 1000) elapsed_ms = TDOA_TRACK_MAX_COAST_US / 1000;
+    tracker.positionAt(tracker.getTime_us() + elapsed_ms * 1000, pos.x, pos.y);
+  }
+  return true;
+}
+
+void TDOANavigator::printTags(Print& out) const {
+  uint32_t now = millis();
+  
+  out.print("Tags (max ");
+  out.print(Config::Tag::MAX_TAGS);
+  out.print(", evicted ");
+  out.print(evictedTags);
+  out.println("):");
+  
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    const TagState& tag = tags[i];
+    if (!tag.used) continue;
+    
+    out.print("  tag ");
+    out.print(tag.tagId);
+    out.print(": frames=");
+    out.print(tag.frames);
+    out.print(" seen ");
+    out.print((now - tag.lastSeen_ms) / 1000);
+    out.print("s ago");
+    if (tag.position.valid) {
+      out.print(", pos (");
+      out.print(tag.position.x);
+      out.print(", ");
+      out.print(tag.position.y);
+      out.print(") v=(");
+      out.print(tag.tracker.getVx());
+      out.print(", ");
+      out.print(tag.tracker.getVy());
+      out.print(")m/s sigma=");
+      out.print(tag.tracker.getPositionSigma());
+      out.print("m res=");
+      out.print(tag.position.residual_m);
+      out.print("m ");
+      out.print((now - tag.positionTime_ms) / 1000);
+      out.print("s ago, track init/upd ");
+      out.print(tag.trackInits);
+      out.print("/");
+      out.print(tag.trackUpdates);
+    } else {
+      out.print(", no fix");
+    }
+    out.println();
+  }
+}
+
+TDOANavigator::TagState* TDOANavigator::findTag(uint16_t tagId) {
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    if (tags[i].used && tags[i].tagId == tagId) return &tags[i];
+  }
+  return nullptr;
+}
+
+const TDOANavigator::TagState* TDOANavigator::findTag(uint16_t tagId) const {
+  return const_cast<TDOANavigator*>(this)->findTag(tagId);
+}
+
+TDOANavigator::TagState* TDOANavigator::findOrCreateTag(uint16_t tagId) {
+  TagState* tag = findTag(tagId);
+  if (tag) return tag;
+  
+  // Свободная запись, иначе - тег, который молчит дольше всех
+  uint32_t now = millis();
+  TagState* victim = &tags[0];
+  for (uint8_t i = 0; i < Config::Tag::MAX_TAGS; i++) {
+    if (!victim->used) break;
+    if (!tags[i].used || now - tags[i].lastSeen_ms > now - victim->lastSeen_ms) victim = &tags[i];
+  }
+  if (victim->used) evictedTags++;
+  
+  victim->tagId = tagId;
+  victim->used = true;
+  victim->solved = true;
+  victim->lastKey = 0;
+  victim->lastSeen_ms = now;
+  victim->frames = 0;
+  victim->position = Position2D();
+  victim->positionTime_ms = 0;
+  victim->tracker.reset();
+  victim->trackInits = 0;
+  victim->trackUpdates = 0;
+  return victim;
+}
+
+uint16_t TDOANavigator::slotFor(uint64_t key) {
+  // Перемешивание 64 -> 32 бит: половины с разными множителями,
+  // затем финализатор MurmurHash3, индекс - по маске
+  uint32_t h = (uint32_t)key * 0x9E3779B1UL ^ (uint32_t)(key >> 32) * 0x85EBCA77UL;
+  h ^= h >> 16;
+  h *= 0x85EBCA6BUL;
+  h ^= h >> 13;
+  return (uint16_t)(h & (MAX_MEASUREMENTS - 1));
+}
+
+bool TDOANavigator::isExpired(const TDOAMeasurement& meas, uint32_t now_ms) const {
+  return now_ms - meas.lastUpdate_ms > Config::Tdoa::MEASUREMENT_TTL_MS;
+}
+
+TDOANavigator::TDOAMeasurement* TDOANavigator::findMeasurement(uint64_t key) {
+  uint16_t idx = slotFor(key);
+  
+  for (uint8_t probe = 0; probe < Config::Tdoa::MEASUREMENT_MAX_PROBE; probe++) {
+    TDOAMeasurement& meas = measurements[idx];
+    if (meas.rxCount == 0) return nullptr;  // Конец цепочки
+    if (meas.key == key) return &meas;
+    idx = (idx + 1) & (MAX_MEASUREMENTS - 1);
+  }
+  
+  return nullptr;
+}
+
+TDOANavigator::TDOAMeasurement* TDOANavigator::findOrCreateMeasurement(uint64_t key) {
+  uint32_t now = millis();
+  uint16_t idx = slotFor(key);
+  TDOAMeasurement* reuse = nullptr;    // Первый свободный/истекший слот
+  TDOAMeasurement* oldest = nullptr;   // Самый старый живой слот в цепочке
+  
+  for (uint8_t probe = 0; probe < Config::Tdoa::MEASUREMENT_MAX_PROBE; probe++) {
+    TDOAMeasurement& meas = measurements[idx];
+    
+    if (meas.rxCount == 0) {
+      // Ключа дальше по цепочке нет
+      if (!reuse) reuse = &meas;
+      break;
+    }
+    
+    if (meas.key == key) {
+      // Истекшая запись с тем же EUID - начинаем измерение заново
+      if (isExpired(meas, now)) meas.rxCount = 0;
+      return &meas;
+    }
+    
+    if (isExpired(meas, now)) {
+      if (!reuse) reuse = &meas;
+    } else if (!oldest || (int32_t)(meas.lastUpdate_ms - oldest->lastUpdate_ms) < 0) {
+      oldest = &meas;
     }
+    
+    idx = (idx + 1) & (MAX_MEASUREMENTS - 1);
+  }
+  
+  // Нет свободного места в цепочке - вытесняем самое старое измерение
+  if (!reuse) {
+    reuse = oldest;
+    evictedLive++;
   }
   
-  // Создание нового (замена самого старого)
-  uint8_t oldestIdx = 0;
-  uint32_t oldestTime = measurements[0].lastUpdate_ms;
+  reuse->key = key;
+  reuse->rxCount = 0;
+  reuse->lastUpdate_ms = now;
   
-  for (uint8_t i = 1; i < MAX_MEASUREMENTS; i++) {
-    if (measurements[i].lastUpdate_ms < oldestTime) {
-      oldestTime = measurements[i].lastUpdate_ms;
-      oldestIdx = i;
+  return reuse;
+}
+
+const AnchorNode* TDOANavigator::findAnchor(uint8_t id) const {
+  for (uint8_t i = 0; i < anchorCount; i++) {
+    if (anchors[i].id == id) {
+      return &anchors[i];
     }
   }
+  return nullptr;
+}
+
+template <typename T>
+uint8_t TDOANavigator::collectRangeDiffs(const TDOAMeasurement& meas, T* ax, T* ay,
+                                         T* rangeDiff_m, uint32_t& frameTime_us) const {
+  uint8_t count = 0;
   
-  measurements[oldestIdx].euid = euid;
-  measurements[oldestIdx].rxCount = 0;
-  measurements[oldestIdx].lastUpdate_ms = millis();
+  for (uint8_t i = 0; i < meas.rxCount; i++) {
+    const AnchorNode* anchor = findAnchor(meas.anchorIds[i]);
+    if (!anchor) continue;  // Координаты неизвестны
+    
+    if (count == 0) frameTime_us = meas.rxTimes_us[i];
+    
+    // Разность со знаком, корректна при переполнении micros(); не влезла в
+    // тип (плохая метка или отсчет синхронизации) - anchor пропускается
+    if (!rangeDiffFromTime((int32_t)(meas.rxTimes_us[i] - frameTime_us), rangeDiff_m[count])) continue;
+    ax[count] = NumTraits<T>::fromFloat(anchor->x);
+    ay[count] = NumTraits<T>::fromFloat(anchor->y);
+    count++;
+  }
   
-  return &measurements[oldestIdx];
+  return count;
 }
 
 Position2D TDOANavigator::trilaterate(const TDOAMeasurement& meas) {
   Position2D pos;
   
-  // TODO: Реализовать алгоритм TDOA триангуляции
   // Гиперболическая триангуляция на основе разницы времен прихода
   // https://en.wikipedia.org/wiki/Multilateration
+  // Разности и решение - в типе платформы (Mega: фиксированная точка)
+  TdoaScalar ax[MAX_ANCHORS];
+  TdoaScalar ay[MAX_ANCHORS];
+  TdoaScalar rangeDiff_m[MAX_ANCHORS];
+  uint32_t refTime_us = 0;
+  uint8_t count = collectRangeDiffs(meas, ax, ay, rangeDiff_m, refTime_us);
+  
+  if (count < 3) {
+    Serial.println("TDOA: Anchor positions unknown for measurement");
+    return pos;
+  }
+  
+  TdoaSolution sol = solveTdoa<TdoaScalar>(ax, ay, rangeDiff_m, count);
   
-  Serial.println("TDOA: Trilateration not implemented yet (stub)");
+  pos.x = sol.x;
+  pos.y = sol.y;
+  pos.residual_m = sol.residual_m;
+  pos.gdop = sol.gdop;
+  pos.anchorsUsed = count;
+  pos.valid = sol.valid;
   
   return pos;
 }
@@ -0,0 +1,236 @@
+#include "tdoa_solver.h"
+#include <math.h>
+
+// Минимальное расстояние до anchor при линеаризации (метры)
+static const float MIN_RANGE_M = 1e-3f;
+
+// Порог в типе решателя; в фиксированной точке - не меньше младшего разряда
+template <typename T>
+static T threshold(float value) {
+  T t = NumTraits<T>::fromFloat(value);
+  return t < NumTraits<T>::epsilon() ? NumTraits<T>::epsilon() : t;
+}
+
+// Сумма квадратов невязок гипербол f_i = |p - a_i| - |p - a_0| - d_i
+// (координаты уже относительно anchor 0)
+template <typename T>
+static T hyperbolaCost(const T* ax, const T* ay, const T* d,
+                       uint8_t count, T x, T y) {
+  T r0 = NumTraits<T>::sqrt(x * x + y * y);
+  T cost = T();
+  
+  for (uint8_t i = 1; i < count; i++) {
+    T dx = x - ax[i];
+    T dy = y - ay[i];
+    T f = NumTraits<T>::sqrt(dx * dx + dy * dy) - r0 - d[i];
+    cost += f * f;
+  }
+  
+  return cost;
+}
+
+// J^T J и J^T f для шага Gauss-Newton в точке (x, y)
+template <typename T>
+static void accumulateNormal(const T* ax, const T* ay, const T* d,
+                             uint8_t count, T x, T y, T minRange,
+                             T& jxx, T& jxy, T& jyy,
+                             T& jfx, T& jfy) {
+  T r0 = NumTraits<T>::sqrt(x * x + y * y);
+  if (r0 < minRange) r0 = minRange;
+  T x0 = x / r0;
+  T y0 = y / r0;
+  
+  jxx = jxy = jyy = jfx = jfy = T();
+  
+  for (uint8_t i = 1; i < count; i++) {
+    T dx = x - ax[i];
+    T dy = y - ay[i];
+    T ri = NumTraits<T>::sqrt(dx * dx + dy * dy);
+    if (ri < minRange) ri = minRange;
+    
+    T f = ri - r0 - d[i];
+    T gx = dx / ri - x0;
+    T gy = dy / ri - y0;
+    
+    jxx += gx * gx;
+    jxy += gx * gy;
+    jyy += gy * gy;
+    jfx += gx * f;
+    jfy += gy * f;
+  }
+}
+
+template <typename T>
+TdoaSolution solveTdoa(const T* anchorX, const T* anchorY,
+                       const T* rangeDiff_m, uint8_t count) {
+  typedef NumTraits<T> Num;
+  TdoaSolution sol;
+  if (count < 3 || count > TDOA_MAX_ANCHORS) return sol;
+  
+  // Координаты относительно опорного anchor 0 - лучше обусловленность во float
+  T ax[TDOA_MAX_ANCHORS];
+  T ay[TDOA_MAX_ANCHORS];
+  T d[TDOA_MAX_ANCHORS];
+  
+  for (uint8_t i = 0; i < count; i++) {
+    ax[i] = anchorX[i] - anchorX[0];
+    ay[i] = anchorY[i] - anchorY[0];
+    d[i] = rangeDiff_m[i];
+  }
+  d[0] = T();
+  
+  // Фиксированная точка: масштаб 2^shift, |вход| < 2^MAX_INPUT_EXP
+  int8_t shift = 0;
+  if (Num::NORMALIZE) {
+    int8_t maxExp = Num::MAX_INPUT_EXP;
+    for (uint8_t i = 1; i < count; i++) {
+      if (Num::exponent(ax[i]) > maxExp) maxExp = Num::exponent(ax[i]);
+      if (Num::exponent(ay[i]) > maxExp) maxExp = Num::exponent(ay[i]);
+      if (Num::exponent(d[i]) > maxExp) maxExp = Num::exponent(d[i]);
+    }
+    shift = maxExp - Num::MAX_INPUT_EXP;
+    for (uint8_t i = 1; i < count; i++) {
+      ax[i] = Num::scale(ax[i], -shift);
+      ay[i] = Num::scale(ay[i], -shift);
+      d[i] = Num::scale(d[i], -shift);
+    }
+  }
+  
+  const T one = Num::fromInt(1);
+  const T two = Num::fromInt(2);
+  const T four = Num::fromInt(4);
+  const T half = Num::fromFloat(0.5f);
+  const T minRange = threshold<T>(ldexpf(MIN_RANGE_M, -shift));
+  
+  // ----- 1) Замкнутое приближение -----
+  // Для i >= 1: 2x_i*x + 2y_i*y = (K_i - d_i^2) - 2d_i*r0, K_i = x_i^2 + y_i^2.
+  // МНК по (x, y) при фиксированном r0 дает p = u + v*r0.
+  T sxx = T(), sxy = T(), syy = T();
+  T sxb = T(), syb = T(), sxd = T(), syd = T();
+  
+  for (uint8_t i = 1; i < count; i++) {
+    T rx = two * ax[i];
+    T ry = two * ay[i];
+    T b = ax[i] * ax[i] + ay[i] * ay[i] - d[i] * d[i];
+    T c = -two * d[i];
+    
+    sxx += rx * rx;
+    sxy += rx * ry;
+    syy += ry * ry;
+    sxb += rx * b;
+    syb += ry * b;
+    sxd += rx * c;
+    syd += ry * c;
+  }
+  
+  T det = sxx * syy - sxy * sxy;
+  if (!(Num::abs(det) > threshold<T>(1e-6f) * sxx * syy)) {
+    return sol;  // Anchor узлы на одной прямой
+  }
+  
+  T ux = (syy * sxb - sxy * syb) / det;
+  T uy = (sxx * syb - sxy * sxb) / det;
+  T vx = (syy * sxd - sxy * syd) / det;
+  T vy = (sxx * syd - sxy * sxd) / det;
+  
+  // Ограничение r0^2 = |u + v*r0|^2 -> qa*r0^2 + qb*r0 + qc = 0
+  T qa = vx * vx + vy * vy - one;
+  T qb = two * (ux * vx + uy * vy);
+  T qc = ux * ux + uy * uy;
+  
+  T roots[2];
+  uint8_t rootCount = 0;
+  
+  if (Num::abs(qa) < threshold<T>(1e-6f)) {
+    if (qb != T()) roots[rootCount++] = -qc / qb;
+  } else {
+    T disc = qb * qb - four * qa * qc;
+    if (disc < T()) disc = T();  // Шум: берем вершину параболы
+    T sq = Num::sqrt(disc);
+    roots[rootCount++] = (-qb + sq) / (two * qa);
+    roots[rootCount++] = (-qb - sq) / (two * qa);
+  }
+  
+  T x = ux;
+  T y = uy;
+  T bestCost = -one;
+  
+  for (uint8_t k = 0; k < rootCount; k++) {
+    if (roots[k] < T()) continue;
+    T cx = ux + vx * roots[k];
+    T cy = uy + vy * roots[k];
+    T cost = hyperbolaCost(ax, ay, d, count, cx, cy);
+    if (bestCost < T() || cost < bestCost) {
+      bestCost = cost;
+      x = cx;
+      y = cy;
+    }
+  }
+  
+  // ----- 2) Уточнение Gauss-Newton (фиксированное число шагов) -----
+  // Шаг, увеличивающий невязку, делим пополам - при сильном шуме
+  // полный шаг может увести решение далеко от площадки
+  const T minStep2 = threshold<T>(ldexpf(1e-6f, -2 * shift));
+  T jxx, jxy, jyy, jfx, jfy;
+  T cost = hyperbolaCost(ax, ay, d, count, x, y);
+  
+  for (uint8_t it = 0; it < TDOA_GN_ITERATIONS; it++) {
+    accumulateNormal(ax, ay, d, count, x, y, minRange, jxx, jxy, jyy, jfx, jfy);
+    
+    T jdet = jxx * jyy - jxy * jxy;
+    if (!(jdet > threshold<T>(1e-12f))) break;
+    
+    T stepX = -(jyy * jfx - jxy * jfy) / jdet;
+    T stepY = -(jxx * jfy - jxy * jfx) / jdet;
+    
+    bool improved = false;
+    for (uint8_t halving = 0; halving < 3; halving++) {
+      T nextCost = hyperbolaCost(ax, ay, d, count, x + stepX, y + stepY);
+      if (nextCost <= cost) {
+        x += stepX;
+        y += stepY;
+        cost = nextCost;
+        improved = true;
+        break;
+      }
+      stepX *= half;
+      stepY *= half;
+    }
+    
+    if (!improved || stepX * stepX + stepY * stepY < minStep2) break;
+  }
+  
+  // Качество решения для отбраковки вызывающим кодом
+  accumulateNormal(ax, ay, d, count, x, y, minRange, jxx, jxy, jyy, jfx, jfy);
+  T jdet = jxx * jyy - jxy * jxy;
+  
+  // Обратно в метры: масштаб и смещение anchor 0
+  sol.x = ldexpf(Num::toFloat(x), shift) + Num::toFloat(anchorX[0]);
+  sol.y = ldexpf(Num::toFloat(y), shift) + Num::toFloat(anchorY[0]);
+  sol.residual_m = ldexpf(Num::toFloat(Num::sqrt(cost / Num::fromInt(count - 1))), shift);
+  sol.gdop = (jdet > T()) ? Num::toFloat(Num::sqrt((jxx + jyy) / jdet)) : INFINITY;
+  sol.valid = Num::isValid(x) && Num::isValid(y) && isfinite(sol.x) && isfinite(sol.y);
+  
+  return sol;
+}
+
+template TdoaSolution solveTdoa<float>(const float*, const float*, const float*, uint8_t);
+template TdoaSolution solveTdoa<Q16_16>(const Q16_16*, const Q16_16*, const Q16_16*, uint8_t);
+template TdoaSolution solveTdoa<Q24_8>(const Q24_8*, const Q24_8*, const Q24_8*, uint8_t);
+
+TdoaSolution solveTdoa(const float* anchorX, const float* anchorY,
+                       const float* rangeDiff_m, uint8_t count) {
+  if (count > TDOA_MAX_ANCHORS) return TdoaSolution();
+  
+  TdoaScalar ax[TDOA_MAX_ANCHORS];
+  TdoaScalar ay[TDOA_MAX_ANCHORS];
+  TdoaScalar d[TDOA_MAX_ANCHORS];
+  
+  for (uint8_t i = 0; i < count; i++) {
+    ax[i] = NumTraits<TdoaScalar>::fromFloat(anchorX[i]);
+    ay[i] = NumTraits<TdoaScalar>::fromFloat(anchorY[i]);
+    d[i] = NumTraits<TdoaScalar>::fromFloat(rangeDiff_m[i]);
+  }
+  
+  return solveTdoa<TdoaScalar>(ax, ay, d, count);
+}
@@ -0,0 +1,168 @@
+#include "tdoa_tracker.h"
+#include <math.h>
+
+// Минимальное расстояние до anchor при линеаризации (метры)
+static const float MIN_RANGE_M = 1e-3f;
+
+TdoaTracker::TdoaTracker() {
+  setNoise(TDOA_TRACK_ACCEL_SIGMA, TDOA_TRACK_RANGE_SIGMA_M);
+  reset();
+}
+
+void TdoaTracker::setNoise(float accelSigma_mps2, float rangeSigma_m) {
+  accelVar = accelSigma_mps2 * accelSigma_mps2;
+  rangeVar = rangeSigma_m * rangeSigma_m;
+}
+
+void TdoaTracker::reset() {
+  for (uint8_t i = 0; i < 4; i++) {
+    state[i] = 0;
+    for (uint8_t j = 0; j < 4; j++) P[i][j] = 0;
+  }
+  innovationRms = 0;
+  time_us = 0;
+  misses = 0;
+  initialized = false;
+}
+
+bool TdoaTracker::isTracking(uint32_t t_us) const {
+  return initialized && misses < TDOA_TRACK_MAX_MISSES &&
+         (int32_t)(t_us - time_us) <= (int32_t)TDOA_TRACK_MAX_COAST_US;
+}
+
+void TdoaTracker::initialize(const TdoaSolution& sol, uint32_t t_us) {
+  reset();
+  
+  // GDOP * sigma - ошибка решения; скорость неизвестна
+  float posVar = sol.gdop * sol.gdop * rangeVar;
+  if (!(posVar < 1e12f)) posVar = 1e12f;
+  
+  state[0] = sol.x;
+  state[1] = sol.y;
+  P[0][0] = P[1][1] = posVar;
+  P[2][2] = P[3][3] = TDOA_TRACK_INIT_SPEED * TDOA_TRACK_INIT_SPEED;
+  innovationRms = sol.residual_m;
+  time_us = t_us;
+  initialized = true;
+}
+
+void TdoaTracker::predict(uint32_t t_us) {
+  // Кадр старше трека (переставлен) - обновляем без прогноза назад
+  int32_t elapsed = (int32_t)(t_us - time_us);
+  if (elapsed <= 0) return;
+  time_us = t_us;
+  
+  float dt = elapsed * 1e-6f;
+  state[0] += state[2] * dt;
+  state[1] += state[3] * dt;
+  
+  // P = F P F^T, F = [I dt*I; 0 I]: сначала строки, затем столбцы
+  for (uint8_t j = 0; j < 4; j++) {
+    P[0][j] += dt * P[2][j];
+    P[1][j] += dt * P[3][j];
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    P[i][0] += dt * P[i][2];
+    P[i][1] += dt * P[i][3];
+  }
+  
+  // + Q: белый шум ускорения, по каждой оси [dt^4/4 dt^3/2; dt^3/2 dt^2]
+  float dt2 = dt * dt;
+  float qPos = accelVar * dt2 * dt2 * 0.25f;
+  float qCross = accelVar * dt2 * dt * 0.5f;
+  float qVel = accelVar * dt2;
+  P[0][0] += qPos;
+  P[1][1] += qPos;
+  P[0][2] += qCross;
+  P[2][0] += qCross;
+  P[1][3] += qCross;
+  P[3][1] += qCross;
+  P[2][2] += qVel;
+  P[3][3] += qVel;
+}
+
+bool TdoaTracker::updateScalar(float ax, float ay, float ax0, float ay0, float rangeDiff_m) {
+  // h = |p - a_i| - |p - a_0|, H = [gx gy 0 0]
+  float dx = state[0] - ax;
+  float dy = state[1] - ay;
+  float dx0 = state[0] - ax0;
+  float dy0 = state[1] - ay0;
+  float ri = sqrtf(dx * dx + dy * dy);
+  float r0 = sqrtf(dx0 * dx0 + dy0 * dy0);
+  if (ri < MIN_RANGE_M) ri = MIN_RANGE_M;
+  if (r0 < MIN_RANGE_M) r0 = MIN_RANGE_M;
+  
+  float gx = dx / ri - dx0 / r0;
+  float gy = dy / ri - dy0 / r0;
+  float innovation = rangeDiff_m - (ri - r0);
+  
+  // PH^T - столбец, S - скаляр: обращать нечего
+  float ph[4];
+  for (uint8_t i = 0; i < 4; i++) ph[i] = P[i][0] * gx + P[i][1] * gy;
+  float s = gx * ph[0] + gy * ph[1] + rangeVar;
+  if (!(s > 0)) return false;
+  
+  // Выброс относительно прогноза - не принимаем
+  if (innovation * innovation > TDOA_TRACK_GATE * s) return false;
+  
+  float invS = 1.0f / s;
+  for (uint8_t i = 0; i < 4; i++) state[i] += ph[i] * innovation * invS;
+  
+  // P -= K S K^T = ph ph^T / S, только верхний треугольник - симметрия точная
+  for (uint8_t i = 0; i < 4; i++) {
+    for (uint8_t j = i; j < 4; j++) {
+      P[i][j] -= ph[i] * ph[j] * invS;
+      P[j][i] = P[i][j];
+    }
+  }
+  
+  innovationRms += innovation * innovation;
+  return true;
+}
+
+TdoaTracker::Result TdoaTracker::step(const float* anchorX, const float* anchorY,
+                                      const float* rangeDiff_m, uint8_t count, uint32_t t_us) {
+  if (count > TDOA_MAX_ANCHORS) count = TDOA_MAX_ANCHORS;
+  
+  if (!isTracking(t_us)) {
+    initialized = false;
+    if (count < 3) return TRACK_NONE;
+    
+    TdoaSolution sol = solveTdoa(anchorX, anchorY, rangeDiff_m, count);
+    if (!sol.valid) return TRACK_NONE;
+    initialize(sol, t_us);
+    return TRACK_INIT;
+  }
+  
+  if (count < 2) return TRACK_NONE;
+  predict(t_us);
+  
+  uint8_t accepted = 0;
+  innovationRms = 0;
+  for (uint8_t i = 1; i < count; i++) {
+    if (updateScalar(anchorX[i], anchorY[i], anchorX[0], anchorY[0], rangeDiff_m[i])) {
+      accepted++;
+    }
+  }
+  
+  if (accepted == 0) {
+    misses++;
+    return TRACK_REJECTED;
+  }
+  
+  innovationRms = sqrtf(innovationRms / accepted);
+  misses = 0;
+  return TRACK_UPDATE;
+}
+
+void TdoaTracker::positionAt(uint32_t t_us, float& x, float& y) const {
+  int32_t elapsed = (int32_t)(t_us - time_us);
+  float dt = elapsed > 0 ? elapsed * 1e-6f : 0;
+  x = state[0] + state[2] * dt;
+  y = state[1] + state[3] * dt;
+}
+
+float TdoaTracker::getPositionSigma() const {
+  float var = P[0][0] + P[1][1];
+  return var > 0 ? sqrtf(var) : 0;
+}
@@ -0,0 +1,202 @@
+#include "tx_queue.h"
+#include "lora_module.h"
+
+TxQueue txQueue;
+
+TxQueue::TxQueue()
+  : head(0), count(0), sending(false), batching(Config::Tx::BATCHING), deferredCurrent(false),
+    inFlight(0), sentHandler(nullptr), beaconJitter(Config::Timing::PING_INTERVAL * 1000UL),
+    maxWait_us(0), sent(0), failed(0), dropped(0), deferred(0), transmissions(0), airtime_us(0) {
+}
+
+bool TxQueue::enqueue(const char* message, uint32_t sequence, bool beacon) {
+  if (count >= Config::Tx::QUEUE_DEPTH) {
+    dropped++;
+    return false;
+  }
+  
+  Entry& entry = entries[(head + count) % Config::Tx::QUEUE_DEPTH];
+  entry.sequence = sequence;
+  entry.queued_us = micros();
+  entry.beacon = beacon;
+  entry.frameOffset = 0;
+  entry.frameLen = 0;
+  strncpy(entry.message, message, Config::Tx::MAX_FRAME);
+  entry.message[Config::Tx::MAX_FRAME] = '\0';
+  
+  count++;
+  return true;
+}
+
+size_t TxQueue::buildFrame(const Entry& entry, uint8_t* out, size_t room) {
+  if (Config::Protocol::DELTA_WIRE_FORMAT) {
+    return deltaEncoder.encode(out, room, entry.message, entry.sequence);
+  }
+  return encodeBinaryPacket(out, room, entry.message, entry.sequence);
+}
+
+void TxQueue::pop() {
+  head = (head + 1) % Config::Tx::QUEUE_DEPTH;
+  count--;
+  deferredCurrent = false;
+}
+
+void TxQueue::poll() {
+  if (sending) {
+    LoRaModule::SendState state = loraModule.pollSend();
+    if (state == LoRaModule::SEND_BUSY) return;
+    finish(state == LoRaModule::SEND_DONE);
+  }
+  
+  if (count == 0) return;
+  
+  // Модуль занят (прием, чужая передача) - кадр ждет, слот не теряется
+  if (digitalRead(Config::Pins::E32_AUX) == LOW) {
+    if (!deferredCurrent) {
+      deferredCurrent = true;
+      deferred++;
+    }
+    return;
+  }
+  
+  // Дедлайн пакета: первый кадр ждет попутные, пока очередь не заполнится
+  if (batching && count < Config::Tx::QUEUE_DEPTH &&
+      micros() - entries[head].queued_us < Config::Tx::BATCH_FLUSH_MS * 1000UL) {
+    return;
+  }
+  
+  // Сборка передачи: кадры с головы очереди, пока влезают в пакет
+  size_t used = 0;
+  inFlight = 0;
+  while (inFlight < count) {
+    Entry& entry = entries[(head + inFlight) % Config::Tx::QUEUE_DEPTH];
+    size_t room = inFlight == 0 ? Config::Tx::MAX_FRAME - FRAMING_OVERHEAD
+                                : Config::Tx::BATCH_MAX_BYTES - BATCH_PREFIX_SIZE - used - FRAMING_OVERHEAD;
+    size_t len = buildFrame(entry, frame + used, room);
+    
+    if (len == 0 || !loraModule.batchAppend(frame + used, len)) {
+      // Кадр v2 собран, но не уходит: кодер уже сдвинул точку отсчета
+      if (len != 0) deltaEncoder.forceKeyframe();
+      if (inFlight > 0) break;  // Уйдет следующей передачей
+      
+      Serial.print("ERROR: Frame too long (max ");
+      Serial.print(Config::Tx::MAX_FRAME);
+      Serial.print(" B), dropped SEQ:");
+      Serial.println(entry.sequence);
+      failed++;
+      pop();
+      return;
+    }
+    
+    entry.frameOffset = (uint8_t)used;
+    entry.frameLen = (uint8_t)len;
+    used += len;
+    inFlight++;
+    if (!batching) break;
+  }
+  
+  if (!loraModule.flushBatch()) {
+    loraModule.batchClear();  // AUX упал между проверкой и записью - соберем заново
+    deltaEncoder.forceKeyframe();  // Собранные кадры v2 не ушли - пересборка от нового ключевого
+    inFlight = 0;
+    return;
+  }
+  
+  sending = true;
+  transmissions++;
+  airtime_us += estimateAirtime_us(loraModule.getLastSendBytes());
+  
+  uint32_t start = loraModule.getSendStart_us();
+  for (uint8_t i = 0; i < inFlight; i++) {
+    const Entry& entry = entries[(head + i) % Config::Tx::QUEUE_DEPTH];
+    if (entry.beacon) beaconJitter.mark(start);
+    if (start - entry.queued_us > maxWait_us) maxWait_us = start - entry.queued_us;
+  }
+}
+
+void TxQueue::finish(bool success) {
+  uint32_t start = loraModule.getSendStart_us();
+  uint32_t duration = micros() - start;
+  
+  sending = false;
+  
+  // Ключевой кадр мог не дойти до эфира - следующий кадр v2 снова ключевой
+  if (!success) deltaEncoder.forceKeyframe();
+  
+  // Печать после передачи: вывод в USB Serial не задерживает начало кадра
+  for (uint8_t i = 0; i < inFlight; i++) {
+    Entry& entry = entries[head];
+    if (success) sent++; else failed++;
+    
+    Serial.print("TX> [");
+    Serial.print(start);
+    Serial.print("us] ");
+    Serial.print("BIN SEQ:");
+    Serial.print(entry.sequence);
+    Serial.print(" MSG:");
+    Serial.print(entry.message);
+    Serial.print(" (");
+    Serial.print(entry.frameLen);
+    if (inFlight > 1) {
+      Serial.print(" B, batch ");
+      Serial.print(i + 1);
+      Serial.print("/");
+      Serial.print(inFlight);
+      Serial.print(" of ");
+      Serial.print(loraModule.getLastSendBytes());
+    }
+    Serial.print(" B, ~");
+    Serial.print(estimateAirtime_us(loraModule.getLastSendBytes()) / 1000);
+    Serial.print(" ms air, waited ");
+    Serial.print(start - entry.queued_us);
+    Serial.print("us)");
+    
+    if (success) {
+      Serial.print(" [OK] (");
+      Serial.print(duration);
+      Serial.println("us)");
+    } else {
+      Serial.println(" [FAIL - AUX timeout!]");
+    }
+    
+    if (sentHandler) sentHandler(entry, success);
+    pop();
+  }
+  inFlight = 0;
+}
+
+float TxQueue::getFramesPerAirSecond() const {
+  return airtime_us ? (float)((double)sent * 1e6 / (double)airtime_us) : 0.0f;
+}
+
+void TxQueue::printStats(Print& out) {
+  out.print("  tx: sent=");
+  out.print(sent);
+  out.print(" failed=");
+  out.print(failed);
+  out.print(" dropped=");
+  out.print(dropped);
+  out.print(" deferred=");
+  out.print(deferred);
+  out.print(" queued=");
+  out.print(count);
+  out.print(" tx=");
+  out.print(transmissions);
+  out.print(" frames/air-s=");
+  out.print(getFramesPerAirSecond(), 2);
+  out.print(" wait_max=");
+  out.print(maxWait_us);
+  out.println("us");
+  
+  out.print("  beacon period: n=");
+  out.print(beaconJitter.count);
+  out.print(" dev min=");
+  out.print(beaconJitter.minDev_us);
+  out.print("us max=");
+  out.print(beaconJitter.maxDev_us);
+  out.print("us avg|dev|=");
+  out.print(beaconJitter.avgAbsDev_us());
+  out.println("us");
+  
+  maxWait_us = 0;
+}
@@ -0,0 +1,124 @@
+#include "uplink.h"
+
+static void putU16(uint8_t* dst, uint16_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+}
+
+static void putU32(uint8_t* dst, uint32_t v) {
+  dst[0] = (uint8_t)(v);
+  dst[1] = (uint8_t)(v >> 8);
+  dst[2] = (uint8_t)(v >> 16);
+  dst[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t getU16(const uint8_t* src) {
+  return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* src) {
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+         ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+// float как биты IEEE 754 (на AVR float тоже 32 бита)
+static void putFloat(uint8_t* dst, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  putU32(dst, bits);
+}
+
+static float getFloat(const uint8_t* src) {
+  uint32_t bits = getU32(src);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// CRC в хвост записи и кадр синхрослова
+static size_t frameRecord(uint8_t* out, size_t outSize, uint8_t* record, size_t length) {
+  putU16(record + length - UPLINK_CRC_SIZE, crc16(record, length - UPLINK_CRC_SIZE));
+  return encodeSyncFrame(out, outSize, record, length);
+}
+
+size_t encodeUplinkMeasurement(uint8_t* out, size_t outSize, const UplinkMeasurement& m) {
+  uint8_t record[UPLINK_MEASUREMENT_SIZE];
+  record[0] = UPLINK_MEASUREMENT_MAGIC;
+  record[1] = m.anchorId;
+  putU32(record + 2, (uint32_t)m.key);
+  putU32(record + 6, (uint32_t)(m.key >> 32));
+  putU16(record + 10, m.tagId);
+  putU32(record + 12, m.arrival_us);
+  putU16(record + 16, m.age_100us);
+  record[18] = m.flags;
+  record[19] = m.jitter_100ns;
+  return frameRecord(out, outSize, record, sizeof(record));
+}
+
+size_t encodeUplinkAnchor(uint8_t* out, size_t outSize, const UplinkAnchor& a) {
+  uint8_t record[UPLINK_ANCHOR_SIZE];
+  record[0] = UPLINK_ANCHOR_MAGIC;
+  record[1] = a.id;
+  putFloat(record + 2, a.x);
+  putFloat(record + 6, a.y);
+  return frameRecord(out, outSize, record, sizeof(record));
+}
+
+UplinkDecoder::Result UplinkDecoder::feed(uint8_t b) {
+  if (b == FRAME_SYNC) {
+    // Новый кадр; незаконченный предыдущий - потерянные байты
+    bool partial = cobs.isActive() && cobs.hasLength();
+    cobs.start();
+    length = 0;
+    if (!partial) return UPLINK_NONE;
+    errors++;
+    return UPLINK_ERROR;
+  }
+  if (!cobs.isActive()) return UPLINK_NONE;  // Текст лога между записями
+  
+  uint8_t value;
+  CobsDecoder::Result r = cobs.decode(b, value);
+  if (r == CobsDecoder::COBS_NONE) {
+    // Длина известна сразу: длиннее записей uplink - чужая (capture.h), не ждать ее конца
+    if (cobs.hasLength() && length == 0 && cobs.getRemaining() > UPLINK_MAX_RECORD) {
+      cobs.stop();
+    }
+    return UPLINK_NONE;
+  }
+  if (r == CobsDecoder::COBS_ERROR) {
+    errors++;
+    return UPLINK_ERROR;
+  }
+  
+  buffer[length++] = value;
+  return cobs.isActive() ? UPLINK_NONE : complete();
+}
+
+UplinkDecoder::Result UplinkDecoder::complete() {
+  // Записи другого типа (capture.h) идут в тот же порт
+  if (buffer[0] != UPLINK_MEASUREMENT_MAGIC && buffer[0] != UPLINK_ANCHOR_MAGIC) return UPLINK_NONE;
+  
+  size_t size = buffer[0] == UPLINK_MEASUREMENT_MAGIC ? UPLINK_MEASUREMENT_SIZE : UPLINK_ANCHOR_SIZE;
+  if (length != size ||
+      crc16(buffer, size - UPLINK_CRC_SIZE) != getU16(buffer + size - UPLINK_CRC_SIZE)) {
+    errors++;
+    return UPLINK_ERROR;
+  }
+  records++;
+  
+  if (buffer[0] == UPLINK_ANCHOR_MAGIC) {
+    anchorInfo.id = buffer[1];
+    anchorInfo.x = getFloat(buffer + 2);
+    anchorInfo.y = getFloat(buffer + 6);
+    return UPLINK_ANCHOR;
+  }
+  
+  meas.anchorId = buffer[1];
+  meas.key = (uint64_t)getU32(buffer + 2) | ((uint64_t)getU32(buffer + 6) << 32);
+  meas.tagId = getU16(buffer + 10);
+  meas.arrival_us = getU32(buffer + 12);
+  meas.age_100us = getU16(buffer + 16);
+  meas.flags = buffer[18];
+  meas.jitter_100ns = buffer[19];
+  return UPLINK_MEASUREMENT;
+}
@@ -0,0 +1,196 @@
+/*
+  Arduino shim для native сборки: String, Print, Serial, GPIO, прерывания
+  и часы поверх виртуального времени симулятора (sim_radio.cpp).
+*/
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "sim_radio.h"
+
+HardwareSerial Serial(0);
+
+// ===== Время =====
+
+uint32_t micros() {
+  return (uint32_t)Sim::now_us();
+}
+
+uint32_t millis() {
+  return (uint32_t)(Sim::now_us() / 1000);
+}
+
+void delay(uint32_t ms) {
+  Sim::advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  Sim::advance(us);
+}
+
+void yield() {
+}
+
+// ===== GPIO и прерывания =====
+
+static const uint8_t PIN_COUNT = 64;
+
+static uint8_t pinLevels[PIN_COUNT];
+static void (*pinIsr[PIN_COUNT])();
+static int pinIsrMode[PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < PIN_COUNT && mode == INPUT_PULLUP) pinLevels[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < PIN_COUNT ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < PIN_COUNT) pinLevels[pin] = value ? HIGH : LOW;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+  if (interrupt < 0 || interrupt >= PIN_COUNT) return;
+  pinIsr[interrupt] = isr;
+  pinIsrMode[interrupt] = mode;
+}
+
+void detachInterrupt(int interrupt) {
+  if (interrupt < 0 || interrupt >= PIN_COUNT) return;
+  pinIsr[interrupt] = nullptr;
+}
+
+void Sim::setPinLevel(uint8_t pin, int level) {
+  if (pin >= PIN_COUNT) return;
+  
+  uint8_t previous = pinLevels[pin];
+  pinLevels[pin] = level ? HIGH : LOW;
+  if (previous == pinLevels[pin] || !pinIsr[pin]) return;
+  
+  int mode = pinIsrMode[pin];
+  bool falling = (pinLevels[pin] == LOW);
+  if (mode == CHANGE || (mode == FALLING && falling) || (mode == RISING && !falling)) {
+    pinIsr[pin]();
+  }
+}
+
+// ===== String =====
+
+void String::fromUnsigned(unsigned long v, unsigned char base) {
+  char buf[8 * sizeof(v) + 1];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    uint8_t digit = v % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    v /= base;
+  } while (v);
+  str = p;
+}
+
+void String::fromSigned(long v, unsigned char base) {
+  if (v < 0 && base == DEC) {
+    fromUnsigned((unsigned long)-v, base);
+    str.insert(str.begin(), '-');
+  } else {
+    fromUnsigned((unsigned long)v, base);
+  }
+}
+
+void String::fromDouble(double v, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+  str = buf;
+}
+
+// ===== Print =====
+
+size_t Print::write(const uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buf++);
+  return n;
+}
+
+size_t Print::printNumber(unsigned long long v, int base) {
+  char buf[8 * sizeof(v) + 1];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    uint8_t digit = v % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    v /= base;
+  } while (v);
+  return write(p);
+}
+
+size_t Print::printSigned(long long v, int base) {
+  if (v < 0 && base == DEC) {
+    size_t n = write((uint8_t)'-');
+    return n + printNumber((unsigned long long)-v, base);
+  }
+  return printNumber((unsigned long long)v, base);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
+
+// ===== HardwareSerial =====
+
+HardwareSerial::HardwareSerial(int uartNum)
+  : uart(uartNum), baud(0), echo(false), txSink(nullptr), txSinkCtx(nullptr),
+    rxCapacity(256), rxHead(0), rxCount(0), overflows(0) {
+}
+
+void HardwareSerial::begin(uint32_t baudRate, uint32_t /*config*/, int8_t /*rxPin*/, int8_t /*txPin*/) {
+  baud = baudRate;
+}
+
+void HardwareSerial::setRxBufferSize(size_t size) {
+  rxCapacity = size < MAX_RX_BUFFER ? size : MAX_RX_BUFFER;
+  rxHead = 0;
+  rxCount = 0;
+}
+
+int HardwareSerial::available() {
+  return (int)rxCount;
+}
+
+int HardwareSerial::read() {
+  if (rxCount == 0) return -1;
+  uint8_t b = rxBuffer[rxHead];
+  rxHead = (rxHead + 1) % rxCapacity;
+  rxCount--;
+  return b;
+}
+
+int HardwareSerial::peek() {
+  return rxCount ? rxBuffer[rxHead] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+  if (echo) fputc(b, stdout);
+  if (txSink) txSink(txSinkCtx, &b, 1);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+  if (echo) fwrite(buf, 1, size, stdout);
+  if (txSink) txSink(txSinkCtx, buf, size);
+  return size;
+}
+
+bool HardwareSerial::inject(uint8_t b) {
+  if (rxCount >= rxCapacity) {
+    overflows++;
+    return false;
+  }
+  rxBuffer[(rxHead + rxCount) % rxCapacity] = b;
+  rxCount++;
+  return true;
+}
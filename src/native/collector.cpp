@@ -0,0 +1,559 @@
+/*
+  Host collector: записи anchor (uplink.h) -> объединение по кадру -> TDOA
+
+  Сборка и запуск:
+    pio run -e native_collector
+    .pio/build/native_collector/program [-w <ms>] <port|file> [<port|file> ...]
+    .pio/build/native_collector/program --bench
+
+  Каждый путь - USB Serial одного anchor (порт настраивается заранее, например
+  stty -F /dev/ttyUSB0 115200 raw) или файл с записанным потоком. Поток
+  чтения на источник разбирает записи, объединение и решение - в основном
+  потоке. Записи одного кадра (frameKey) ждут остальные anchor в окне
+  JOIN_WINDOW_MS от первой: ответили все известные anchor - решение сразу,
+  окно истекло - по тем, что есть (3+). Координаты anchor - из их записей.
+  stdout: строка FIX на решение. stderr: раз в REPORT_PERIOD_MS записей/с,
+  решения и перцентили задержки от начала кадра в эфире до решения
+  (возраст записи на anchor + путь до коллектора + ожидание в окне).
+
+  --bench: синтетические anchor и теги, те же UplinkDecoder, объединение и
+  solveTdoa на потоке записей в виртуальном времени; между записями - строки
+  лога, часть записей теряется. Пропускная способность - записи в секунду
+  CPU хоста, задержка решения и ошибка позиции. Код возврата != 0, если
+  ниже MIN_RECORDS_PER_S, решен не каждый кадр с 3+ записями или ошибка
+  выше предела квантования меток в 1 us.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include "uplink.h"
+#include "tdoa_solver.h"
+
+#ifndef O_BINARY
+  #define O_BINARY 0
+#endif
+
+static const uint32_t JOIN_WINDOW_MS    = 250;   // Разброс задержек anchor до коллектора
+static const uint32_t REPORT_PERIOD_MS  = 5000;
+
+// ===== Объединение записей по кадру =====
+
+struct Fix {
+  uint64_t key;
+  uint16_t tagId;
+  uint8_t anchors;
+  uint32_t frame_us;       // Начало кадра в шкале опорного anchor
+  uint64_t latency_us;     // От начала кадра в эфире до решения
+  uint64_t wait_us;        // Ожидание в окне от первой записи
+  TdoaSolution solution;
+};
+
+class Collector {
+public:
+  typedef void (*FixHandler)(void* ctx, const Fix& fix);
+  
+  Collector(uint32_t window_us, FixHandler handler, void* ctx)
+    : window_us(window_us), handler(handler), handlerCtx(ctx),
+      records(0), fixes(0), incomplete(0), failed(0), late(0) {}
+  
+  void addAnchor(const UplinkAnchor& anchor) { anchors[anchor.id] = anchor; }
+  size_t getAnchorCount() const { return anchors.size(); }
+  
+  // now_us - время коллектора (монотонное)
+  void addMeasurement(const UplinkMeasurement& m, uint64_t now_us) {
+    records++;
+    
+    auto it = pending.find(m.key);
+    if (it == pending.end()) {
+      Pending p;
+      p.first_us = now_us;
+      p.airStart_us = now_us;
+      p.tagId = m.tagId;
+      p.count = 0;
+      p.solved = false;
+      it = pending.emplace(m.key, p).first;
+      deadlines.push_back(std::make_pair(now_us + window_us, m.key));
+    }
+    
+    Pending& p = it->second;
+    if (p.solved) {
+      late++;  // Пришла после решения по всем известным anchor
+      return;
+    }
+    
+    // Начало кадра по часам коллектора: прием записи минус ее возраст
+    uint64_t age_us = (uint64_t)m.age_100us * 100;
+    uint64_t airStart = now_us > age_us ? now_us - age_us : 0;
+    if (airStart < p.airStart_us) p.airStart_us = airStart;
+    
+    uint8_t slot = p.count;
+    for (uint8_t i = 0; i < p.count; i++) {
+      if (p.anchorIds[i] == m.anchorId) slot = i;  // Повтор от того же anchor
+    }
+    if (slot >= TDOA_MAX_ANCHORS) return;
+    p.anchorIds[slot] = m.anchorId;
+    p.arrival_us[slot] = m.arrival_us;
+    if (slot == p.count) p.count++;
+    
+    if (anchors.size() >= 3 && p.count >= anchors.size()) solve(m.key, p, now_us);
+  }
+  
+  // Истекшие окна: решение по тому, что собрано (время решения - конец окна)
+  void expire(uint64_t now_us) {
+    while (!deadlines.empty() && deadlines.front().first <= now_us) {
+      uint64_t deadline = deadlines.front().first;
+      auto it = pending.find(deadlines.front().second);
+      deadlines.pop_front();
+      if (it == pending.end()) continue;
+      if (!it->second.solved) solve(it->first, it->second, deadline);
+      pending.erase(it);
+    }
+  }
+  
+  uint32_t getRecords() const { return records; }
+  uint32_t getFixes() const { return fixes; }
+  uint32_t getIncomplete() const { return incomplete; }
+  uint32_t getFailed() const { return failed; }
+  uint32_t getLate() const { return late; }
+  size_t getPending() const { return pending.size(); }
+  
+private:
+  struct Pending {
+    uint64_t first_us;
+    uint64_t airStart_us;
+    uint32_t arrival_us[TDOA_MAX_ANCHORS];
+    uint8_t anchorIds[TDOA_MAX_ANCHORS];
+    uint8_t count;
+    uint16_t tagId;
+    bool solved;
+  };
+  
+  uint32_t window_us;
+  FixHandler handler;
+  void* handlerCtx;
+  std::map<uint8_t, UplinkAnchor> anchors;
+  std::unordered_map<uint64_t, Pending> pending;
+  std::deque<std::pair<uint64_t, uint64_t>> deadlines;  // Окно постоянное - по возрастанию
+  uint32_t records;
+  uint32_t fixes;
+  uint32_t incomplete;   // Окно истекло, anchor с координатами меньше 3
+  uint32_t failed;       // Решатель не сошелся
+  uint32_t late;
+  
+  void solve(uint64_t key, Pending& p, uint64_t now_us) {
+    p.solved = true;
+    
+    // Опорный - самый ранний прием: разности неотрицательны
+    float ax[TDOA_MAX_ANCHORS], ay[TDOA_MAX_ANCHORS], rangeDiff[TDOA_MAX_ANCHORS];
+    uint32_t times[TDOA_MAX_ANCHORS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < p.count; i++) {
+      auto a = anchors.find(p.anchorIds[i]);
+      if (a == anchors.end()) continue;
+      ax[count] = a->second.x;
+      ay[count] = a->second.y;
+      times[count] = p.arrival_us[i];
+      if (count > 0 && (int32_t)(times[count] - times[0]) < 0) {
+        std::swap(ax[0], ax[count]);
+        std::swap(ay[0], ay[count]);
+        std::swap(times[0], times[count]);
+      }
+      count++;
+    }
+    if (count < 3) {
+      incomplete++;
+      return;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+      rangeDiff[i] = SPEED_OF_LIGHT_M_PER_US * (float)(int32_t)(times[i] - times[0]);
+    }
+    
+    Fix fix;
+    fix.key = key;
+    fix.tagId = p.tagId;
+    fix.anchors = count;
+    fix.frame_us = times[0];
+    fix.latency_us = now_us - p.airStart_us;
+    fix.wait_us = now_us - p.first_us;
+    fix.solution = solveTdoa(ax, ay, rangeDiff, count);
+    if (!fix.solution.valid) {
+      failed++;
+      return;
+    }
+    fixes++;
+    handler(handlerCtx, fix);
+  }
+};
+
+// Перцентиль по отсортированной выборке
+static double percentile(const std::vector<uint64_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+  return (double)sorted[i];
+}
+
+// ===== Живой режим: порты anchor =====
+
+struct TimedRecord {
+  uint64_t host_us;
+  bool anchor;
+  UplinkMeasurement measurement;
+  UplinkAnchor anchorInfo;
+};
+
+struct Inbox {
+  std::mutex lock;
+  std::condition_variable ready;
+  std::vector<TimedRecord> records;
+  size_t openSources = 0;
+  uint32_t decodeErrors = 0;
+};
+
+static uint64_t hostNow_us() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Поток источника: read() отдает то, что уже пришло в драйвер
+static void readSource(const char* path, Inbox* inbox) {
+  int fd = open(path, O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    fprintf(stderr, "%s: cannot open\n", path);
+  } else {
+    UplinkDecoder decoder;
+    uint8_t buf[512];
+    std::vector<TimedRecord> batch;
+    uint32_t reportedErrors = 0;
+    
+    for (;;) {
+      ssize_t n = read(fd, buf, sizeof(buf));
+      if (n <= 0) break;
+      uint64_t now = hostNow_us();
+      
+      for (ssize_t i = 0; i < n; i++) {
+        UplinkDecoder::Result r = decoder.feed(buf[i]);
+        if (r != UplinkDecoder::UPLINK_MEASUREMENT && r != UplinkDecoder::UPLINK_ANCHOR) continue;
+        TimedRecord rec;
+        rec.host_us = now;
+        rec.anchor = r == UplinkDecoder::UPLINK_ANCHOR;
+        rec.measurement = decoder.measurement();
+        rec.anchorInfo = decoder.anchor();
+        batch.push_back(rec);
+      }
+      if (batch.empty()) continue;
+      
+      std::lock_guard<std::mutex> guard(inbox->lock);
+      inbox->records.insert(inbox->records.end(), batch.begin(), batch.end());
+      inbox->decodeErrors += decoder.getErrors() - reportedErrors;
+      reportedErrors = decoder.getErrors();
+      batch.clear();
+      inbox->ready.notify_one();
+    }
+    close(fd);
+    fprintf(stderr, "%s: closed (%u records, %u bad)\n", path, decoder.getRecords(), decoder.getErrors());
+    
+    std::lock_guard<std::mutex> guard(inbox->lock);
+    inbox->decodeErrors += decoder.getErrors() - reportedErrors;
+    inbox->openSources--;
+    inbox->ready.notify_one();
+    return;
+  }
+  
+  std::lock_guard<std::mutex> guard(inbox->lock);
+  inbox->openSources--;
+  inbox->ready.notify_one();
+}
+
+struct LiveStats {
+  std::vector<uint64_t> latencies;
+  std::vector<uint64_t> waits;
+};
+
+static void printFix(void* ctx, const Fix& fix) {
+  LiveStats* stats = (LiveStats*)ctx;
+  stats->latencies.push_back(fix.latency_us);
+  stats->waits.push_back(fix.wait_us);
+  printf("FIX tag=%u key=%016llx t_us=%u x=%.2f y=%.2f res_m=%.2f gdop=%.2f anchors=%u lat_ms=%.1f\n",
+         fix.tagId, (unsigned long long)fix.key, fix.frame_us, fix.solution.x, fix.solution.y,
+         fix.solution.residual_m, fix.solution.gdop, fix.anchors, fix.latency_us / 1000.0);
+  fflush(stdout);
+}
+
+static void printLiveReport(Collector& collector, LiveStats& stats, uint32_t records,
+                            uint32_t decodeErrors, double seconds) {
+  std::sort(stats.latencies.begin(), stats.latencies.end());
+  std::sort(stats.waits.begin(), stats.waits.end());
+  fprintf(stderr, "records %.0f/s, fixes %zu, anchors %zu, pending %zu, incomplete %u, failed %u, "
+                  "late %u, bad %u | latency p50 %.1f p99 %.1f max %.1f ms, wait p50 %.1f ms\n",
+          records / seconds, stats.latencies.size(), collector.getAnchorCount(), collector.getPending(),
+          collector.getIncomplete(), collector.getFailed(), collector.getLate(), decodeErrors,
+          percentile(stats.latencies, 0.5) / 1000.0, percentile(stats.latencies, 0.99) / 1000.0,
+          stats.latencies.empty() ? 0.0 : stats.latencies.back() / 1000.0,
+          percentile(stats.waits, 0.5) / 1000.0);
+  stats.latencies.clear();
+  stats.waits.clear();
+}
+
+static int runLive(const std::vector<const char*>& paths, uint32_t window_ms) {
+  Inbox inbox;
+  inbox.openSources = paths.size();
+  LiveStats stats;
+  Collector collector(window_ms * 1000, printFix, &stats);
+  
+  std::vector<std::thread> readers;
+  for (const char* path : paths) readers.push_back(std::thread(readSource, path, &inbox));
+  
+  std::vector<TimedRecord> records;
+  uint64_t reportStart = hostNow_us();
+  uint32_t reportRecords = 0;
+  bool open = true;
+  
+  while (open || collector.getPending() > 0) {
+    {
+      std::unique_lock<std::mutex> guard(inbox.lock);
+      inbox.ready.wait_for(guard, std::chrono::milliseconds(10),
+                           [&] { return !inbox.records.empty() || inbox.openSources == 0; });
+      records.swap(inbox.records);
+      open = inbox.openSources > 0;
+    }
+    
+    for (const TimedRecord& rec : records) {
+      if (rec.anchor) {
+        collector.addAnchor(rec.anchorInfo);
+      } else {
+        collector.addMeasurement(rec.measurement, rec.host_us);
+        reportRecords++;
+      }
+    }
+    records.clear();
+    
+    // Источники закрыты (файлы) - дожидаться окон не нужно
+    uint64_t now = hostNow_us();
+    collector.expire(open ? now : UINT64_MAX);
+    
+    if (now - reportStart >= REPORT_PERIOD_MS * 1000ULL || !open) {
+      uint32_t decodeErrors;
+      {
+        std::lock_guard<std::mutex> guard(inbox.lock);
+        decodeErrors = inbox.decodeErrors;
+      }
+      printLiveReport(collector, stats, reportRecords, decodeErrors, (now - reportStart) / 1e6);
+      reportStart = now;
+      reportRecords = 0;
+    }
+  }
+  
+  for (std::thread& t : readers) t.join();
+  return 0;
+}
+
+// ===== --bench: синтетические anchor =====
+
+static const uint8_t  BENCH_ANCHORS        = 4;
+static const float    BENCH_AREA_M         = 3000.0f;    // Площадка LoRa: anchor по углам
+static const uint16_t BENCH_TAGS           = 16;
+static const uint32_t BENCH_FRAMES         = 50000;
+static const uint32_t BENCH_FRAME_PERIOD_US = 250;       // Кадры всех тегов: 4000/s, записей 16000/s
+static const uint32_t BENCH_ANCHOR_DELAY_US = 5000;      // Обработка на anchor + USB
+static const uint32_t BENCH_ANCHOR_JITTER_US = 20000;
+static const uint32_t BENCH_LOSS_PERMILLE  = 20;         // Записи, не дошедшие до коллектора
+static const uint32_t BENCH_LOG_EVERY      = 16;         // Строка лога между записями
+static const double   MIN_RECORDS_PER_S    = 5000;       // "Тысячи записей в секунду"
+static const float    MAX_ERROR_P50_M      = SPEED_OF_LIGHT_M_PER_US;  // Метки целые us
+
+static uint32_t benchRng = 0x0C011EC7;
+
+static uint32_t benchRandom() {
+  benchRng ^= benchRng << 13;
+  benchRng ^= benchRng >> 17;
+  benchRng ^= benchRng << 5;
+  return benchRng;
+}
+
+// Байты одного порта к моменту host_us
+struct BenchChunk {
+  uint64_t host_us;
+  uint8_t source;
+  uint8_t length;
+  uint8_t bytes[UPLINK_MAX_FRAME + 64];  // Запись и строка лога
+};
+
+struct BenchTruth {
+  float x;
+  float y;
+};
+
+struct BenchStats {
+  const std::vector<BenchTruth>* truth;
+  std::vector<uint64_t> latencies;
+  std::vector<uint64_t> waits;
+  std::vector<uint64_t> errors_cm;
+};
+
+static void benchFix(void* ctx, const Fix& fix) {
+  BenchStats* stats = (BenchStats*)ctx;
+  const BenchTruth& t = (*stats->truth)[(size_t)fix.key];  // Ключ - номер кадра
+  float dx = fix.solution.x - t.x;
+  float dy = fix.solution.y - t.y;
+  stats->errors_cm.push_back((uint64_t)(sqrtf(dx * dx + dy * dy) * 100.0f));
+  stats->latencies.push_back(fix.latency_us);
+  stats->waits.push_back(fix.wait_us);
+}
+
+static int runBench() {
+  const float anchorXY[BENCH_ANCHORS][2] = {
+    {0, 0}, {BENCH_AREA_M, 0}, {BENCH_AREA_M, BENCH_AREA_M}, {0, BENCH_AREA_M}
+  };
+  
+  // Поток каждого порта: записи anchor, измерения, строки лога
+  std::vector<BenchChunk> chunks;
+  chunks.reserve(BENCH_FRAMES * BENCH_ANCHORS + BENCH_ANCHORS);
+  std::vector<BenchTruth> truth(BENCH_FRAMES);
+  uint32_t expectedFixes = 0;
+  
+  for (uint8_t a = 0; a < BENCH_ANCHORS; a++) {
+    BenchChunk c;
+    c.host_us = 0;
+    c.source = a;
+    UplinkAnchor info;
+    info.id = a;
+    info.x = anchorXY[a][0];
+    info.y = anchorXY[a][1];
+    c.length = (uint8_t)encodeUplinkAnchor(c.bytes, sizeof(c.bytes), info);
+    chunks.push_back(c);
+  }
+  
+  for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+    uint64_t air_us = 1000 + (uint64_t)frame * BENCH_FRAME_PERIOD_US;
+    uint16_t tag = (uint16_t)(1 + frame % BENCH_TAGS);
+    
+    // Тег: своя окружность вокруг центра площадки
+    float phase = frame * 0.001f + tag;
+    float radius = BENCH_AREA_M * (0.1f + 0.02f * tag);
+    truth[frame].x = BENCH_AREA_M / 2 + radius * cosf(phase);
+    truth[frame].y = BENCH_AREA_M / 2 + radius * sinf(phase);
+    
+    uint8_t delivered = 0;
+    for (uint8_t a = 0; a < BENCH_ANCHORS; a++) {
+      if (benchRandom() % 1000 < BENCH_LOSS_PERMILLE) continue;
+      delivered++;
+      
+      float dx = truth[frame].x - anchorXY[a][0];
+      float dy = truth[frame].y - anchorXY[a][1];
+      double flight_us = sqrt(dx * dx + dy * dy) / SPEED_OF_LIGHT_M_PER_US;
+      
+      uint64_t host_us = air_us + BENCH_ANCHOR_DELAY_US + benchRandom() % BENCH_ANCHOR_JITTER_US;
+      UplinkMeasurement m;
+      m.key = frame;  // Индекс истины
+      m.tagId = tag;
+      m.anchorId = a;
+      m.arrival_us = (uint32_t)llround((double)air_us + flight_us);
+      m.age_100us = (uint16_t)((host_us - air_us - 1000) / 100);  // Без пути USB (~1 ms)
+      m.flags = UPLINK_FLAG_AUX;
+      
+      BenchChunk c;
+      c.host_us = host_us;
+      c.source = a;
+      c.length = (uint8_t)encodeUplinkMeasurement(c.bytes, sizeof(c.bytes), m);
+      if (frame % BENCH_LOG_EVERY == a) {
+        static const char line[] = "I 123456 RX SEQ:42 lat 1234 us\r\n";
+        static_assert(UPLINK_MAX_FRAME + sizeof(line) - 1 <= sizeof(c.bytes), "log line");
+        memcpy(c.bytes + c.length, line, sizeof(line) - 1);
+        c.length += sizeof(line) - 1;
+      }
+      chunks.push_back(c);
+    }
+    if (delivered >= 3) expectedFixes++;
+  }
+  
+  std::stable_sort(chunks.begin(), chunks.end(),
+                   [](const BenchChunk& a, const BenchChunk& b) { return a.host_us < b.host_us; });
+  
+  BenchStats stats;
+  stats.truth = &truth;
+  Collector collector(JOIN_WINDOW_MS * 1000, benchFix, &stats);
+  UplinkDecoder decoders[BENCH_ANCHORS];
+  uint64_t bytes = 0;
+  
+  auto start = std::chrono::steady_clock::now();
+  for (const BenchChunk& c : chunks) {
+    collector.expire(c.host_us);
+    UplinkDecoder& decoder = decoders[c.source];
+    for (uint8_t i = 0; i < c.length; i++) {
+      UplinkDecoder::Result r = decoder.feed(c.bytes[i]);
+      if (r == UplinkDecoder::UPLINK_MEASUREMENT) {
+        collector.addMeasurement(decoder.measurement(), c.host_us);
+      } else if (r == UplinkDecoder::UPLINK_ANCHOR) {
+        collector.addAnchor(decoder.anchor());
+      }
+    }
+    bytes += c.length;
+  }
+  collector.expire(UINT64_MAX);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  
+  uint32_t decodeErrors = 0;
+  for (const UplinkDecoder& d : decoders) decodeErrors += d.getErrors();
+  double recordsPerS = collector.getRecords() / seconds;
+  
+  std::sort(stats.latencies.begin(), stats.latencies.end());
+  std::sort(stats.waits.begin(), stats.waits.end());
+  std::sort(stats.errors_cm.begin(), stats.errors_cm.end());
+  double errorP50 = percentile(stats.errors_cm, 0.5) / 100.0;
+  
+  printf("Collector: %u anchors, %u tags, %u frames (%u/s), record loss %.1f%%, join window %u ms\n",
+         BENCH_ANCHORS, BENCH_TAGS, BENCH_FRAMES, 1000000 / BENCH_FRAME_PERIOD_US,
+         BENCH_LOSS_PERMILLE / 10.0, JOIN_WINDOW_MS);
+  printf("%9s %9s %7s %9s %6s %6s %12s %9s\n",
+         "records", "bytes", "bad", "fixes", "want", "incomp", "records/s", "ns/rec");
+  printf("%9u %9llu %7u %9u %6u %6u %12.0f %9.1f\n",
+         collector.getRecords(), (unsigned long long)bytes, decodeErrors, collector.getFixes(),
+         expectedFixes, collector.getIncomplete(), recordsPerS, seconds * 1e9 / collector.getRecords());
+  printf("\n%10s %10s %10s %10s %10s %10s %10s\n",
+         "lat_p50_ms", "lat_p99_ms", "lat_max_ms", "wait_p50", "wait_p99", "err_p50_m", "err_p99_m");
+  printf("%10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+         percentile(stats.latencies, 0.5) / 1000.0, percentile(stats.latencies, 0.99) / 1000.0,
+         stats.latencies.empty() ? 0.0 : stats.latencies.back() / 1000.0,
+         percentile(stats.waits, 0.5) / 1000.0, percentile(stats.waits, 0.99) / 1000.0,
+         errorP50, percentile(stats.errors_cm, 0.99) / 100.0);
+  
+  bool pass = recordsPerS >= MIN_RECORDS_PER_S && decodeErrors == 0 &&
+              collector.getFixes() == expectedFixes && errorP50 <= MAX_ERROR_P50_M;
+  printf("\n%s\n", pass ? "PASS" : "FAIL");
+  return pass ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  uint32_t window_ms = JOIN_WINDOW_MS;
+  std::vector<const char*> paths;
+  
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--bench") == 0) return runBench();
+    if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      window_ms = (uint32_t)atoi(argv[++i]);
+      continue;
+    }
+    paths.push_back(argv[i]);
+  }
+  
+  if (paths.empty()) {
+    fprintf(stderr, "Usage: %s [-w <join window ms>] <port|file> [<port|file> ...]\n"
+                    "       %s --bench\n", argv[0], argv[0]);
+    return 2;
+  }
+  return runLive(paths, window_ms);
+}
@@ -0,0 +1,708 @@
+/*
+  Host benchmark: RX/TX тракт LoRaModule + PacketParser на симуляторе E32
+
+  Запуск:
+    pio run -e native_radio_bench -t exec
+
+  RX: удаленный тег передает кадры (текст/бинарь, разные payload, потери и
+  искажения байт), цикл приема повторяет loop() из rx_main.cpp:
+  LoRaModule::read() -> PacketParser -> calculateRxStats -> TDOANavigator.
+  Время виртуальное, CPU хоста меряется
+  отдельно. TX: блокировка sendMessage против эфира симулятора и оценки
+  estimateAirtime_us. Пакеты кадров (0xBF): разбор на RX с общей меткой
+  начала и выигрыш в кадрах на секунду эфира на TX. Пейсинг beacon: загрузка
+  канала и вероятность коллизии против бюджетов Config::Pacing. Кадрирование:
+  поток кадров подряд с одной ошибкой (потеря, искажение, вставка байта,
+  потеря последнего байта) на каждый N-й кадр - потери кадров на ошибку без
+  синхрослова и с ним (COBS_FRAMING); смешанный поток кадров с синхрословом
+  и без (старые теги). Обертки parsePacket/decodeBinaryPacket:
+  кадр целиком туда и обратно.
+
+  Код возврата != 0, если без потерь байт потерян кадр, метка начала кадра
+  разошлась с эфиром симулятора, искаженный кадр прошел проверку CRC или
+  с синхрословом ошибка стоит больше одного кадра или обертка не разобрала
+  свой кадр - для прогонов в CI.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "config.h"
+#include "lora_module.h"
+#include "packet.h"
+#include "tdoa.h"
+#include "sequence_tracker.h"
+#include "sim_radio.h"
+#include "beacon_pacer.h"
+#include <math.h>
+
+static const uint32_t FRAMES_PER_CASE   = 500;
+static const uint32_t LOOP_PERIOD_US    = 200;   // Период опроса UART в loop()
+static const uint32_t MAX_ARRIVAL_ERR_US = 2;    // Допуск метки начала кадра без потерь
+
+struct CaseResult {
+  size_t frameBytes;
+  uint32_t ok;
+  uint32_t corrupted;
+  uint32_t errors;
+  uint32_t crcErrors;      // Из errors: отказ по CRC
+  uint32_t seqLost;        // Оценка SequenceTracker (без хвоста после последнего кадра)
+  uint32_t latencyP50_us;
+  uint32_t latencyMax_us;
+  uint32_t arrivalErrMax_us;
+  double hostNsPerByte;
+};
+
+enum WireFormat { WIRE_TEXT, WIRE_BINARY, WIRE_DELTA, WIRE_FORMAT_COUNT };
+static const char* const FORMAT_NAMES[WIRE_FORMAT_COUNT] = {"text", "binary", "delta"};
+
+// Кодер v2 тега: пересоздается на каждый прогон (новый поток, первый кадр ключевой)
+static DeltaEncoder tagEncoder;
+
+// Кадр тега: текст с терминатором, бинарный v1 или v2 (дельта)
+static size_t buildFrame(uint8_t* out, WireFormat format, const char* message, uint32_t seq) {
+  if (format == WIRE_DELTA) {
+    return tagEncoder.encode(out, BINARY_MAX_FRAME, message, seq);
+  }
+  if (format == WIRE_BINARY) {
+    return encodeBinaryPacket(out, BINARY_MAX_FRAME, message, seq);
+  }
+  return buildPacket(out, TEXT_MAX_FRAME, message, seq);
+}
+
+// Передача в эфир: кадр как есть или с синхрословом, как LoRaModule
+static size_t toWire(uint8_t* wire, size_t wireSize, const uint8_t* frame, size_t len) {
+  if (Config::Protocol::COBS_FRAMING) return encodeSyncFrame(wire, wireSize, frame, len);
+  memcpy(wire, frame, len);
+  return len;
+}
+
+// Канал: потеря и искажение байт
+struct Channel {
+  float byteLoss;
+  float bitFlip;
+};
+
+static CaseResult runRxCase(WireFormat format, const String& message, const Channel& channel) {
+  SimRadioConfig cfg;
+  cfg.byteLoss = channel.byteLoss;
+  cfg.bitFlip = channel.bitFlip;
+  cfg.seed = 0xC0FFEE;
+  simRadio.configure(cfg);
+  simRadio.resetStats();
+  
+  PacketParser parser;
+  SequenceTracker tracker;
+  loraModule.resetFrameTiming();
+  
+  CaseResult result;
+  memset(&result, 0, sizeof(result));
+  
+  std::vector<uint64_t> airStart(FRAMES_PER_CASE);
+  std::vector<uint32_t> latencies;
+  latencies.reserve(FRAMES_PER_CASE);
+  
+  uint8_t frame[BINARY_MAX_FRAME + 64];
+  uint8_t wire[sizeof(frame) + FRAME_SYNC_OVERHEAD];
+  tagEncoder = DeltaEncoder();
+  result.frameBytes = buildFrame(frame, format, message.c_str(), 0) + FRAMING_OVERHEAD;
+  tagEncoder = DeltaEncoder();  // Пробный кадр не должен сдвигать поток
+  
+  // Период кадров: эфир + выдача на UART + запас
+  uint64_t period_us = (uint64_t)simRadio.airtime_us(result.frameBytes) * 2 +
+                       result.frameBytes * simRadio.byteTime_us() + 50000;
+  uint64_t nextTx = Sim::now_us();
+  uint32_t sent = 0;
+  uint64_t hostNs = 0;
+  uint32_t bytesRead = 0;
+  
+  while (sent < FRAMES_PER_CASE || Sim::now_us() < nextTx + period_us) {
+    if (sent < FRAMES_PER_CASE && Sim::now_us() >= nextTx) {
+      size_t len = buildFrame(frame, format, message.c_str(), sent);
+      len = toWire(wire, sizeof(wire), frame, len);
+      if (len > result.frameBytes) result.frameBytes = len;  // v2: самый длинный кадр
+      airStart[sent] = Sim::now_us();
+      simRadio.injectAir(wire, len);
+      sent++;
+      nextTx += period_us;
+    }
+    
+    if (loraModule.available() == 0) {
+      Sim::advance(LOOP_PERIOD_US);
+      continue;
+    }
+    
+    // Тело loop() приемника
+    auto start = std::chrono::steady_clock::now();
+    while (loraModule.available() > 0) {
+      char c = loraModule.read();
+      bytesRead++;
+      PacketParser::Result res = parser.feed((uint8_t)c);
+      
+      if (res == PacketParser::FRAME_OK) {
+        const PacketData& packet = parser.packet();
+        RxStats stats = calculateRxStats(packet, loraModule.takeFrameTiming(parser));
+        if (tracker.track(packet.sequence) == SequenceTracker::SEQ_DUPLICATE) continue;
+        tdoaNavigator.processRxPacket(packet, stats);
+        
+        // Период больше времени кадра: на UART всегда последний переданный.
+        // Другой SEQ - потеря байт исказила кадр, но он прошел разбор.
+        uint32_t index = sent - 1;
+        if (packet.sequence != index) {
+          result.corrupted++;
+          continue;
+        }
+        
+        uint64_t truth = airStart[index];
+        int32_t err = (int32_t)(stats.arrivalTime_us() - (uint32_t)truth);
+        uint32_t absErr = err < 0 ? -err : err;
+        if (absErr > result.arrivalErrMax_us) result.arrivalErrMax_us = absErr;
+        latencies.push_back((uint32_t)(Sim::now_us() - truth));
+        result.ok++;
+      } else if (res == PacketParser::FRAME_ERROR) {
+        loraModule.takeFrameTiming(parser);
+        result.errors++;
+      } else if (!parser.inFrame()) {
+        loraModule.resetFrameTiming();
+      }
+    }
+    hostNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    
+    Sim::advance(LOOP_PERIOD_US);
+  }
+  
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    result.latencyP50_us = latencies[latencies.size() / 2];
+    result.latencyMax_us = latencies.back();
+  }
+  result.crcErrors = parser.getCrcErrors();
+  result.seqLost = tracker.getCounters().lost;
+  result.hostNsPerByte = bytesRead ? (double)hostNs / bytesRead : 0;
+  return result;
+}
+
+static bool runRxBench() {
+  static const char* const payloads[] = {"PING", "TDOA-PAYLOAD-0123456789ABCDEF"};
+  static const Channel channels[] = {
+    {0.0f, 0.0f}, {0.001f, 0.0f}, {0.01f, 0.0f}, {0.0f, 0.001f}, {0.0f, 0.01f}
+  };
+  bool pass = true;
+  
+  printf("RX: %u frames/case, UART %lu baud, air %lu bps, loop period %u us\n",
+         FRAMES_PER_CASE, (unsigned long)Config::Protocol::LORA_BAUD_RATE,
+         (unsigned long)Config::Protocol::AIR_DATA_RATE, LOOP_PERIOD_US);
+  printf("%6s %7s %6s %7s %7s %6s %6s %6s %6s %6s %8s %10s %10s %10s %8s\n",
+         "format", "payload", "bytes", "loss", "flip", "ok", "bad", "err", "crc", "lost", "seq_lost",
+         "lat_p50_ms", "lat_max_ms", "arr_err_us", "ns/byte");
+  
+  for (int format = 0; format < WIRE_FORMAT_COUNT; format++) {
+    for (const char* payload : payloads) {
+      for (const Channel& channel : channels) {
+        CaseResult r = runRxCase((WireFormat)format, payload, channel);
+        uint32_t lost = FRAMES_PER_CASE - r.ok - r.corrupted;
+        
+        printf("%6s %7u %6u %7.3f %7.3f %6u %6u %6u %6u %6u %8u %10.2f %10.2f %10u %8.1f\n",
+               FORMAT_NAMES[format], (unsigned)strlen(payload), (unsigned)r.frameBytes,
+               channel.byteLoss, channel.bitFlip, r.ok, r.corrupted, r.errors, r.crcErrors, lost, r.seqLost,
+               r.latencyP50_us / 1000.0, r.latencyMax_us / 1000.0,
+               r.arrivalErrMax_us, r.hostNsPerByte);
+        
+        // Метка начала точна и для кадра длиннее подпакета (текст):
+        // AUX падает после приема первого подпакета
+        bool clean = channel.byteLoss == 0 && channel.bitFlip == 0;
+        if (clean && (lost != 0 || r.seqLost != 0 || r.errors != 0 || r.corrupted != 0 ||
+                      r.arrivalErrMax_us > MAX_ARRIVAL_ERR_US)) {
+          pass = false;
+        }
+        
+        // С CRC искаженный кадр не проходит разбор ни при каком канале
+        if (Config::Protocol::REQUIRE_CRC && r.corrupted != 0) pass = false;
+      }
+    }
+  }
+  
+  const SimRadioStats& st = simRadio.getStats();
+  if (st.bytesOverflow) {
+    printf("RX FIFO overflow: %u bytes\n", st.bytesOverflow);
+    pass = false;
+  }
+  return pass;
+}
+
+static bool runTxBench() {
+  static const char* const payloads[] = {"PING", "TDOA-PAYLOAD-0123456789ABCDEF"};
+  bool pass = true;
+  
+  printf("\nTX: blocking LoRaModule::sendMessage vs simulated airtime\n");
+  printf("%6s %7s %6s %10s %10s %10s %8s\n",
+         "format", "payload", "bytes", "block_ms", "air_ms", "est_ms", "status");
+  
+  for (int format = WIRE_BINARY; format < WIRE_FORMAT_COUNT; format++) {
+    tagEncoder = DeltaEncoder();
+    for (const char* payload : payloads) {
+      uint8_t frame[BINARY_MAX_FRAME + 64];
+      size_t len = buildFrame(frame, (WireFormat)format, payload, 0);
+      size_t wireLen = len + FRAMING_OVERHEAD;
+      
+      simRadio.resetStats();
+      uint64_t start = Sim::now_us();
+      bool ok = loraModule.sendMessage(frame, len);
+      uint64_t blocked = Sim::now_us() - start;
+      
+      // Библиотека E32 отклоняет кадр длиннее подпакета (+2 байта адреса)
+      bool tooBig = wireLen > SimE32::SUBPACKET_SIZE + 2;
+      
+      printf("%6s %7u %6u %10.2f %10.2f %10.2f %8s\n",
+             FORMAT_NAMES[format], (unsigned)strlen(payload), (unsigned)wireLen,
+             blocked / 1000.0, simRadio.getStats().txAirtime_us / 1000.0,
+             estimateAirtime_us(wireLen) / 1000.0, ok ? "OK" : (tooBig ? "TOO_BIG" : "FAIL"));
+      
+      if (ok == tooBig) pass = false;
+    }
+  }
+  
+  printf("\nTX: non-blocking startSend/pollSend (caller time vs completion)\n");
+  printf("%6s %7s %6s %10s %10s %10s %8s\n",
+         "format", "payload", "bytes", "call_us", "done_ms", "air_ms", "status");
+  
+  for (int format = WIRE_BINARY; format < WIRE_FORMAT_COUNT; format++) {
+    tagEncoder = DeltaEncoder();
+    for (const char* payload : payloads) {
+      uint8_t frame[BINARY_MAX_FRAME + 64];
+      size_t len = buildFrame(frame, (WireFormat)format, payload, 0);
+      size_t wireLen = len + FRAMING_OVERHEAD;
+      bool tooBig = wireLen > SimE32::SUBPACKET_SIZE + 2;
+      
+      simRadio.resetStats();
+      uint64_t start = Sim::now_us();
+      bool started = loraModule.startSend(frame, len);
+      uint64_t callTime = Sim::now_us() - start;  // Вызов не продвигает виртуальное время
+      
+      LoRaModule::SendState state = started ? LoRaModule::SEND_BUSY : LoRaModule::SEND_IDLE;
+      while (state == LoRaModule::SEND_BUSY) {
+        Sim::advance(Config::Tx::SEND_POLL_MS * 1000);
+        state = loraModule.pollSend();
+      }
+      uint64_t done = Sim::now_us() - start;
+      
+      const char* status = !started ? (tooBig ? "TOO_BIG" : "BUSY")
+                         : state == LoRaModule::SEND_DONE ? "OK" : "TIMEOUT";
+      printf("%6s %7u %6u %10u %10.2f %10.2f %8s\n",
+             FORMAT_NAMES[format], (unsigned)strlen(payload), (unsigned)wireLen,
+             (unsigned)callTime, done / 1000.0, simRadio.getStats().txAirtime_us / 1000.0, status);
+      
+      // Завершение не раньше конца эфира и не позже чем через период опроса
+      // после подъема AUX (UART + пауза перед хвостом подпакета + эфир)
+      uint64_t auxUp = (uint64_t)(wireLen + simRadio.getConfig().idleGapBytes) * simRadio.byteTime_us() +
+                       simRadio.getStats().txAirtime_us;
+      bool okTiming = state == LoRaModule::SEND_DONE &&
+                      done >= simRadio.getStats().txAirtime_us &&
+                      done <= auxUp + Config::Tx::SEND_POLL_MS * 1000;
+      if (tooBig ? started : !okTiming) pass = false;
+    }
+  }
+  return pass;
+}
+
+static const uint32_t BATCH_ROUNDS = 200;
+static const uint8_t  BATCH_FRAMES = 3;   // 3 x 17 байт бинарных "P" (с CRC) + 2 + 3 синхро = 56 байт
+
+// Пакет кадров: все кадры разбираются, у всех начало = начало пакета в эфире
+static bool runBatchRxBench() {
+  simRadio.configure(SimRadioConfig());
+  simRadio.resetStats();
+  
+  PacketParser parser;
+  loraModule.resetFrameTiming();
+  
+  uint8_t batch[BATCH_PREFIX_SIZE + Config::Tx::BATCH_MAX_BYTES];
+  uint8_t wire[sizeof(batch) + FRAME_SYNC_OVERHEAD];
+  uint32_t ok = 0, misplaced = 0, errors = 0, arrivalErrMax = 0;
+  uint64_t airStart = 0;
+  size_t batchLen = 0;
+  size_t wireLen = 0;
+  
+  for (uint32_t round = 0; round < BATCH_ROUNDS; round++) {
+    batchLen = BATCH_PREFIX_SIZE;
+    for (uint8_t i = 0; i < BATCH_FRAMES; i++) {
+      batchLen += buildFrame(batch + batchLen, WIRE_BINARY, "P", round * BATCH_FRAMES + i);
+    }
+    batch[0] = BATCH_FRAME_MAGIC;
+    batch[1] = (uint8_t)(batchLen - BATCH_PREFIX_SIZE);
+    
+    airStart = Sim::now_us();
+    wireLen = toWire(wire, sizeof(wire), batch, batchLen);
+    uint64_t uartEnd = simRadio.injectAir(wire, wireLen);
+    
+    while (Sim::now_us() < uartEnd + 10000) {
+      while (loraModule.available() > 0) {
+        PacketParser::Result res = parser.feed((uint8_t)loraModule.read());
+        
+        if (res == PacketParser::FRAME_OK) {
+          const PacketData& packet = parser.packet();
+          RxStats stats = calculateRxStats(packet, loraModule.takeFrameTiming(parser));
+          
+          if (packet.sequence != round * BATCH_FRAMES + parser.batchIndex() ||
+              parser.batchBytes() != wireLen) {
+            misplaced++;
+            continue;
+          }
+          int32_t err = (int32_t)(stats.arrivalTime_us() - (uint32_t)airStart);
+          uint32_t absErr = err < 0 ? -err : err;
+          if (absErr > arrivalErrMax) arrivalErrMax = absErr;
+          ok++;
+        } else if (res == PacketParser::FRAME_ERROR) {
+          loraModule.takeFrameTiming(parser);
+          errors++;
+        } else if (!parser.inFrame()) {
+          loraModule.resetFrameTiming();
+        }
+      }
+      Sim::advance(LOOP_PERIOD_US);
+    }
+  }
+  
+  printf("\nRX: batch of %u binary frames (%u B), %u rounds\n",
+         BATCH_FRAMES, (unsigned)wireLen, BATCH_ROUNDS);
+  printf("%6s %9s %6s %10s\n", "ok", "misplaced", "err", "arr_err_us");
+  printf("%6u %9u %6u %10u\n", ok, misplaced, errors, arrivalErrMax);
+  
+  return ok == BATCH_ROUNDS * BATCH_FRAMES && misplaced == 0 && errors == 0 &&
+         arrivalErrMax <= MAX_ARRIVAL_ERR_US;
+}
+
+// Одни и те же кадры: по одному на передачу и пакетами LoRaModule::flushBatch
+static double runBatchTxCase(bool batching, uint32_t& transmissions, uint64_t& airtime) {
+  simRadio.resetStats();
+  transmissions = 0;
+  
+  const uint32_t frames = BATCH_ROUNDS * BATCH_FRAMES;
+  uint32_t next = 0;
+  uint8_t frame[BINARY_MAX_FRAME];
+  
+  while (next < frames) {
+    do {
+      size_t len = buildFrame(frame, WIRE_BINARY, "PING", next);
+      if (!loraModule.batchFits(len)) break;
+      loraModule.batchAppend(frame, len);
+      next++;
+    } while (batching && next < frames);
+    
+    if (!loraModule.flushBatch()) return 0;
+    transmissions++;
+    
+    LoRaModule::SendState state = LoRaModule::SEND_BUSY;
+    while (state == LoRaModule::SEND_BUSY) {
+      Sim::advance(Config::Tx::SEND_POLL_MS * 1000);
+      state = loraModule.pollSend();
+    }
+    if (state != LoRaModule::SEND_DONE) return 0;
+  }
+  
+  airtime = simRadio.getStats().txAirtime_us;
+  return airtime ? frames * 1e6 / airtime : 0;
+}
+
+static bool runBatchTxBench() {
+  printf("\nTX: %u binary \"PING\" frames, one per transmission vs batched\n",
+         BATCH_ROUNDS * BATCH_FRAMES);
+  printf("%8s %6s %10s %14s\n", "mode", "tx", "air_ms", "frames/air-s");
+  
+  double rate[2];
+  for (int batching = 0; batching < 2; batching++) {
+    uint32_t transmissions;
+    uint64_t airtime = 0;
+    rate[batching] = runBatchTxCase(batching != 0, transmissions, airtime);
+    printf("%8s %6u %10.1f %14.2f\n", batching ? "batched" : "single",
+           transmissions, airtime / 1000.0, rate[batching]);
+  }
+  printf("gain x%.2f\n", rate[0] > 0 ? rate[1] / rate[0] : 0);
+  
+  return rate[0] > 0 && rate[1] > rate[0];
+}
+
+// ===== Бюджет эфира beacon: v1 против v2 =====
+// Поток beacon тега с периодом PING_INTERVAL: средний размер кадра и эфир.
+static const uint32_t BUDGET_FRAMES = 800;
+
+static bool runAirBudgetBench() {
+  printf("\nTX: %u \"BEACON\" frames every %lu ms, air budget per format\n",
+         BUDGET_FRAMES, (unsigned long)Config::Timing::PING_INTERVAL);
+  printf("%6s %9s %10s %14s\n", "format", "avg_bytes", "avg_air_ms", "beacons/air-s");
+  
+  double rate[WIRE_FORMAT_COUNT] = {};
+  for (int format = WIRE_BINARY; format < WIRE_FORMAT_COUNT; format++) {
+    uint8_t frame[BINARY_MAX_FRAME + 64];
+    uint64_t bytes = 0;
+    uint64_t airtime = 0;
+    tagEncoder = DeltaEncoder();
+    
+    for (uint32_t i = 0; i < BUDGET_FRAMES; i++) {
+      Sim::advance(Config::Timing::PING_INTERVAL * 1000UL);
+      size_t len = buildFrame(frame, (WireFormat)format, "BEACON", i) + FRAMING_OVERHEAD;
+      bytes += len;
+      airtime += estimateAirtime_us(len);
+    }
+    
+    rate[format] = BUDGET_FRAMES * 1e6 / (double)airtime;
+    printf("%6s %9.2f %10.2f %14.2f\n", FORMAT_NAMES[format], (double)bytes / BUDGET_FRAMES,
+           airtime / 1000.0 / BUDGET_FRAMES, rate[format]);
+  }
+  printf("delta vs binary x%.2f\n", rate[WIRE_BINARY] > 0 ? rate[WIRE_DELTA] / rate[WIRE_BINARY] : 0);
+  
+  return rate[WIRE_DELTA] > rate[WIRE_BINARY];
+}
+
+// ===== Пейсинг beacon: бюджеты эфира и коллизий =====
+static const uint32_t PACED_FRAMES = 400;
+static const double PACING_TOLERANCE = 1.02;  // Джиттер интервала и усреднение эфира
+
+static void printAirtimeTable() {
+  static const uint32_t RATES[] = { 300, 1200, 2400, 4800, 9600, 19200 };
+  
+  printf("\nE32 air data rate -> LoRa modulation (airtime.h)\n");
+  printf("%6s %3s %6s %7s %9s %9s %9s\n", "bps", "SF", "BW_kHz", "sym_us", "20B_ms", "58B_ms", "60B_ms");
+  for (size_t i = 0; i < sizeof(RATES) / sizeof(RATES[0]); i++) {
+    LoraModulation m = e32Modulation(RATES[i]);
+    printf("%6u %3u %6u %7u %9.2f %9.2f %9.2f\n", RATES[i], m.sf, m.bw_hz / 1000, loraSymbol_us(m),
+           e32Airtime_us(m, 20) / 1000.0, e32Airtime_us(m, 58) / 1000.0, e32Airtime_us(m, 60) / 1000.0);
+  }
+}
+
+static bool runPacingBench() {
+  printAirtimeTable();
+  
+  printf("\nTX: %u paced \"BEACON\" frames per format (duty %.1f%%, collision %.1f%%, %u sender(s))\n",
+         PACED_FRAMES, Config::Pacing::DUTY_CYCLE_PERMILLE / 10.0, Config::Pacing::COLLISION_PERMILLE / 10.0,
+         (unsigned)Config::Pacing::CHANNEL_SENDERS);
+  printf("%6s %11s %8s %9s\n", "format", "interval_ms", "util_%", "p_coll_%");
+  
+  const double dutyBudget = Config::Pacing::DUTY_CYCLE_PERMILLE / 1000.0;
+  const double collisionBudget = Config::Pacing::COLLISION_PERMILLE / 1000.0;
+  bool pass = true;
+  
+  for (int format = WIRE_BINARY; format < WIRE_FORMAT_COUNT; format++) {
+    uint8_t frame[BINARY_MAX_FRAME + 64];
+    BeaconPacer pacer;
+    tagEncoder = DeltaEncoder();
+    simRadio.resetStats();
+    uint64_t start = Sim::now_us();
+    
+    for (uint32_t i = 0; i < PACED_FRAMES; i++) {
+      uint64_t slot = Sim::now_us();
+      size_t len = buildFrame(frame, (WireFormat)format, "BEACON", i);
+      if (i == 0) pacer.begin(len + FRAMING_OVERHEAD);
+      uint32_t interval = pacer.nextInterval_ms();
+      
+      if (!loraModule.startSend(frame, len)) return false;
+      LoRaModule::SendState state = LoRaModule::SEND_BUSY;
+      while (state == LoRaModule::SEND_BUSY) {
+        Sim::advance(Config::Tx::SEND_POLL_MS * 1000);
+        state = loraModule.pollSend();
+      }
+      if (state != LoRaModule::SEND_DONE) return false;
+      
+      pacer.onBeaconSent(estimateAirtime_us(loraModule.getLastSendBytes()));
+      Sim::runUntil(slot + interval * 1000ULL);
+    }
+    
+    double utilization = (double)simRadio.getStats().txAirtime_us / (Sim::now_us() - start);
+    double collision = 1.0 - exp(-2.0 * Config::Pacing::CHANNEL_SENDERS * utilization);
+    printf("%6s %11u %8.2f %9.2f\n", FORMAT_NAMES[format], pacer.getInterval_ms(),
+           utilization * 100.0, collision * 100.0);
+    
+    pass = pass && utilization <= dutyBudget * PACING_TOLERANCE &&
+           collision <= collisionBudget * PACING_TOLERANCE;
+  }
+  
+  return pass;
+}
+
+// ===== Кадрирование: потери кадров на одну ошибку =====
+// Кадры подряд без пауз (худший случай для поиска границы), одна ошибка на
+// каждый FRAMING_ERROR_EVERY-й кадр. Без синхрослова граница ищется по
+// маркеру/терминатору и ошибка может съесть соседний кадр; с синхрословом
+// теряется только поврежденный.
+static const uint32_t FRAMING_FRAMES      = 2000;
+static const uint32_t FRAMING_ERROR_EVERY = 10;
+
+enum FramingError { ERR_DROP, ERR_FLIP, ERR_INSERT, ERR_TRUNCATE, FRAMING_ERROR_COUNT };
+static const char* const FRAMING_ERROR_NAMES[FRAMING_ERROR_COUNT] = {"drop", "flip", "insert", "trunc"};
+
+struct FramingResult {
+  uint32_t injected;
+  uint32_t ok;
+  uint32_t corrupted;   // Прошел разбор с чужим SEQ
+  uint32_t syncErrors;
+};
+
+static FramingResult runFramingCase(WireFormat format, bool cobs, FramingError error) {
+  PacketParser parser;
+  parser.setSyncFraming(cobs);
+  FramingResult result;
+  memset(&result, 0, sizeof(result));
+  
+  uint32_t rng = 0x5EED1234;
+  uint8_t frame[BINARY_MAX_FRAME + 64];
+  std::vector<uint8_t> wire(sizeof(frame) + FRAME_SYNC_OVERHEAD);
+  int64_t lastSeq = -1;
+  
+  for (uint32_t seq = 0; seq < FRAMING_FRAMES; seq++) {
+    size_t len = buildFrame(frame, format, "TDOA", seq);
+    wire.resize(sizeof(frame) + FRAME_SYNC_OVERHEAD);
+    if (cobs) {
+      len = encodeSyncFrame(wire.data(), wire.size(), frame, len);
+    } else {
+      memcpy(wire.data(), frame, len);
+    }
+    wire.resize(len);
+    
+    if (seq % FRAMING_ERROR_EVERY == FRAMING_ERROR_EVERY / 2) {
+      rng = rng * 1103515245u + 12345u;
+      size_t pos = (rng >> 8) % len;
+      switch (error) {
+        case ERR_DROP:     wire.erase(wire.begin() + pos); break;
+        case ERR_FLIP:     wire[pos] ^= (uint8_t)(1 << (rng >> 28 & 7)); break;
+        case ERR_INSERT:   wire.insert(wire.begin() + pos, (uint8_t)(rng >> 24)); break;
+        case ERR_TRUNCATE: wire.pop_back(); break;
+        default: break;
+      }
+      result.injected++;
+    }
+    
+    for (uint8_t b : wire) {
+      if (parser.feed(b) != PacketParser::FRAME_OK) continue;
+      int64_t got = parser.packet().sequence;
+      if (got <= lastSeq || got > seq) {
+        result.corrupted++;
+        continue;
+      }
+      lastSeq = got;
+      result.ok++;
+    }
+  }
+  result.syncErrors = parser.getSyncErrors();
+  return result;
+}
+
+static bool runFramingBench() {
+  printf("\nRX: %u back-to-back \"TDOA\" frames, one error every %u frames\n",
+         FRAMING_FRAMES, FRAMING_ERROR_EVERY);
+  printf("%6s %7s %6s %8s %6s %6s %6s %8s\n",
+         "format", "framing", "error", "injected", "lost", "bad", "sync", "lost/err");
+  
+  bool pass = true;
+  for (int format = WIRE_TEXT; format <= WIRE_BINARY; format++) {
+    for (int cobs = 0; cobs < 2; cobs++) {
+      for (int error = 0; error < FRAMING_ERROR_COUNT; error++) {
+        FramingResult r = runFramingCase((WireFormat)format, cobs != 0, (FramingError)error);
+        uint32_t lost = FRAMING_FRAMES - r.ok;
+        double perError = r.injected ? (double)lost / r.injected : 0;
+        
+        printf("%6s %7s %6s %8u %6u %6u %6u %8.2f\n", FORMAT_NAMES[format], cobs ? "cobs" : "raw",
+               FRAMING_ERROR_NAMES[error], r.injected, lost, r.corrupted, r.syncErrors, perError);
+        
+        if (Config::Protocol::REQUIRE_CRC && r.corrupted != 0) pass = false;
+        if (cobs && perError > 1.0) pass = false;
+      }
+    }
+  }
+  return pass;
+}
+
+// Смешанный поток: кадры с синхрословом и без (прошивка до COBS_FRAMING,
+// текст старых тегов без CRC) в одном потоковом разборе
+static const uint32_t MIXED_ROUNDS = 200;
+
+static bool runMixedFramingCheck() {
+  PacketParser parser;
+  uint32_t sent = 0, ok = 0, wrong = 0;
+  
+  for (uint32_t round = 0; round < MIXED_ROUNDS; round++) {
+    for (int kind = 0; kind < 5; kind++) {
+      uint8_t frame[TEXT_MAX_FRAME + BINARY_MAX_FRAME];
+      uint8_t wire[sizeof(frame) + FRAME_SYNC_OVERHEAD];
+      uint32_t seq = round * 5 + kind;
+      size_t len;
+      if (kind == 4) {
+        len = (size_t)sprintf((char*)frame, "EUID:1_%u,MSG:TDOA,TIME:%u,SEQ:%u\n",
+                              (unsigned)seq, (unsigned)(3456790 + seq), (unsigned)seq);
+      } else {
+        len = buildFrame(frame, kind & 1 ? WIRE_TEXT : WIRE_BINARY, "TDOA", seq);
+      }
+      // 0, 2 - с синхрословом; 1, 3, 4 - как есть
+      size_t wireLen = kind == 0 || kind == 2 ? encodeSyncFrame(wire, sizeof(wire), frame, len) : len;
+      if (wireLen == len) memcpy(wire, frame, len);
+      sent++;
+      
+      for (size_t i = 0; i < wireLen; i++) {
+        if (parser.feed(wire[i]) != PacketParser::FRAME_OK) continue;
+        if (parser.packet().sequence == seq) ok++; else wrong++;
+      }
+    }
+  }
+  
+  printf("\nRX: mixed framed/unframed stream, %u frames: ok %u, wrong %u, errors %u\n",
+         sent, ok, wrong, parser.getFramesError());
+  return ok == sent && wrong == 0;
+}
+
+// Обертки parsePacket/decodeBinaryPacket: кадр целиком, без синхрослова и в нем
+static bool sameFrame(const PacketData& p, const char* message, uint32_t seq) {
+  return p.valid && p.sequence == seq && strcmp(p.message, message) == 0;
+}
+
+static bool runWrapperCheck() {
+  printf("\nparsePacket/decodeBinaryPacket round trip\n");
+  printf("%6s %7s %6s\n", "format", "framing", "result");
+  
+  bool pass = true;
+  for (int format = WIRE_TEXT; format <= WIRE_BINARY; format++) {
+    for (int cobs = 0; cobs < 2; cobs++) {
+      uint8_t frame[TEXT_MAX_FRAME + BINARY_MAX_FRAME];
+      uint8_t wire[sizeof(frame) + FRAME_SYNC_OVERHEAD];
+      uint32_t seq = 4242 + format * 2 + cobs;
+      size_t len = buildFrame(frame, (WireFormat)format, "BEACON", seq);
+      size_t wireLen = cobs ? encodeSyncFrame(wire, sizeof(wire), frame, len) : len;
+      if (!cobs) memcpy(wire, frame, len);
+      
+      bool ok = len != 0 && wireLen != 0 &&
+                sameFrame(parsePacket((const char*)wire, wireLen), "BEACON", seq);
+      if (ok && format == WIRE_BINARY && !cobs) {
+        ok = sameFrame(decodeBinaryPacket(frame, len), "BEACON", seq);
+      }
+      printf("%6s %7s %6s\n", FORMAT_NAMES[format], cobs ? "cobs" : "raw", ok ? "OK" : "FAIL");
+      if (!ok) pass = false;
+    }
+  }
+  return pass;
+}
+
+int main() {
+  // Диагностика прошивки в stdout не нужна - только таблицы
+  Serial.setEcho(false);
+  
+  if (!loraModule.initialize()) {
+    printf("LoRaModule init failed\n");
+    return 1;
+  }
+  loraModule.getSerial()->setRxBufferSize(Config::Protocol::RX_BUFFER_SIZE);
+  loraModule.enableRxTimestamps();
+  
+  bool pass = runRxBench();
+  pass = runTxBench() && pass;
+  pass = runBatchRxBench() && pass;
+  pass = runBatchTxBench() && pass;
+  pass = runAirBudgetBench() && pass;
+  pass = runPacingBench() && pass;
+  pass = runFramingBench() && pass;
+  pass = runMixedFramingCheck() && pass;
+  pass = runWrapperCheck() && pass;
+  
+  printf("\n%s\n", pass ? "PASS" : "FAIL");
+  return pass ? 0 : 1;
+}
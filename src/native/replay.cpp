@@ -0,0 +1,779 @@
+/*
+  Host replay: записи приема anchor (capture.h) -> разбор, метки, TDOA
+
+  Сборка и запуск:
+    pio run -e native_replay
+    .pio/build/native_replay/program [-v] <файл> [<файл> ...]
+    .pio/build/native_replay/program --bench
+
+  Файл - сырой поток USB Serial anchor после команды "capture on" (порт
+  настраивается заранее, например stty -F /dev/ttyUSB0 115200 raw, и
+  cat /dev/ttyUSB0 > anchor1.cap); лог и записи uplink.h между записями
+  пропускаются. Файлы разных anchor с одного прогона - одно решение TDOA.
+
+  Шаг 1, по anchor: события идут на виртуальных часах симулятора в моменты
+  записи - micros() повторяет метки прошивки. Спад AUX вызывает ISR через пин,
+  байт кладется в UART и сразу читается LoRaModule::read(); дальше путь loop()
+  из rx_main.cpp: PacketParser, SequenceTable, calculateRxStats, ClockSync.
+  Шаг 2: метки кадров всех anchor в шкале опорного по порядку прихода - в
+  TDOANavigator, locateAll() с периодом TRACK_INTERVAL_MS, как pollTracking().
+  Время виртуальное: прогон быстрее реального и детерминирован. Итог - кадры,
+  позиции и дайджест меток и решений: одна запись на разных версиях прошивки
+  сравнивается по дайджесту, CPU хоста - в байтах и кадрах в секунду.
+  -v: строка FIX на каждую новую позицию тега.
+
+  --bench: anchor и теги на симуляторе E32, прошивка пишет capture в USB
+  Serial во время обычного приема (с потерей байт). Код возврата != 0, если
+  replay не повторил метку, ключ или счетчики разбора хоть одного кадра,
+  потерян блок записи, повторный replay дал другой дайджест или нет позиций.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include "config.h"
+#include "lora_module.h"
+#include "packet.h"
+#include "tdoa.h"
+#include "tdoa_solver.h"
+#include "clock_sync.h"
+#include "sequence_tracker.h"
+#include "capture.h"
+#include "rx_capture.h"
+#include "sim_radio.h"
+
+static const uint32_t LOOP_PERIOD_US = 200;   // Период опроса UART в loop() (bench)
+
+// ===== Разбор файлов записи =====
+
+struct AnchorCapture {
+  CaptureHeader header;
+  bool haveHeader;
+  bool haveSequence;
+  uint16_t nextSequence;
+  uint32_t chunks;
+  uint32_t lostChunks;     // Пропуски номеров блоков
+  std::vector<CaptureEvent> events;
+  
+  AnchorCapture() : haveHeader(false), haveSequence(false), nextSequence(0),
+                    chunks(0), lostChunks(0) {}
+};
+
+typedef std::map<uint8_t, AnchorCapture> CaptureSet;
+
+// Записи из сырого потока порта; возвращает число битых записей
+static uint32_t loadCapture(const uint8_t* data, size_t length, CaptureSet& set) {
+  CaptureDecoder decoder;
+  CaptureEvent event;
+  
+  for (size_t i = 0; i < length; i++) {
+    CaptureDecoder::Result r = decoder.feed(data[i]);
+    
+    if (r == CaptureDecoder::CAPTURE_HEADER) {
+      // Новая запись: номера блоков с нуля
+      AnchorCapture& capture = set[decoder.header().anchorId];
+      capture.header = decoder.header();
+      capture.haveHeader = true;
+      capture.haveSequence = false;
+    } else if (r == CaptureDecoder::CAPTURE_CHUNK) {
+      AnchorCapture& capture = set[decoder.chunkAnchor()];
+      uint16_t sequence = decoder.chunkSequence();
+      if (capture.haveSequence) capture.lostChunks += (uint16_t)(sequence - capture.nextSequence);
+      capture.nextSequence = sequence + 1;
+      capture.haveSequence = true;
+      capture.chunks++;
+      while (decoder.nextEvent(event)) capture.events.push_back(event);
+    }
+  }
+  return decoder.getErrors();
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) out.insert(out.end(), buffer, buffer + n);
+  fclose(f);
+  return true;
+}
+
+// ===== Часы симулятора =====
+
+// Ближайший момент впереди, где micros() == clock_us. Шаг 2^32 * 125 us
+// кратен и периоду micros(), и 1000 us - millis() идет в той же фазе при любом старте
+static uint64_t alignClock(uint32_t clock_us) {
+  const uint64_t period = (1ULL << 32) * 125;
+  uint64_t from = Sim::now_us() + 1;
+  uint64_t t = from - from % period + clock_us;
+  if (t < from) t += period;
+  return t;
+}
+
+// ===== Прием одного anchor: тело loop() и handlePacket() из rx_main.cpp =====
+
+struct Measurement {
+  PacketData packet;
+  RxStats refStats;        // Метки в шкале опорного anchor
+  uint8_t anchorId;
+};
+
+struct AnchorResult {
+  uint32_t bytes;
+  uint32_t framesOk;
+  uint32_t framesError;
+  uint32_t crcErrors;
+  uint32_t duplicates;
+  uint32_t syncFrames;
+  uint32_t notSynced;
+  double span_s;           // Время записи
+  double host_s;           // CPU хоста на replay
+};
+
+class AnchorRx {
+public:
+  AnchorRx(uint8_t anchorId, float x, float y, bool syncFraming) : id(anchorId) {
+    memset(&result, 0, sizeof(result));
+    clock.configure(id == Config::Sync::REFERENCE_ANCHOR_ID, x, y,
+                    Config::Sync::REFERENCE_X, Config::Sync::REFERENCE_Y);
+    parser.setSyncFraming(syncFraming);
+    loraModule.resetFrameTiming();
+  }
+  
+  void readAvailable() {
+    while (loraModule.available() > 0) {
+      char c = loraModule.read();
+      result.bytes++;
+      PacketParser::Result r = parser.feed((uint8_t)c);
+      
+      if (r == PacketParser::FRAME_OK) {
+        handlePacket(parser.packet(), loraModule.takeFrameTiming(parser));
+      } else if (r == PacketParser::FRAME_ERROR) {
+        loraModule.takeFrameTiming(parser);
+      } else if (!parser.inFrame()) {
+        loraModule.resetFrameTiming();
+      }
+    }
+  }
+  
+  bool inFrame() const { return parser.inFrame(); }
+  
+  const AnchorResult& finish() {
+    result.framesOk = parser.getFramesOk();
+    result.framesError = parser.getFramesError();
+    result.crcErrors = parser.getCrcErrors();
+    return result;
+  }
+  
+  std::vector<Measurement> measurements;
+  
+private:
+  uint8_t id;
+  PacketParser parser;
+  SequenceTable sequences;
+  ClockSync clock;
+  AnchorResult result;
+  
+  void handlePacket(const PacketData& packet, const RxFrameTiming& timing) {
+    uint16_t sender = isSyncPacket(packet)
+                        ? (uint16_t)(SequenceTable::SENDER_SYNC | Config::Sync::REFERENCE_ANCHOR_ID)
+                        : packet.tagId;
+    if (sequences.track(sender, packet.sequence) == SequenceTracker::SEQ_DUPLICATE) {
+      result.duplicates++;
+      return;
+    }
+    
+    RxStats stats = calculateRxStats(packet, timing);
+    if (isSyncPacket(packet)) {
+      if (!isSyncProbe(packet)) clock.processReference(packet.txTime_us, stats.arrivalTime_us());
+      result.syncFrames++;
+      return;
+    }
+    if (!clock.isLocked()) {
+      result.notSynced++;
+      return;
+    }
+    
+    Measurement m;
+    m.packet = packet;
+    m.refStats = stats;
+    m.refStats.rxTime_us = clock.toReference(stats.rxTime_us);
+    m.anchorId = id;
+    measurements.push_back(m);
+  }
+};
+
+// ===== Шаг 1: события записи через LoRaModule на виртуальных часах =====
+
+static void replayAnchor(const AnchorCapture& capture, AnchorRx& rx, AnchorResult& result) {
+  HardwareSerial* uart = loraModule.getSerial();
+  const uint8_t auxPin = Config::Pins::E32_AUX;
+  Sim::setPinLevel(auxPin, HIGH);
+  
+  if (capture.events.empty()) {
+    result = rx.finish();
+    return;
+  }
+  
+  uint32_t previous = capture.events[0].time_us;
+  uint64_t t = alignClock(previous);
+  uint64_t start_us = t;
+  
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < capture.events.size(); i++) {
+    const CaptureEvent& ev = capture.events[i];
+    t += (uint32_t)(ev.time_us - previous);  // Переполнение micros() - разность по модулю
+    previous = ev.time_us;
+    Sim::runUntil(t);
+    
+    if (ev.aux) {
+      // Спад и сразу фронт: ISR ставит метку, уровень AUX на приеме не читается
+      Sim::setPinLevel(auxPin, LOW);
+      Sim::setPinLevel(auxPin, HIGH);
+      continue;
+    }
+    uart->inject(ev.data);
+    rx.readAvailable();
+  }
+  double host_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  
+  result = rx.finish();
+  result.span_s = (t - start_us) / 1e6;
+  result.host_s = host_s;
+}
+
+// ===== Шаг 2: метки всех anchor -> TDOANavigator =====
+
+struct Fix {
+  uint32_t time_ms;        // От первого кадра
+  uint16_t tagId;
+  Position2D position;
+};
+
+// FNV-1a 32 - дайджест меток и решений
+static void digestAdd(uint32_t& digest, const void* data, size_t length) {
+  const uint8_t* p = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    digest ^= p[i];
+    digest *= 16777619u;
+  }
+}
+
+static void digestMeasurement(uint32_t& digest, const Measurement& m) {
+  uint64_t key = frameKey(m.packet);
+  uint32_t arrival = m.refStats.arrivalTime_us();
+  digestAdd(digest, &m.anchorId, sizeof(m.anchorId));
+  digestAdd(digest, &key, sizeof(key));
+  digestAdd(digest, &arrival, sizeof(arrival));
+}
+
+// Позиции до сантиметра: дайджест не зависит от последних бит float
+static void digestFix(uint32_t& digest, const Fix& fix) {
+  int32_t x = (int32_t)lroundf(fix.position.x * 100.0f);
+  int32_t y = (int32_t)lroundf(fix.position.y * 100.0f);
+  digestAdd(digest, &fix.tagId, sizeof(fix.tagId));
+  digestAdd(digest, &x, sizeof(x));
+  digestAdd(digest, &y, sizeof(y));
+}
+
+struct TimedMeasurement {
+  int64_t time_us;         // Шкала опорного anchor без переполнения
+  const Measurement* m;
+  
+  bool operator<(const TimedMeasurement& other) const {
+    return time_us != other.time_us ? time_us < other.time_us : m->anchorId < other.m->anchorId;
+  }
+};
+
+static std::vector<Fix> solveAll(const CaptureSet& set, const std::vector<AnchorRx*>& anchors,
+                                 bool verbose, TDOANavigator& navigator) {
+  for (CaptureSet::const_iterator it = set.begin(); it != set.end(); ++it) {
+    if (it->second.haveHeader) navigator.registerAnchor(it->first, it->second.header.x, it->second.header.y);
+  }
+  
+  // Метки anchor по порядку; разность с первой - со знаком, переполнение по модулю
+  std::vector<TimedMeasurement> timeline;
+  bool haveOrigin = false;
+  uint32_t origin = 0;
+  for (size_t a = 0; a < anchors.size(); a++) {
+    const std::vector<Measurement>& list = anchors[a]->measurements;
+    int64_t t = 0;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < list.size(); i++) {
+      uint32_t arrival = list[i].refStats.arrivalTime_us();
+      if (!haveOrigin) {
+        origin = arrival;
+        haveOrigin = true;
+      }
+      t = (i == 0) ? (int32_t)(arrival - origin) : t + (int32_t)(arrival - previous);
+      previous = arrival;
+      TimedMeasurement tm = {t, &list[i]};
+      timeline.push_back(tm);
+    }
+  }
+  std::sort(timeline.begin(), timeline.end());
+  
+  std::vector<Fix> fixes;
+  if (timeline.empty()) return fixes;
+  
+  std::vector<uint16_t> tagIds;
+  for (size_t i = 0; i < timeline.size(); i++) {
+    uint16_t tag = timeline[i].m->packet.tagId;
+    if (std::find(tagIds.begin(), tagIds.end(), tag) == tagIds.end()) tagIds.push_back(tag);
+  }
+  std::vector<Position2D> before(tagIds.size());
+  
+  // Часы симулятора - шкала опорного anchor (micros() == метка кадра)
+  int64_t first = timeline[0].time_us;
+  uint64_t base = alignClock(origin + (uint32_t)first) - first;
+  uint64_t trackAt = base + first;
+  uint64_t endAt = base + timeline.back().time_us + Config::Tdoa::TRACK_SETTLE_MS * 2000ULL;
+  
+  size_t next = 0;
+  while (next < timeline.size() || trackAt <= endAt) {
+    uint64_t frameAt = next < timeline.size() ? base + timeline[next].time_us : UINT64_MAX;
+    if (frameAt < trackAt) {
+      Sim::runUntil(frameAt);
+      navigator.processRxPacket(timeline[next].m->packet, timeline[next].m->refStats,
+                                timeline[next].m->anchorId);
+      next++;
+      continue;
+    }
+    
+    // pollTracking(); новая позиция - тег, чья позиция на этот момент изменилась
+    Sim::runUntil(trackAt);
+    trackAt += Config::Tdoa::TRACK_INTERVAL_MS * 1000ULL;
+    for (size_t i = 0; i < tagIds.size(); i++) {
+      if (!navigator.getTagPosition(tagIds[i], before[i])) before[i] = Position2D();
+    }
+    if (navigator.locateAll() == 0) continue;
+    
+    for (size_t i = 0; i < tagIds.size(); i++) {
+      Fix fix;
+      fix.tagId = tagIds[i];
+      if (!navigator.getTagPosition(fix.tagId, fix.position)) continue;
+      if (before[i].valid && before[i].x == fix.position.x && before[i].y == fix.position.y) continue;
+      fix.time_ms = (uint32_t)((Sim::now_us() - base - first) / 1000);
+      fixes.push_back(fix);
+      if (verbose) {
+        printf("FIX t=%u ms tag %u x %.1f y %.1f anchors %u residual %.1f\n", fix.time_ms, fix.tagId,
+               fix.position.x, fix.position.y, fix.position.anchorsUsed, fix.position.residual_m);
+      }
+    }
+  }
+  return fixes;
+}
+
+// ===== Replay набора записей =====
+
+struct ReplayOutput {
+  std::vector<AnchorRx*> anchors;
+  std::vector<AnchorResult> results;
+  std::vector<Fix> fixes;
+  uint32_t digest;
+  
+  ~ReplayOutput() {
+    for (size_t i = 0; i < anchors.size(); i++) delete anchors[i];
+  }
+};
+
+static void replayAll(const CaptureSet& set, bool verbose, ReplayOutput& out) {
+  for (CaptureSet::const_iterator it = set.begin(); it != set.end(); ++it) {
+    const AnchorCapture& capture = it->second;
+    bool syncFraming = capture.haveHeader ? (capture.header.flags & CAPTURE_FLAG_COBS) != 0
+                                          : Config::Protocol::COBS_FRAMING;
+    AnchorRx* rx = new AnchorRx(it->first, capture.header.x, capture.header.y, syncFraming);
+    AnchorResult result;
+    replayAnchor(capture, *rx, result);
+    out.anchors.push_back(rx);
+    out.results.push_back(result);
+  }
+  
+  std::unique_ptr<TDOANavigator> navigator(new TDOANavigator());
+  out.fixes = solveAll(set, out.anchors, verbose, *navigator);
+  
+  out.digest = 2166136261u;
+  for (size_t a = 0; a < out.anchors.size(); a++) {
+    const std::vector<Measurement>& list = out.anchors[a]->measurements;
+    for (size_t i = 0; i < list.size(); i++) digestMeasurement(out.digest, list[i]);
+  }
+  for (size_t i = 0; i < out.fixes.size(); i++) digestFix(out.digest, out.fixes[i]);
+}
+
+static void printReport(const CaptureSet& set, const ReplayOutput& out) {
+  printf("%6s %7s %6s %5s %7s %6s %5s %4s %4s %5s %6s %6s %7s %9s %9s %8s\n",
+         "anchor", "header", "chunks", "lost", "bytes", "frames", "err", "crc", "dup", "sync",
+         "unsync", "meas", "span s", "host ms", "kbyte/s", "speedup");
+  
+  size_t a = 0;
+  for (CaptureSet::const_iterator it = set.begin(); it != set.end(); ++it, ++a) {
+    const AnchorCapture& capture = it->second;
+    const AnchorResult& r = out.results[a];
+    printf("%6u %7s %6u %5u %7u %6u %5u %4u %4u %5u %6u %6u %7.1f %9.2f %9.0f %8.0f\n",
+           it->first, capture.haveHeader ? "yes" : "no", capture.chunks, capture.lostChunks,
+           r.bytes, r.framesOk, r.framesError, r.crcErrors, r.duplicates, r.syncFrames, r.notSynced,
+           (unsigned)out.anchors[a]->measurements.size(), r.span_s, r.host_s * 1e3,
+           r.host_s > 0 ? r.bytes / r.host_s / 1e3 : 0, r.host_s > 0 ? r.span_s / r.host_s : 0);
+  }
+  
+  std::map<uint16_t, const Fix*> last;
+  for (size_t i = 0; i < out.fixes.size(); i++) last[out.fixes[i].tagId] = &out.fixes[i];
+  printf("Fixes: %u\n", (unsigned)out.fixes.size());
+  for (std::map<uint16_t, const Fix*>::const_iterator it = last.begin(); it != last.end(); ++it) {
+    printf("  tag %u: last at %.1f s (%.1f, %.1f), anchors %u\n", it->first, it->second->time_ms / 1e3,
+           it->second->position.x, it->second->position.y, it->second->position.anchorsUsed);
+  }
+  printf("Digest: %08x\n", out.digest);
+}
+
+// ===== --bench: запись на симуляторе и ее replay =====
+
+struct BenchAnchor {
+  uint8_t id;
+  float x;
+  float y;
+  uint32_t clockOffset_us;  // Часы anchor относительно опорного
+};
+
+struct BenchTag {
+  uint16_t id;
+  float x;
+  float y;
+};
+
+static const BenchAnchor BENCH_ANCHORS[] = {
+  {0, 0.0f, 0.0f, 0},
+  {1, 3000.0f, 0.0f, 1234567},
+  {2, 3000.0f, 3000.0f, 7654321},
+  {3, 0.0f, 3000.0f, 424242},
+};
+static const BenchTag BENCH_TAGS[] = {
+  {1, 1100.0f, 1900.0f},
+  {2, 2200.0f, 700.0f},
+};
+static const size_t BENCH_ANCHOR_COUNT = sizeof(BENCH_ANCHORS) / sizeof(BENCH_ANCHORS[0]);
+static const size_t BENCH_TAG_COUNT = sizeof(BENCH_TAGS) / sizeof(BENCH_TAGS[0]);
+static const uint32_t BENCH_CYCLES     = 60;      // Цикл: SYNC, затем кадры тегов по два раза
+static const uint32_t BENCH_REF_CLOCK  = 0x01000000;  // micros() опорного anchor на старте
+static const float    BENCH_BYTE_LOSS  = 0.001f;
+static const float    BENCH_MAX_ERR_M  = 300.0f;      // Метка micros() - 1 мкс, это ~300 м пути сигнала
+static const uint32_t BENCH_MAX_SYNC_ERR_US = 1;      // Метка SYNC - начало эфира
+
+struct BenchFrame {
+  uint64_t offset_us;      // От начала прогона (часы опорного anchor)
+  float x;                 // Передатчик
+  float y;
+  bool sync;
+  bool probe;              // Пробный SYNC: метка по модели задержки TX
+  int32_t stampError_us;   // SYNC: метка TIME - начало эфира
+  std::vector<uint8_t> wire;
+};
+
+static void injectBenchFrame(void* ctx, uint32_t /*arg*/) {
+  const BenchFrame* f = (const BenchFrame*)ctx;
+  simRadio.injectAir(f->wire.data(), f->wire.size());
+}
+
+static size_t benchWire(uint8_t* wire, size_t wireSize, const uint8_t* frame, size_t len) {
+  if (Config::Protocol::COBS_FRAMING) return encodeSyncFrame(wire, wireSize, frame, len);
+  memcpy(wire, frame, len);
+  return len;
+}
+
+// Кадр тега в эфирном формате прошивок: сжатый при WIRE_FORMAT_DELTA, иначе
+// бинарный. Текстовый с CRC длиннее подпакета E32 (Tx::MAX_FRAME) и в эфир не идет
+static size_t encodeBenchFrame(uint8_t* out, size_t outSize, DeltaEncoder& encoder, uint32_t seq) {
+  if (Config::Protocol::DELTA_WIRE_FORMAT) return encoder.encode(out, outSize, "TDOA", seq);
+  return encodeBinaryPacket(out, outSize, "TDOA", seq);
+}
+
+// SYNC опорного anchor, как sendSyncFrame() в rx_main.cpp: бинарный кадр с меткой
+// ожидаемого начала эфира уходит через E32 (первый - пробный). Время идет до
+// подъема AUX; f - начало эфира и ошибка метки
+static bool sendBenchSync(ClockSync& reference, uint32_t seq, uint64_t refBase, BenchFrame& f) {
+  f.probe = !reference.isTxDelayMeasured();
+  const char* message = f.probe ? SYNC_PROBE_MESSAGE : SYNC_MESSAGE;
+  uint8_t frame[BINARY_MAX_FRAME];
+  uint32_t write_us = micros();
+  uint32_t model_us = loraModule.txAirDelay_us(binaryFrameSize(getLocalTagId(), strlen(message)));
+  uint32_t stamp = reference.referenceStamp(write_us, model_us);
+  size_t len = encodeBinaryPacketAt(frame, sizeof(frame), message, seq, stamp);
+  if (!loraModule.sendMessage(frame, len)) return false;
+  
+  uint32_t airStart_us;
+  if (loraModule.getSendAirStart_us(airStart_us)) reference.onReferenceSent(write_us, airStart_us);
+  
+  uint64_t airStart = simRadio.getTxAirStart_us();
+  f.offset_us = airStart - refBase;
+  f.stampError_us = (int32_t)(stamp - (uint32_t)airStart);
+  
+  uint8_t wire[sizeof(frame) + FRAME_SYNC_OVERHEAD];
+  len = benchWire(wire, sizeof(wire), frame, len);
+  f.wire.assign(wire, wire + len);
+  return true;
+}
+
+// Кадры собираются один раз на часах опорного anchor: у всех anchor одни EUID и метки TIME
+static std::vector<BenchFrame> buildBenchFrames() {
+  std::vector<BenchFrame> frames;
+  DeltaEncoder encoders[BENCH_TAG_COUNT];
+  uint32_t tagSequence[BENCH_TAG_COUNT] = {0};
+  uint32_t syncSequence = 0;
+  uint16_t savedTagId = getLocalTagId();
+  
+  uint8_t frame[BINARY_MAX_FRAME + 64];
+  uint8_t wire[sizeof(frame) + FRAME_SYNC_OVERHEAD];
+  
+  // Период слота по пробному кадру с длинным SEQ: эфир + выдача на UART + запас, как в radio_bench
+  DeltaEncoder probe;
+  setLocalTagId(BENCH_TAGS[0].id);
+  size_t probeLen = encodeBenchFrame(frame, sizeof(frame), probe, 99999) + FRAMING_OVERHEAD;
+  uint64_t period = (uint64_t)simRadio.airtime_us(probeLen) * 2 + probeLen * simRadio.byteTime_us() + 50000;
+  
+  uint32_t slotsPerCycle = 1 + 2 * BENCH_TAG_COUNT;
+  uint64_t refBase = alignClock(BENCH_REF_CLOCK);
+  ClockSync reference;
+  reference.configure(true, Config::Sync::REFERENCE_X, Config::Sync::REFERENCE_Y,
+                      Config::Sync::REFERENCE_X, Config::Sync::REFERENCE_Y);
+  
+  for (uint32_t slot = 0; slot < BENCH_CYCLES * slotsPerCycle; slot++) {
+    BenchFrame f;
+    uint32_t inCycle = slot % slotsPerCycle;
+    size_t t = inCycle ? (inCycle - 1) % BENCH_TAG_COUNT : 0;
+    f.sync = (inCycle == 0);
+    f.x = f.sync ? Config::Sync::REFERENCE_X : BENCH_TAGS[t].x;
+    f.y = f.sync ? Config::Sync::REFERENCE_Y : BENCH_TAGS[t].y;
+    f.offset_us = (uint64_t)slot * period;
+    f.probe = false;
+    f.stampError_us = 0;
+    Sim::runUntil(refBase + f.offset_us);
+    
+    // Тег: метка TIME - начало эфира (offset_us); SYNC - через E32 с задержкой до эфира
+    if (f.sync) {
+      setLocalTagId(savedTagId);
+      if (!sendBenchSync(reference, syncSequence++, refBase, f)) continue;
+    } else {
+      setLocalTagId(BENCH_TAGS[t].id);
+      size_t len = encodeBenchFrame(frame, sizeof(frame), encoders[t], tagSequence[t]++);
+      len = benchWire(wire, sizeof(wire), frame, len);
+      f.wire.assign(wire, wire + len);
+    }
+    frames.push_back(f);
+  }
+  setLocalTagId(savedTagId);
+  return frames;
+}
+
+static void appendDump(void* ctx, const uint8_t* data, size_t len) {
+  std::vector<uint8_t>* dump = (std::vector<uint8_t>*)ctx;
+  dump->insert(dump->end(), data, data + len);
+}
+
+// Обычный прием anchor с включенной записью; dump - все, что ушло в его USB Serial
+static void captureBenchAnchor(const BenchAnchor& anchor, const std::vector<BenchFrame>& frames,
+                               AnchorRx& rx, std::vector<uint8_t>& dump) {
+  SimRadioConfig cfg;
+  cfg.byteLoss = BENCH_BYTE_LOSS;
+  cfg.seed = 0xC0FFEE + anchor.id;
+  simRadio.configure(cfg);
+  
+  // Часы anchor: micros() опорного + clockOffset_us; кадр приходит с задержкой распространения
+  uint64_t base = alignClock(BENCH_REF_CLOCK + anchor.clockOffset_us);
+  Sim::runUntil(base);
+  for (size_t i = 0; i < frames.size(); i++) {
+    const BenchFrame& f = frames[i];
+    if (f.sync && anchor.id == Config::Sync::REFERENCE_ANCHOR_ID) continue;  // Свой SYNC не слышит
+    float distance = hypotf(f.x - anchor.x, f.y - anchor.y);
+    uint64_t propagation = (uint64_t)lroundf(distance / SPEED_OF_LIGHT_M_PER_US);
+    Sim::schedule(base + f.offset_us + propagation, injectBenchFrame, (void*)&f, 0);
+  }
+  
+  Serial.setTxSink(appendDump, &dump);
+  rxCapture.begin(anchor.id, anchor.x, anchor.y);
+  rxCapture.setEnabled(true);
+  rxCapture.poll();
+  
+  uint64_t end = base + frames.back().offset_us + 2000000;
+  while (Sim::now_us() < end) {
+    rx.readAvailable();
+    if (!rx.inFrame()) rxCapture.poll();
+    Sim::advance(LOOP_PERIOD_US);
+  }
+  
+  rxCapture.setEnabled(false);
+  rxCapture.poll();
+  Serial.setTxSink(nullptr, nullptr);
+}
+
+static bool sameMeasurement(const Measurement& a, const Measurement& b) {
+  return a.anchorId == b.anchorId && frameKey(a.packet) == frameKey(b.packet) &&
+         a.packet.tagId == b.packet.tagId && a.packet.sequence == b.packet.sequence &&
+         a.refStats.rxTime_us == b.refStats.rxTime_us && a.refStats.rxEnd_us == b.refStats.rxEnd_us &&
+         a.refStats.airtime_us == b.refStats.airtime_us && a.refStats.latency_us == b.refStats.latency_us;
+}
+
+static bool runBench() {
+  std::vector<BenchFrame> frames = buildBenchFrames();
+  
+  // Живой прием всех anchor с записью
+  ReplayOutput live;
+  CaptureSet set;
+  uint32_t badRecords = 0;
+  size_t dumpBytes = 0;
+  uint32_t sentBefore = rxCapture.getSent();
+  uint32_t droppedBefore = rxCapture.getDropped();
+  
+  for (size_t a = 0; a < BENCH_ANCHOR_COUNT; a++) {
+    const BenchAnchor& anchor = BENCH_ANCHORS[a];
+    AnchorRx* rx = new AnchorRx(anchor.id, anchor.x, anchor.y, Config::Protocol::COBS_FRAMING);
+    live.anchors.push_back(rx);
+    
+    std::vector<uint8_t> dump;
+    captureBenchAnchor(anchor, frames, *rx, dump);
+    live.results.push_back(rx->finish());
+    badRecords += loadCapture(dump.data(), dump.size(), set);
+    dumpBytes += dump.size();
+  }
+  
+  size_t rxBytes = 0;
+  for (size_t a = 0; a < live.results.size(); a++) rxBytes += live.results[a].bytes;
+  printf("Capture: %u anchors, %u frames on air, %u bytes from E32 -> %u bytes USB Serial "
+         "(%.2f per byte), records %u, dropped %u, bad %u\n",
+         (unsigned)BENCH_ANCHOR_COUNT, (unsigned)frames.size(), (unsigned)rxBytes, (unsigned)dumpBytes,
+         rxBytes ? (double)dumpBytes / rxBytes : 0, rxCapture.getSent() - sentBefore,
+         rxCapture.getDropped() - droppedBefore, badRecords);
+  
+  // Replay дважды: те же метки, что на живом приеме, и тот же дайджест
+  ReplayOutput first;
+  ReplayOutput second;
+  replayAll(set, false, first);
+  replayAll(set, false, second);
+  printReport(set, first);
+  
+  bool pass = badRecords == 0 && set.size() == BENCH_ANCHOR_COUNT;
+  uint32_t mismatches = 0;
+  uint32_t measurements = 0;
+  size_t a = 0;
+  for (CaptureSet::const_iterator it = set.begin(); it != set.end() && a < live.anchors.size(); ++it, ++a) {
+    const AnchorResult& l = live.results[a];
+    const AnchorResult& r = first.results[a];
+    if (it->second.lostChunks != 0 || !it->second.haveHeader) pass = false;
+    if (l.bytes != r.bytes || l.framesOk != r.framesOk || l.framesError != r.framesError ||
+        l.crcErrors != r.crcErrors || l.duplicates != r.duplicates || l.syncFrames != r.syncFrames ||
+        l.notSynced != r.notSynced) {
+      mismatches++;
+    }
+    
+    const std::vector<Measurement>& lm = live.anchors[a]->measurements;
+    const std::vector<Measurement>& rm = first.anchors[a]->measurements;
+    if (lm.size() != rm.size()) mismatches++;
+    for (size_t i = 0; i < lm.size() && i < rm.size(); i++) {
+      if (!sameMeasurement(lm[i], rm[i])) mismatches++;
+    }
+    measurements += lm.size();
+  }
+  
+  // Ошибка позиции: теги неподвижны
+  std::vector<float> errors;
+  for (size_t i = 0; i < first.fixes.size(); i++) {
+    for (size_t t = 0; t < BENCH_TAG_COUNT; t++) {
+      if (BENCH_TAGS[t].id != first.fixes[i].tagId) continue;
+      errors.push_back(hypotf(first.fixes[i].position.x - BENCH_TAGS[t].x,
+                              first.fixes[i].position.y - BENCH_TAGS[t].y));
+    }
+  }
+  std::sort(errors.begin(), errors.end());
+  
+  printf("Live vs replay: %u measurements, %u mismatches; digest %08x / %08x (second run)\n",
+         measurements, mismatches, first.digest, second.digest);
+  printf("Position error: p50 %.1f m, max %.1f m over %u fixes\n",
+         errors.empty() ? 0 : errors[errors.size() / 2], errors.empty() ? 0 : errors.back(),
+         (unsigned)errors.size());
+  
+  // Метка SYNC против начала эфира: задержка UART и E32 на опорном anchor
+  uint32_t syncSent = 0;
+  uint32_t probes = 0;
+  uint32_t maxStampError = 0;
+  int32_t probeError = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!frames[i].sync) continue;
+    if (frames[i].probe) {
+      probes++;
+      probeError = frames[i].stampError_us;
+      continue;
+    }
+    syncSent++;
+    uint32_t error = (uint32_t)abs(frames[i].stampError_us);
+    if (error > maxStampError) maxStampError = error;
+  }
+  printf("SYNC TIME vs air start: max %u us over %u frames; %u probe, model error %d us\n",
+         maxStampError, syncSent, probes, probeError);
+  
+  if (mismatches != 0 || measurements == 0) pass = false;
+  if (first.digest != second.digest || first.fixes.empty()) pass = false;
+  if (errors.empty() || errors.back() > BENCH_MAX_ERR_M) pass = false;
+  if (probes != 1 || syncSent + probes != BENCH_CYCLES || maxStampError > BENCH_MAX_SYNC_ERR_US) pass = false;
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  // Диагностика прошивки в stdout не нужна - только отчет
+  Serial.setEcho(false);
+  
+  if (!loraModule.initialize()) {
+    printf("LoRaModule init failed\n");
+    return 1;
+  }
+  loraModule.getSerial()->setRxBufferSize(Config::Protocol::RX_BUFFER_SIZE);
+  loraModule.enableRxTimestamps();
+  
+  if (argc == 2 && strcmp(argv[1], "--bench") == 0) {
+    bool pass = runBench();
+    printf("\n%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+  }
+  
+  bool verbose = false;
+  CaptureSet set;
+  uint32_t badRecords = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+      continue;
+    }
+    std::vector<uint8_t> data;
+    if (!readFile(argv[i], data)) {
+      fprintf(stderr, "%s: cannot read\n", argv[i]);
+      return 1;
+    }
+    badRecords += loadCapture(data.data(), data.size(), set);
+  }
+  
+  if (set.empty()) {
+    fprintf(stderr, "Usage: replay [-v] <capture>... | --bench (no capture records found)\n");
+    return 1;
+  }
+  
+  // Разбор идет по правилам этой сборки - отличия прошивки записи видны сразу
+  const uint8_t parseFlags = CAPTURE_FLAG_COBS | CAPTURE_FLAG_CRC;
+  for (CaptureSet::const_iterator it = set.begin(); it != set.end(); ++it) {
+    if (!it->second.haveHeader) {
+      printf("Anchor %u: no header, coordinates unknown\n", it->first);
+    } else if ((it->second.header.flags & parseFlags) != (captureBuildFlags() & parseFlags)) {
+      printf("Anchor %u: recorded with framing/CRC flags 0x%02x, replay build 0x%02x\n", it->first,
+             it->second.header.flags & parseFlags, captureBuildFlags() & parseFlags);
+    }
+  }
+  if (badRecords) printf("Bad records: %u\n", badRecords);
+  
+  ReplayOutput out;
+  replayAll(set, verbose, out);
+  printReport(set, out);
+  return 0;
+}
@@ -0,0 +1,265 @@
+/*
+  Виртуальное время, очередь событий и симулятор E32 для native сборки.
+  Также реализация LoRa_E32 stand-in поверх симулятора.
+*/
+
+#include "sim_radio.h"
+#include "LoRa_E32.h"
+#include "config.h"
+#include "packet.h"
+#include <queue>
+#include <vector>
+
+SimE32 simRadio;
+
+// ===== Виртуальное время =====
+
+namespace {
+  struct Event {
+    uint64_t time_us;
+    uint64_t order;  // Порядок постановки: события одного момента - FIFO
+    Sim::EventFn fn;
+    void* ctx;
+    uint32_t arg;
+    
+    bool operator>(const Event& other) const {
+      return time_us != other.time_us ? time_us > other.time_us : order > other.order;
+    }
+  };
+  
+  uint64_t simTime_us = 0;
+  uint64_t eventOrder = 0;
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events;
+}
+
+uint64_t Sim::now_us() {
+  return simTime_us;
+}
+
+void Sim::runUntil(uint64_t time_us) {
+  // Время события выставляется до вызова: micros() в ISR видит момент фронта
+  while (!events.empty() && events.top().time_us <= time_us) {
+    Event ev = events.top();
+    events.pop();
+    if (ev.time_us > simTime_us) simTime_us = ev.time_us;
+    ev.fn(ev.ctx, ev.arg);
+  }
+  if (time_us > simTime_us) simTime_us = time_us;
+}
+
+void Sim::advance(uint64_t us) {
+  runUntil(simTime_us + us);
+}
+
+void Sim::schedule(uint64_t time_us, EventFn fn, void* ctx, uint32_t arg) {
+  Event ev;
+  ev.time_us = time_us < simTime_us ? simTime_us : time_us;
+  ev.order = eventOrder++;
+  ev.fn = fn;
+  ev.ctx = ctx;
+  ev.arg = arg;
+  events.push(ev);
+}
+
+// ===== SimE32 =====
+
+SimRadioConfig::SimRadioConfig()
+  : modulation(E32_MODULATION),
+    auxLead_us(3000),
+    idleGapBytes(3),
+    byteLoss(0),
+    bitFlip(0),
+    seed(1) {
+}
+
+SimE32::SimE32()
+  : serial(nullptr), auxPin(0), auxBusy(0),
+    rxAirEnd_us(0), rxUartEnd_us(0), txAirStart_us(0), txAirEnd_us(0), rngState(1) {
+  resetStats();
+}
+
+void SimE32::configure(const SimRadioConfig& cfg) {
+  config = cfg;
+  rngState = cfg.seed ? cfg.seed : 1;
+}
+
+void SimE32::attach(HardwareSerial* uart, uint8_t aux) {
+  serial = uart;
+  auxPin = aux;
+  serial->setTxSink(onUartTx, this);  // Прямая запись в UART (LoRaModule::startSend)
+  Sim::setPinLevel(auxPin, auxBusy ? LOW : HIGH);
+}
+
+void SimE32::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t SimE32::airtime_us(size_t len) const {
+  return loraAirtime_us(config.modulation, len);
+}
+
+uint32_t SimE32::byteTime_us() const {
+  uint32_t baud = (serial && serial->baudRate()) ? serial->baudRate()
+                                                 : Config::Protocol::LORA_BAUD_RATE;
+  return (10 * 1000000UL + baud - 1) / baud;  // 8N1: старт + 8 бит + стоп
+}
+
+uint32_t SimE32::nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+bool SimE32::loseByte() {
+  if (config.byteLoss <= 0) return false;
+  return (nextRandom() >> 8) * (1.0f / 16777216.0f) < config.byteLoss;
+}
+
+// E32 в прозрачном режиме отдает искаженный байт как есть
+uint8_t SimE32::corruptByte(uint8_t b) {
+  if (config.bitFlip <= 0) return b;
+  if ((nextRandom() >> 8) * (1.0f / 16777216.0f) >= config.bitFlip) return b;
+  stats.bytesFlipped++;
+  return b ^ (uint8_t)(1 << (nextRandom() & 7));
+}
+
+uint64_t SimE32::injectAir(const uint8_t* data, size_t len) {
+  uint64_t now = Sim::now_us();
+  uint32_t byteTime = byteTime_us();
+  uint64_t airStart = now > rxAirEnd_us ? now : rxAirEnd_us;
+  
+  for (size_t offset = 0; offset < len; offset += SUBPACKET_SIZE) {
+    size_t chunk = len - offset < SUBPACKET_SIZE ? len - offset : SUBPACKET_SIZE;
+    uint64_t airEnd = airStart + airtime_us(chunk);
+    
+    // Подпакет принят целиком -> AUX LOW, затем выдача на UART
+    uint64_t uartStart = airEnd + config.auxLead_us;
+    if (uartStart < rxUartEnd_us) uartStart = rxUartEnd_us;
+    
+    Sim::schedule(airEnd, onAuxDown, this, 0);
+    for (size_t i = 0; i < chunk; i++) {
+      if (loseByte()) {
+        stats.bytesLost++;
+        continue;
+      }
+      Sim::schedule(uartStart + (i + 1) * byteTime, onUartByte, this, corruptByte(data[offset + i]));
+    }
+    rxUartEnd_us = uartStart + chunk * byteTime;
+    Sim::schedule(rxUartEnd_us, onAuxUp, this, 0);
+    
+    airStart = airEnd;
+  }
+  
+  rxAirEnd_us = airStart;
+  stats.framesInjected++;
+  stats.rxAirtime_us += rxAirEnd_us - now;
+  return rxUartEnd_us;
+}
+
+uint64_t SimE32::transmit(const uint8_t* /*data*/, size_t len) {
+  uint64_t now = Sim::now_us();
+  uint32_t byteTime = byteTime_us();
+  uint64_t airEnd = now > txAirEnd_us ? now : txAirEnd_us;
+  uint64_t airtime = 0;
+  
+  Sim::schedule(now + byteTime, onAuxDown, this, 0);
+  
+  for (size_t offset = 0; offset < len; offset += SUBPACKET_SIZE) {
+    size_t chunk = len - offset < SUBPACKET_SIZE ? len - offset : SUBPACKET_SIZE;
+    
+    // Полный подпакет уходит сразу, хвост - после паузы на UART
+    uint64_t ready = now + (offset + chunk) * byteTime;
+    if (chunk < SUBPACKET_SIZE) ready += config.idleGapBytes * byteTime;
+    
+    uint64_t airStart = ready > airEnd ? ready : airEnd;
+    if (offset == 0) txAirStart_us = airStart;
+    airEnd = airStart + airtime_us(chunk);
+    airtime += airtime_us(chunk);
+  }
+  
+  Sim::schedule(airEnd, onAuxUp, this, 0);
+  
+  txAirEnd_us = airEnd;
+  stats.framesSent++;
+  stats.txAirtime_us += airtime;
+  return airEnd;
+}
+
+void SimE32::onAuxDown(void* ctx, uint32_t /*arg*/) {
+  SimE32* radio = (SimE32*)ctx;
+  if (radio->auxBusy++ == 0) Sim::setPinLevel(radio->auxPin, LOW);
+}
+
+void SimE32::onAuxUp(void* ctx, uint32_t /*arg*/) {
+  SimE32* radio = (SimE32*)ctx;
+  if (--radio->auxBusy == 0) Sim::setPinLevel(radio->auxPin, HIGH);
+}
+
+void SimE32::onUartTx(void* ctx, const uint8_t* data, size_t len) {
+  ((SimE32*)ctx)->transmit(data, len);
+}
+
+void SimE32::onUartByte(void* ctx, uint32_t arg) {
+  SimE32* radio = (SimE32*)ctx;
+  if (!radio->serial) return;
+  
+  if (radio->serial->inject((uint8_t)arg)) {
+    radio->stats.bytesDelivered++;
+  } else {
+    radio->stats.bytesOverflow++;
+  }
+}
+
+// ===== LoRa_E32 stand-in =====
+
+// Как в библиотеке: подпакет 58 байт + 2 байта адреса/канала
+static const uint8_t MAX_SIZE_TX_PACKET = SimE32::SUBPACKET_SIZE;
+static const uint32_t AUX_TIMEOUT_MS = 1000;
+static const uint32_t AUX_POLL_US = 100;
+
+String ResponseStatus::getResponseDescription() const {
+  switch (code) {
+    case E32_SUCCESS:            return "Success";
+    case ERR_E32_TIMEOUT:        return "Timeout!!";
+    case ERR_E32_PACKET_TOO_BIG: return "The device support only 58byte of data transmission!";
+    default:                     return "Invalid status!";
+  }
+}
+
+LoRa_E32::LoRa_E32(HardwareSerial* uart, uint8_t aux)
+  : serial(uart), auxPin(aux) {
+}
+
+bool LoRa_E32::begin() {
+  simRadio.attach(serial, auxPin);
+  return true;
+}
+
+ResponseStatus LoRa_E32::sendMessage(const String& message) {
+  return sendMessage(message.c_str(), (uint8_t)message.length());
+}
+
+ResponseStatus LoRa_E32::sendMessage(const void* message, uint8_t size) {
+  ResponseStatus status;
+  if (size > MAX_SIZE_TX_PACKET + 2) {
+    status.code = ERR_E32_PACKET_TOO_BIG;
+    return status;
+  }
+  
+  simRadio.transmit((const uint8_t*)message, size);
+  Sim::advance(simRadio.byteTime_us());  // AUX падает с первым байтом на UART
+  
+  // Ожидание AUX HIGH (конец передачи), как waitCompleteResponse в библиотеке
+  uint64_t deadline = Sim::now_us() + (uint64_t)AUX_TIMEOUT_MS * 1000;
+  while (digitalRead(auxPin) == LOW) {
+    if (Sim::now_us() >= deadline) {
+      status.code = ERR_E32_TIMEOUT;
+      return status;
+    }
+    Sim::advance(AUX_POLL_US);
+  }
+  
+  status.code = E32_SUCCESS;
+  return status;
+}
@@ -0,0 +1,412 @@
+/*
+  Host benchmark: TDOA solver (точность и время) на синтетической геометрии
+
+  Запуск:
+    pio run -e native_tdoa_bench -t exec
+
+  Для каждой конфигурации (число anchor, шум разности расстояний)
+  генерируются случайные позиции тега внутри площадки, вычисляются точные
+  разности расстояний + гауссов шум, решение сравнивается с истиной.
+  
+  Трекинг: тег идет по окружности, кадр раз в секунду, каждый anchor
+  слышит кадр с вероятностью hear. Разовое решение (3+ anchor) против
+  TdoaTracker (обновление уже по 2 anchor): доля кадров с позицией,
+  ошибка и время на кадр.
+  
+  Фиксированная точка: те же измерения решаются во float, Q16.16 и Q24.8
+  (решатель Mega - TdoaScalar): ошибка относительно истины, расхождение с
+  float-решением, нс и такты TSC (x86) на решение. На хосте float
+  аппаратный - такты показывают цену целочисленного пути (int64 умножение,
+  деление, поразрядный sqrt), а не выигрыш на AVR с программным float.
+  
+  Большие разности времен: c * dt вне диапазона типа отвергается
+  (rangeDiffFromTime), Q16.16 не выдает valid решение по насыщенной
+  разности (рядом - то же без проверки). Код возврата != 0 при нарушении - для прогонов в CI.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+#include "tdoa_solver.h"
+#include "tdoa_tracker.h"
+
+static const float AREA_SIZE_M = 100.0f;  // Площадка AREA x AREA
+static const int TRIALS = 20000;
+
+static const int   TRACK_FRAMES      = 3000;
+static const float TRACK_RADIUS_M    = 30.0f;   // Окружность вокруг центра площадки
+static const float TRACK_SPEED_MPS   = 1.5f;
+static const uint32_t TRACK_PERIOD_US = 1000000;
+
+// Детерминированный генератор (xorshift32), одинаковые прогоны
+static uint32_t rngState = 0x12345678;
+
+static float randUniform() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+static float randGauss() {
+  float u1 = randUniform() + 1e-7f;
+  float u2 = randUniform();
+  return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// Anchor узлы по периметру площадки (углы, затем середины сторон)
+static void placeAnchors(float* ax, float* ay, uint8_t count, float area = AREA_SIZE_M) {
+  static const float layout[8][2] = {
+    {0, 0}, {1, 0}, {1, 1}, {0, 1},
+    {0.5f, 0}, {1, 0.5f}, {0.5f, 1}, {0, 0.5f}
+  };
+  for (uint8_t i = 0; i < count; i++) {
+    ax[i] = layout[i][0] * area;
+    ay[i] = layout[i][1] * area;
+  }
+}
+
+static int compareFloat(const void* a, const void* b) {
+  float fa = *(const float*)a;
+  float fb = *(const float*)b;
+  return (fa > fb) - (fa < fb);
+}
+
+static void runCase(uint8_t count, float noise_m) {
+  static float errors[TRIALS];
+  float ax[TDOA_MAX_ANCHORS], ay[TDOA_MAX_ANCHORS], d[TDOA_MAX_ANCHORS];
+  placeAnchors(ax, ay, count);
+  
+  int failed = 0;
+  double residualSum = 0;
+  double solveNs = 0;
+  
+  for (int t = 0; t < TRIALS; t++) {
+    float tx = randUniform() * AREA_SIZE_M;
+    float ty = randUniform() * AREA_SIZE_M;
+    float r0 = hypotf(tx - ax[0], ty - ay[0]);
+    
+    for (uint8_t i = 0; i < count; i++) {
+      d[i] = hypotf(tx - ax[i], ty - ay[i]) - r0 + noise_m * randGauss();
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    TdoaSolution sol = solveTdoa(ax, ay, d, count);
+    auto stop = std::chrono::steady_clock::now();
+    solveNs += std::chrono::duration<double, std::nano>(stop - start).count();
+    
+    if (!sol.valid) {
+      failed++;
+      errors[t] = INFINITY;
+      continue;
+    }
+    
+    errors[t] = hypotf(sol.x - tx, sol.y - ty);
+    residualSum += sol.residual_m;
+  }
+  
+  qsort(errors, TRIALS, sizeof(float), compareFloat);
+  
+  printf("%7u %8.2f %10.3f %10.3f %10.3f %10.3f %8d %10.0f\n",
+         count, noise_m,
+         errors[TRIALS / 2], errors[TRIALS * 9 / 10], errors[TRIALS * 99 / 100],
+         residualSum / (TRIALS - failed), failed, solveNs / TRIALS);
+}
+
+static float percentileOf(float* values, int count, int pct) {
+  if (count == 0) return NAN;
+  qsort(values, count, sizeof(float), compareFloat);
+  return values[count * pct / 100];
+}
+
+static void runTrackingCase(uint8_t count, float noise_m, float hearProb) {
+  static float solveErrors[TRACK_FRAMES];
+  static float trackErrors[TRACK_FRAMES];
+  float ax[TDOA_MAX_ANCHORS], ay[TDOA_MAX_ANCHORS];
+  placeAnchors(ax, ay, count);
+  
+  TdoaTracker tracker;
+  tracker.setNoise(TDOA_TRACK_ACCEL_SIGMA, noise_m > 0.5f ? noise_m : 0.5f);
+  
+  int solveCalls = 0, solves = 0, tracks = 0, updates = 0;
+  double solveNs = 0, updateNs = 0;
+  
+  for (int f = 0; f < TRACK_FRAMES; f++) {
+    float angle = f * (TRACK_PERIOD_US * 1e-6f) * TRACK_SPEED_MPS / TRACK_RADIUS_M;
+    float tx = AREA_SIZE_M * 0.5f + TRACK_RADIUS_M * cosf(angle);
+    float ty = AREA_SIZE_M * 0.5f + TRACK_RADIUS_M * sinf(angle);
+    
+    // Услышавшие кадр anchor; первый - опорный
+    float hx[TDOA_MAX_ANCHORS], hy[TDOA_MAX_ANCHORS], d[TDOA_MAX_ANCHORS];
+    uint8_t heard = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (randUniform() >= hearProb) continue;
+      hx[heard] = ax[i];
+      hy[heard] = ay[i];
+      heard++;
+    }
+    if (heard == 0) continue;
+    
+    float r0 = hypotf(tx - hx[0], ty - hy[0]);
+    for (uint8_t i = 0; i < heard; i++) {
+      d[i] = i ? hypotf(tx - hx[i], ty - hy[i]) - r0 + noise_m * randGauss() : 0;
+    }
+    
+    if (heard >= 3) {
+      auto start = std::chrono::steady_clock::now();
+      TdoaSolution sol = solveTdoa(hx, hy, d, heard);
+      auto stop = std::chrono::steady_clock::now();
+      solveNs += std::chrono::duration<double, std::nano>(stop - start).count();
+      solveCalls++;
+      if (sol.valid) solveErrors[solves++] = hypotf(sol.x - tx, sol.y - ty);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    TdoaTracker::Result result = tracker.step(hx, hy, d, heard, (uint32_t)f * TRACK_PERIOD_US);
+    auto stop = std::chrono::steady_clock::now();
+    
+    if (result == TdoaTracker::TRACK_UPDATE) {
+      updateNs += std::chrono::duration<double, std::nano>(stop - start).count();
+      updates++;
+    }
+    if (result == TdoaTracker::TRACK_INIT || result == TdoaTracker::TRACK_UPDATE) {
+      trackErrors[tracks++] = hypotf(tracker.getX() - tx, tracker.getY() - ty);
+    }
+  }
+  
+  printf("%7u %5.1f %8.2f %6.1f%% %9.3f %9.3f %9.0f %6.1f%% %9.3f %9.3f %9.0f\n",
+         count, hearProb, noise_m,
+         100.0 * solves / TRACK_FRAMES,
+         percentileOf(solveErrors, solves, 50), percentileOf(solveErrors, solves, 90),
+         solveCalls ? solveNs / solveCalls : 0.0,
+         100.0 * tracks / TRACK_FRAMES,
+         percentileOf(trackErrors, tracks, 50), percentileOf(trackErrors, tracks, 90),
+         updates ? updateNs / updates : 0.0);
+}
+
+// Счетчик тактов TSC; 0 - нет на этой архитектуре
+static inline uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+struct ScalarStats {
+  float errors[TRIALS];
+  float deviations[TRIALS];  // Расстояние до float-решения того же измерения
+  int solves;
+  int deviationCount;
+  int failed;
+  double ns;
+  uint64_t cycles;
+};
+
+// Решение в типе T; перевод входов во время не входит - на Mega разности
+// сразу получаются в TdoaScalar (TDOANavigator::collectRangeDiffs)
+template <typename T>
+static TdoaSolution timedSolve(const float* ax, const float* ay, const float* d,
+                               uint8_t count, ScalarStats& stats) {
+  T sx[TDOA_MAX_ANCHORS], sy[TDOA_MAX_ANCHORS], sd[TDOA_MAX_ANCHORS];
+  for (uint8_t i = 0; i < count; i++) {
+    sx[i] = NumTraits<T>::fromFloat(ax[i]);
+    sy[i] = NumTraits<T>::fromFloat(ay[i]);
+    sd[i] = NumTraits<T>::fromFloat(d[i]);
+  }
+  
+  auto start = std::chrono::steady_clock::now();
+  uint64_t startCycles = cycleCount();
+  TdoaSolution sol = solveTdoa<T>(sx, sy, sd, count);
+  uint64_t stopCycles = cycleCount();
+  auto stop = std::chrono::steady_clock::now();
+  
+  stats.ns += std::chrono::duration<double, std::nano>(stop - start).count();
+  stats.cycles += stopCycles - startCycles;
+  return sol;
+}
+
+static void recordSolution(ScalarStats& stats, const TdoaSolution& sol,
+                           const TdoaSolution& reference, float tx, float ty) {
+  if (!sol.valid) {
+    stats.failed++;
+    return;
+  }
+  stats.errors[stats.solves++] = hypotf(sol.x - tx, sol.y - ty);
+  if (reference.valid) {
+    stats.deviations[stats.deviationCount++] = hypotf(sol.x - reference.x, sol.y - reference.y);
+  }
+}
+
+static void printScalarRow(uint8_t count, float area, float noise_m, const char* name, ScalarStats& stats) {
+  printf("%7u %6.0f %8.2f %7s %9.3f %9.3f %9.3f %9.4f %7d %9.0f %10.0f\n",
+         count, area, noise_m, name,
+         percentileOf(stats.errors, stats.solves, 50),
+         percentileOf(stats.errors, stats.solves, 90),
+         percentileOf(stats.errors, stats.solves, 99),
+         percentileOf(stats.deviations, stats.deviationCount, 99),
+         stats.failed, stats.ns / TRIALS, (double)stats.cycles / TRIALS);
+}
+
+static void runScalarCase(uint8_t count, float area, float noise_m) {
+  static ScalarStats stats[3];
+  static const char* const NAMES[3] = { "float", "Q16.16", "Q24.8" };
+  float ax[TDOA_MAX_ANCHORS], ay[TDOA_MAX_ANCHORS], d[TDOA_MAX_ANCHORS];
+  placeAnchors(ax, ay, count, area);
+  
+  for (ScalarStats& s : stats) {
+    s.solves = s.deviationCount = s.failed = 0;
+    s.ns = 0;
+    s.cycles = 0;
+  }
+  
+  for (int t = 0; t < TRIALS; t++) {
+    float tx = randUniform() * area;
+    float ty = randUniform() * area;
+    float r0 = hypotf(tx - ax[0], ty - ay[0]);
+    
+    for (uint8_t i = 0; i < count; i++) {
+      d[i] = hypotf(tx - ax[i], ty - ay[i]) - r0 + noise_m * randGauss();
+    }
+    
+    TdoaSolution reference = timedSolve<float>(ax, ay, d, count, stats[0]);
+    recordSolution(stats[0], reference, reference, tx, ty);
+    recordSolution(stats[1], timedSolve<Q16_16>(ax, ay, d, count, stats[1]), reference, tx, ty);
+    recordSolution(stats[2], timedSolve<Q24_8>(ax, ay, d, count, stats[2]), reference, tx, ty);
+  }
+  
+  for (int k = 0; k < 3; k++) {
+    printScalarRow(count, area, noise_m, NAMES[k], stats[k]);
+  }
+}
+
+// Большая разность времен (плохая метка, отсчет синхронизации): c * dt вне
+// диапазона типа отвергается, а не насыщается в ложное решение
+static const int32_t LARGE_DT_US[] = {100, 109, 110, 200, -200, 5000, 27000, 28000, 40000, -40000};
+static const float LARGE_DT_SKEW_US = 200.0f;  // Ошибка метки anchor 3 в проверке решения
+
+template <typename T>
+static bool checkRangeDiff(const char* name, float limit_m) {
+  bool pass = true;
+  for (int32_t dt : LARGE_DT_US) {
+    T value;
+    bool accepted = rangeDiffFromTime<T>(dt, value);
+    float expected = dt * SPEED_OF_LIGHT_M_PER_US;
+    bool fits = fabsf(expected) < limit_m * 0.999f;
+    bool exact = !accepted || fabsf(NumTraits<T>::toFloat(value) - expected) <= fabsf(expected) * 1e-5f + 0.01f;
+    // У самой границы округление скорости света решает в любую сторону
+    bool ok = exact && (accepted == fits || (fabsf(expected) >= limit_m * 0.999f && fabsf(expected) < limit_m));
+    printf("%7s %7d %12.0f %8s %6s\n", name, (int)dt, expected, accepted ? "yes" : "no", ok ? "OK" : "FAIL");
+    if (!ok) pass = false;
+  }
+  return pass;
+}
+
+// 5 anchor, метка последнего сдвинута: Q16.16 отбрасывает его и решает по 4.
+// Для сравнения - та же насыщенная разность без проверки (до rangeDiffFromTime)
+static const uint8_t LARGE_DT_ANCHORS = 5;
+static const float   LARGE_DT_AREA_M  = AREA_SIZE_M * 20;  // На 100 м решатель сам отвергает такие входы
+static const float   LARGE_DT_ERR_M   = 10.0f;   // Ложное решение: дальше от истины
+
+static bool runLargeDtSolveCase() {
+  float ax[LARGE_DT_ANCHORS], ay[LARGE_DT_ANCHORS];
+  placeAnchors(ax, ay, LARGE_DT_ANCHORS, LARGE_DT_AREA_M);
+  int rejected = 0, checkedValid = 0, checkedBogus = 0, uncheckedValid = 0, uncheckedBogus = 0;
+  
+  for (int t = 0; t < TRIALS; t++) {
+    float tx = randUniform() * LARGE_DT_AREA_M;
+    float ty = randUniform() * LARGE_DT_AREA_M;
+    float r0 = hypotf(tx - ax[0], ty - ay[0]);
+    
+    Q16_16 sx[LARGE_DT_ANCHORS], sy[LARGE_DT_ANCHORS], sd[LARGE_DT_ANCHORS];
+    for (uint8_t i = 0; i < LARGE_DT_ANCHORS; i++) {
+      sx[i] = NumTraits<Q16_16>::fromFloat(ax[i]);
+      sy[i] = NumTraits<Q16_16>::fromFloat(ay[i]);
+      sd[i] = NumTraits<Q16_16>::fromFloat(hypotf(tx - ax[i], ty - ay[i]) - r0);
+    }
+    
+    const uint8_t last = LARGE_DT_ANCHORS - 1;
+    int32_t dt = (int32_t)(NumTraits<Q16_16>::toFloat(sd[last]) / SPEED_OF_LIGHT_M_PER_US + LARGE_DT_SKEW_US);
+    bool accepted = rangeDiffFromTime<Q16_16>(dt, sd[last]);
+    if (!accepted) rejected++;
+    
+    TdoaSolution unchecked = solveTdoa<Q16_16>(sx, sy, sd, LARGE_DT_ANCHORS);
+    TdoaSolution checked = solveTdoa<Q16_16>(sx, sy, sd, accepted ? LARGE_DT_ANCHORS : last);
+    if (unchecked.valid) {
+      uncheckedValid++;
+      if (hypotf(unchecked.x - tx, unchecked.y - ty) > 1.0f) uncheckedBogus++;
+    }
+    if (checked.valid) {
+      checkedValid++;
+      if (hypotf(checked.x - tx, checked.y - ty) > 1.0f) checkedBogus++;
+    }
+  }
+  
+  printf("Q16.16, %u anchors, last off by %.0f us: rejected %d/%d; checked %d valid, %d off by > %.0f m; "
+         "unchecked %d valid, %d off\n", LARGE_DT_ANCHORS, LARGE_DT_SKEW_US, rejected, TRIALS,
+         checkedValid, checkedBogus, LARGE_DT_ERR_M, uncheckedValid, uncheckedBogus);
+  // Остаток checked - обычные промахи решателя по 4 anchor (доли процента), не насыщение
+  return rejected == TRIALS && checkedBogus * 1000 <= checkedValid;
+}
+
+int main() {
+  printf("TDOA solver benchmark: %d trials/case, area %.0fx%.0f m, %u GN steps\n",
+         TRIALS, AREA_SIZE_M, AREA_SIZE_M, TDOA_GN_ITERATIONS);
+  printf("%7s %8s %10s %10s %10s %10s %8s %10s\n",
+         "anchors", "noise_m", "err_p50_m", "err_p90_m", "err_p99_m",
+         "resid_m", "failed", "ns/solve");
+  
+  static const uint8_t anchorCounts[] = {3, 4, 6, 8};
+  static const float noiseLevels[] = {0.0f, 1.0f, 5.0f, 30.0f};
+  
+  for (uint8_t count : anchorCounts) {
+    for (float noise : noiseLevels) {
+      runCase(count, noise);
+    }
+  }
+  
+  printf("\nTracking: %d frames every %u ms, %.1f m/s on a %.0f m circle\n",
+         TRACK_FRAMES, (unsigned)(TRACK_PERIOD_US / 1000), TRACK_SPEED_MPS, TRACK_RADIUS_M);
+  printf("%7s %5s %8s %7s %9s %9s %9s %7s %9s %9s %9s\n",
+         "anchors", "hear", "noise_m", "fixes", "err_p50", "err_p90", "ns/solve",
+         "track", "err_p50", "err_p90", "ns/upd");
+  
+  static const float hearLevels[] = {1.0f, 0.8f, 0.6f};
+  static const float trackNoise[] = {1.0f, 5.0f, 30.0f};
+  
+  for (float hear : hearLevels) {
+    for (float noise : trackNoise) {
+      runTrackingCase(4, noise, hear);
+    }
+  }
+  
+  printf("\nFixed point vs float: %d trials/case, dev = distance to the float fix\n", TRIALS);
+  printf("%7s %6s %8s %7s %9s %9s %9s %9s %7s %9s %10s\n",
+         "anchors", "area", "noise_m", "type", "err_p50", "err_p90", "err_p99",
+         "dev_p99", "failed", "ns/solve", "cyc/solve");
+  
+  static const uint8_t scalarAnchors[] = {3, 4, 8};
+  static const float scalarNoise[] = {0.0f, 1.0f, 5.0f};
+  
+  for (uint8_t count : scalarAnchors) {
+    for (float noise : scalarNoise) {
+      runScalarCase(count, AREA_SIZE_M, noise);
+    }
+  }
+  // Большая площадка: масштаб нормировки для фиксированной точки
+  runScalarCase(4, AREA_SIZE_M * 20, 5.0f);
+  
+  printf("\nLarge time differences: c * dt outside the scalar range is rejected\n");
+  printf("%7s %7s %12s %8s %6s\n", "type", "dt_us", "range_m", "accepted", "result");
+  bool pass = checkRangeDiff<float>("float", INFINITY);
+  pass = checkRangeDiff<Q16_16>("Q16.16", (float)Q16_16::RAW_MAX / Q16_16::ONE) && pass;
+  pass = checkRangeDiff<Q24_8>("Q24.8", (float)Q24_8::RAW_MAX / Q24_8::ONE) && pass;
+  pass = runLargeDtSolveCase() && pass;
+  
+  printf("\n%s\n", pass ? "PASS" : "FAIL");
+  return pass ? 0 : 1;
+}